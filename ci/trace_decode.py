@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+
+# Copyright © 2019-2023
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import sys
+import argparse
+import struct
+
+MAGIC = b"VXTRACE\0"
+HEADER = struct.Struct("<IB3xIIQQ")
+NO_ID = 0xffffffff
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='SimX binary trace (VORTEX_TRACE) to text log converter.')
+    parser.add_argument('-o', '--log', default=None, help='Output log file (default: stdout)')
+    parser.add_argument('-c', '--context', action='store_true', help='Prefix each line with its core, warp and PC')
+    parser.add_argument('trace', help='Input trace file')
+    return parser.parse_args()
+
+def decode(trace_filename, out, context):
+    with open(trace_filename, 'rb') as trace_file:
+        data = trace_file.read()
+    if data[:len(MAGIC)] != MAGIC:
+        sys.exit("Error: invalid trace file '{}'".format(trace_filename))
+    offset = len(MAGIC)
+    while offset + HEADER.size <= len(data):
+        length, kind, cid, wid, cycle, pc = HEADER.unpack_from(data, offset)
+        offset += HEADER.size
+        text = data[offset:offset + length].decode('utf-8', errors='replace')
+        offset += length
+        prefix = ""
+        if context:
+            core = "-" if cid == NO_ID else str(cid)
+            warp = "-" if wid == NO_ID else str(wid)
+            prefix = "[{}:{}:0x{:x}] ".format(core, warp, pc)
+        # same layout as the debug build's console output
+        if kind == 1:
+            out.write("{}DEBUG {}\n".format(prefix, text))
+        elif kind == 2:
+            out.write("{}TRACE {:>10}: {}\n".format(prefix, cycle, text))
+        else:
+            out.write("{}{}\n".format(prefix, text))
+
+def main():
+    args = parse_args()
+    if args.log:
+        with open(args.log, 'w') as out:
+            decode(args.trace, out, args.context)
+    else:
+        decode(args.trace, sys.stdout, args.context)
+
+if __name__ == "__main__":
+    main()
@@ -38,6 +38,17 @@
 `define VX_DCR_MPM_CLASS_TEX            3
 `define VX_DCR_MPM_CLASS_RASTER         4
 `define VX_DCR_MPM_CLASS_OM             5
+`define VX_DCR_MPM_CLASS_DRAM           6
+`define VX_DCR_MPM_CLASS_SIMT           7
+`define VX_DCR_MPM_CLASS_CPI            8
+
+// Cache maintenance operations (performed when written) //////////////////////
+
+// SimX-only register, kept outside the chained device state ranges
+`define VX_DCR_CACHE_CTRL               12'hFF0
+
+`define VX_DCR_CACHE_CTRL_FLUSH         1   // write back dirty lines
+`define VX_DCR_CACHE_CTRL_INVALIDATE    2   // write back dirty lines and drop all lines
 
 // User Floating-Point CSRs ///////////////////////////////////////////////////
 
@@ -120,6 +131,18 @@
 `define VX_CSR_MPM_SCRB_OM_H            12'hB94
 `define VX_CSR_MPM_SCRB_RASTER          12'hB15
 `define VX_CSR_MPM_SCRB_RASTER_H        12'hB95
+// PERF: warp-uniform execution
+`define VX_CSR_MPM_UNIFORM              12'hB16     // uniform thread instructions
+`define VX_CSR_MPM_UNIFORM_H            12'hB96
+`define VX_CSR_MPM_SALU                 12'hB17     // thread instructions executed on the scalar unit
+`define VX_CSR_MPM_SALU_H               12'hB97
+// PERF: SIMT efficiency
+`define VX_CSR_MPM_WARP_INSTRS          12'hB18     // issued warp instructions
+`define VX_CSR_MPM_WARP_INSTRS_H        12'hB98
+`define VX_CSR_MPM_WARP_THREADS         12'hB19     // active threads of issued warp instructions
+`define VX_CSR_MPM_WARP_THREADS_H       12'hB99
+`define VX_CSR_MPM_COMPACT_INSTRS       12'hB1A     // warp instructions after dynamic compaction
+`define VX_CSR_MPM_COMPACT_INSTRS_H     12'hB9A
 
 // Machine Performance-monitoring memory counters
 // PERF: icache
@@ -182,6 +205,11 @@
 `define VX_CSR_MPM_LMEM_WRITES_H        12'hB9C
 `define VX_CSR_MPM_LMEM_BANK_ST         12'hB1D     // bank conflicts
 `define VX_CSR_MPM_LMEM_BANK_ST_H       12'hB9D
+// PERF: near-memory atomics
+`define VX_CSR_MPM_AMO_REQS             12'hB1E     // atomics executed in L2/L3
+`define VX_CSR_MPM_AMO_REQS_H           12'hB9E
+`define VX_CSR_MPM_AMO_ST               12'hB1F     // same-line atomic stalls
+`define VX_CSR_MPM_AMO_ST_H             12'hB9F
 
 // Machine Performance-monitoring memory counters (class 3) ///////////////////
 // <Add your own counters: use addresses hB03..B1F, hB83..hB9F>
@@ -221,6 +249,13 @@
 `define VX_CSR_MPM_RCACHE_BANK_ST_H     12'hB88
 `define VX_CSR_MPM_RCACHE_MSHR_ST       12'hB09     // MSHR stalls
 `define VX_CSR_MPM_RCACHE_MSHR_ST_H     12'hB89
+// PERF: raster hierarchical-Z
+`define VX_CSR_MPM_RASTER_STAMPS        12'hB0A     // stamps sent to the shaders
+`define VX_CSR_MPM_RASTER_STAMPS_H      12'hB8A
+`define VX_CSR_MPM_RASTER_HIZ_TILES     12'hB0B     // occluded primitive tiles
+`define VX_CSR_MPM_RASTER_HIZ_TILES_H   12'hB8B
+`define VX_CSR_MPM_RASTER_HIZ_STAMPS    12'hB0C     // occluded stamps
+`define VX_CSR_MPM_RASTER_HIZ_STAMPS_H  12'hB8C
 
 // Machine Performance-monitoring OM counters
 // PERF: om unit
@@ -245,6 +280,54 @@
 `define VX_CSR_MPM_OCACHE_BANK_ST_H     12'hB8B
 `define VX_CSR_MPM_OCACHE_MSHR_ST       12'hB0C     // MSHR stalls
 `define VX_CSR_MPM_OCACHE_MSHR_ST_H     12'hB8C
+// PERF: om tile buffer
+`define VX_CSR_MPM_OM_IMM_READS         12'hB0D     // om reads in immediate mode
+`define VX_CSR_MPM_OM_IMM_READS_H       12'hB8D
+`define VX_CSR_MPM_OM_IMM_WRITES        12'hB0E     // om writes in immediate mode
+`define VX_CSR_MPM_OM_IMM_WRITES_H      12'hB8E
+
+// Machine Performance-monitoring DRAM counters
+// PERF: memory channels
+`define VX_CSR_MPM_DRAM_CHANNELS        12'hB03     // number of channels
+`define VX_CSR_MPM_DRAM_CHANNELS_H      12'hB83
+`define VX_CSR_MPM_DRAM_READS           12'hB04     // total reads
+`define VX_CSR_MPM_DRAM_READS_H         12'hB84
+`define VX_CSR_MPM_DRAM_WRITES          12'hB05     // total writes
+`define VX_CSR_MPM_DRAM_WRITES_H        12'hB85
+`define VX_CSR_MPM_DRAM_TURNS           12'hB06     // read/write turnarounds
+`define VX_CSR_MPM_DRAM_TURNS_H         12'hB86
+`define VX_CSR_MPM_DRAM_QUEUE_LT        12'hB07     // queueing latency
+`define VX_CSR_MPM_DRAM_QUEUE_LT_H      12'hB87
+`define VX_CSR_MPM_DRAM_LAT_HIST        12'hB08     // read latency histogram (8 bins: <32, <64, ..., >=2048 cycles)
+`define VX_CSR_MPM_DRAM_LAT_HIST_H      12'hB88
+`define VX_CSR_MPM_DRAM_QUEUE_HIST      12'hB10     // queue occupancy histogram (4 bins: empty, <half, >=half, full)
+`define VX_CSR_MPM_DRAM_QUEUE_HIST_H    12'hB90
+`define VX_CSR_MPM_DRAM_CH_BYTES        12'hB14     // per-channel bytes transferred (channels 0..7)
+`define VX_CSR_MPM_DRAM_CH_BYTES_H      12'hB94
+
+// Machine Performance-monitoring SIMT counters
+// PERF: divergence
+`define VX_CSR_MPM_SIMT_INSTRS          12'hB03     // issued warp instructions
+`define VX_CSR_MPM_SIMT_INSTRS_H        12'hB83
+`define VX_CSR_MPM_SIMT_THREADS         12'hB04     // active threads of issued warp instructions
+`define VX_CSR_MPM_SIMT_THREADS_H       12'hB84
+`define VX_CSR_MPM_SIMT_SPLITS          12'hB05     // split instructions
+`define VX_CSR_MPM_SIMT_SPLITS_H        12'hB85
+`define VX_CSR_MPM_SIMT_DIV_SPLITS      12'hB06     // divergent splits
+`define VX_CSR_MPM_SIMT_DIV_SPLITS_H    12'hB86
+`define VX_CSR_MPM_SIMT_JOINS           12'hB07     // join instructions
+`define VX_CSR_MPM_SIMT_JOINS_H         12'hB87
+`define VX_CSR_MPM_SIMT_DEPTH           12'hB08     // maximum IPDOM stack depth
+`define VX_CSR_MPM_SIMT_DEPTH_H         12'hB88
+`define VX_CSR_MPM_SIMT_DIV_CYCLES      12'hB09     // cycles with divergent warps
+`define VX_CSR_MPM_SIMT_DIV_CYCLES_H    12'hB89
+`define VX_CSR_MPM_SIMT_LANES_HIST      12'hB0A     // active lanes histogram (8 bins: eighths of the warp width)
+`define VX_CSR_MPM_SIMT_LANES_HIST_H    12'hB8A
+
+// Machine Performance-monitoring CPI stack counters
+// PERF: issue slot cycles (10 categories: base, icache, memory, structural, alu, fpu, sfu, barrier, wctl, idle)
+`define VX_CSR_MPM_CPI_STACK            12'hB03
+`define VX_CSR_MPM_CPI_STACK_H          12'hB83
 
 // Machine Information Registers //////////////////////////////////////////////
 
@@ -266,6 +349,11 @@
 `define VX_CSR_NUM_CORES                12'hFC2
 `define VX_CSR_LOCAL_MEM_BASE           12'hFC3
 
+// Performance region markers (write-only, the value is the region id)
+
+`define VX_CSR_MPM_REGION_BEGIN         12'h7F0
+`define VX_CSR_MPM_REGION_END           12'h7F1
+
 // Raster unit CSRs
 
 `define VX_CSR_RASTER_BEGIN             12'h7C0
@@ -383,6 +471,10 @@
 `define VX_OM_DEPTH_FUNC_NOTEQUAL      7
 `define VX_OM_DEPTH_FUNC_BITS          3
 
+// VX_DCR_OM_DEPTH_WRITEMASK bit 1: the shaders output the primitive's interpolated
+// depth and never discard, so occluded stamps may be culled early (SimX only)
+`define VX_OM_DEPTH_HIZ_SAFE           2
+
 `define VX_OM_STENCIL_OP_KEEP          0
 `define VX_OM_STENCIL_OP_ZERO          1
 `define VX_OM_STENCIL_OP_REPLACE       2
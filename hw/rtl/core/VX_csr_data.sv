@@ -149,7 +149,9 @@ import VX_fpu_pkg::*;
                 `VX_CSR_MTVEC,
                 `VX_CSR_MEPC,
                 `VX_CSR_PMPCFG0,
-                `VX_CSR_PMPADDR0: begin
+                `VX_CSR_PMPADDR0,
+                `VX_CSR_MPM_REGION_BEGIN,
+                `VX_CSR_MPM_REGION_END: begin
                     // do nothing!
                 end
                 `VX_CSR_MSCRATCH: begin
@@ -214,6 +216,9 @@ import VX_fpu_pkg::*;
             `VX_CSR_PMPCFG0,
             `VX_CSR_PMPADDR0 : read_data_ro_r = `XLEN'(0);
 
+            `VX_CSR_MPM_REGION_BEGIN,
+            `VX_CSR_MPM_REGION_END : read_data_rw_r = `XLEN'(0);
+
             default: begin
                 read_addr_valid_r = 0;
                 if ((read_addr >= `VX_CSR_MPM_USER   && read_addr < (`VX_CSR_MPM_USER + 32))
@@ -237,6 +237,16 @@ inline int vx_hart_id() {
     return ret;
 }
 
+// Start a performance region, SimX reports the counter increments of each region
+inline void vx_perf_region_begin(int region_id) {
+    csr_write(VX_CSR_MPM_REGION_BEGIN, region_id);
+}
+
+// End a performance region
+inline void vx_perf_region_end(int region_id) {
+    csr_write(VX_CSR_MPM_REGION_END, region_id);
+}
+
 inline void vx_fence() {
     __asm__ volatile ("fence iorw, iorw");
 }
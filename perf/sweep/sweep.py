@@ -0,0 +1,373 @@
+#!/usr/bin/env python3
+
+# Copyright © 2019-2023
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import sys
+import argparse
+import csv
+import hashlib
+import itertools
+import json
+import math
+import shlex
+import shutil
+import subprocess
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+ROOT_DIR = os.path.realpath(os.path.join(SCRIPT_DIR, '..', '..'))
+
+# SimX runtime configuration keys (see VORTEX_SIMX_CONFIG in docs/simulation.md)
+RUNTIME_KEYS = {
+    'threads', 'warps', 'cores', 'clusters', 'socket_size', 'barriers', 'ibuf_size',
+    'lmem.banks', 'memory.banks',
+    'gpr.banks', 'gpr.read_ports', 'gpr.write_ports', 'gpr.collectors', 'salu',
+    'compaction.window', 'hiz', 'om.tile_buffers',
+    'latency.imul', 'latency.fma', 'latency.fdiv', 'latency.fsqrt', 'latency.fcvt',
+}
+CACHE_KEYS = ('icache', 'dcache', 'l2cache', 'l3cache')
+CACHE_FIELDS = ('enabled', 'size', 'ways', 'banks', 'mshr')
+for cache in CACHE_KEYS:
+    for field in CACHE_FIELDS:
+        RUNTIME_KEYS.add(cache + '.' + field)
+
+# grid keys that require a separate simulator build
+BUILD_ALIASES = {
+    'issue_width': 'ISSUE_WIDTH',
+}
+
+# environment-driven keys
+ENV_KEYS = {
+    'dram': 'VORTEX_DRAM_CONFIG',
+    'dram_model': 'VORTEX_DRAM_MODEL',
+}
+
+# compile-time defaults from VX_config.vh, used by the area proxy
+DEFAULTS = {
+    'threads': 4,
+    'warps': 4,
+    'cores': 1,
+    'clusters': 1,
+    'issue_width': 1,
+    'lmem.size': 16384,
+    'icache.enabled': True,
+    'icache.size': 16384,
+    'dcache.enabled': True,
+    'dcache.size': 16384,
+    'l2cache.enabled': False,
+    'l2cache.size': 1048576,
+    'l3cache.enabled': False,
+    'l3cache.size': 1048576,
+}
+
+# area proxy weights, in SRAM byte equivalents
+AREA_WEIGHTS = {
+    'sram': 1.0,          # per cache/local memory byte
+    'regfile': 2.0,       # per register file byte (multi-ported)
+    'lane': 32768.0,      # per execution lane
+    'issue': 65536.0,     # per issue slot
+}
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Parallel SimX design-space sweep.')
+    parser.add_argument('spec', help='Sweep specification (JSON)')
+    parser.add_argument('-o', '--outdir', default='sweep', help='Output directory')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(), help='Parallel simulations')
+    parser.add_argument('-t', '--timeout', type=int, default=3600, help='Per-run timeout in seconds')
+    parser.add_argument('-n', '--dry-run', action='store_true', help='List the sweep points and exit')
+    return parser.parse_args()
+
+def load_spec(filename):
+    with open(filename, 'r') as file:
+        spec = json.load(file)
+    if 'apps' not in spec or not spec['apps']:
+        sys.exit("Error: sweep spec has no 'apps'")
+    for key in list(spec.get('grid', {}).keys()) + list(spec.get('base', {}).keys()):
+        if key not in RUNTIME_KEYS and key not in BUILD_ALIASES and key not in ENV_KEYS and not key.startswith('build.'):
+            sys.exit("Error: unknown sweep parameter '%s'" % key)
+    return spec
+
+def expand_grid(grid):
+    keys = sorted(grid.keys())
+    values = [grid[key] if isinstance(grid[key], list) else [grid[key]] for key in keys]
+    return [dict(zip(keys, combo)) for combo in itertools.product(*values)]
+
+def split_params(params):
+    config = {}
+    defines = []
+    env = {}
+    for key, value in sorted(params.items()):
+        if key in RUNTIME_KEYS:
+            node = config
+            parts = key.split('.')
+            for part in parts[:-1]:
+                node = node.setdefault(part, {})
+            node[parts[-1]] = value
+        elif key in ENV_KEYS:
+            env[ENV_KEYS[key]] = str(value)
+        else:
+            name = BUILD_ALIASES.get(key, key[len('build.'):])
+            defines.append('-D%s=%s' % (name, value))
+    return config, defines, env
+
+def param_value(params, key):
+    if key in params:
+        return params[key]
+    return DEFAULTS.get(key, 0)
+
+def area_proxy(params, weights):
+    cores = param_value(params, 'cores') * param_value(params, 'clusters')
+    threads = param_value(params, 'threads')
+    warps = param_value(params, 'warps')
+    def cache_bytes(name):
+        return param_value(params, name + '.size') if param_value(params, name + '.enabled') else 0
+    sram = cores * (cache_bytes('icache') + cache_bytes('dcache') + param_value(params, 'lmem.size'))
+    sram += param_value(params, 'clusters') * cache_bytes('l2cache')
+    sram += cache_bytes('l3cache')
+    regfile = cores * warps * threads * 32 * 4 * 2
+    area = weights['sram'] * sram + weights['regfile'] * regfile
+    area += cores * (weights['lane'] * threads + weights['issue'] * param_value(params, 'issue_width'))
+    return area / 1024.0
+
+def run_command(cmd, cwd=None, env=None, log=None, timeout=None):
+    with open(log, 'w') if log else open(os.devnull, 'w') as out:
+        try:
+            return subprocess.run(cmd, cwd=cwd, env=env, stdout=out, stderr=subprocess.STDOUT, timeout=timeout).returncode
+        except subprocess.TimeoutExpired:
+            out.write("\nError: timeout after %d seconds\n" % timeout)
+            return -1
+
+def find_app(name):
+    for path in (os.path.join(ROOT_DIR, 'tests', name),
+                 os.path.join(ROOT_DIR, 'tests', 'regression', name),
+                 os.path.join(ROOT_DIR, 'tests', 'opencl', name)):
+        if os.path.isdir(path):
+            return path
+    sys.exit("Error: application folder not found: %s" % name)
+
+def app_command(app_path, opts):
+    # resolve the run-simx recipe once, so that parallel jobs do not invoke make in the shared app folder
+    env = dict(os.environ)
+    if opts is not None:
+        env['OPTS'] = opts
+    try:
+        recipe = subprocess.run(['make', '-s', '-n', '-C', app_path, 'run-simx'], env=env, stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL, universal_newlines=True, check=True).stdout
+    except subprocess.CalledProcessError:
+        sys.exit("Error: failed to resolve run-simx for %s" % app_path)
+    lines = [line for line in recipe.splitlines() if 'VORTEX_DRIVER=simx' in line]
+    if not lines:
+        sys.exit("Error: no run-simx command in %s" % app_path)
+    run_env = {}
+    args = shlex.split(lines[-1])
+    while args and '=' in args[0] and not args[0].startswith(('.', '/')):
+        name, value = args.pop(0).split('=', 1)
+        run_env[name] = value
+    if not args:
+        sys.exit("Error: no run-simx command in %s" % app_path)
+    args[0] = os.path.normpath(os.path.join(app_path, args[0]))
+    return args, run_env
+
+def build_driver(defines, outdir):
+    configs = ' '.join(['-DPERF_ENABLE'] + defines)
+    tag = hashlib.sha1(configs.encode()).hexdigest()[:12]
+    destdir = os.path.join(outdir, 'builds', tag)
+    os.makedirs(destdir, exist_ok=True)
+    env = dict(os.environ, DESTDIR=destdir, CONFIGS=configs)
+    log = os.path.join(destdir, 'build.log')
+    print("building simx: CONFIGS=%s" % configs)
+    status = run_command(['make', '-C', os.path.join(ROOT_DIR, 'runtime', 'simx')], env=env, log=log)
+    if status != 0:
+        print("Error: simx build failed, see %s" % log)
+    return destdir, status
+
+def run_job(job, args):
+    rundir = job['rundir']
+    os.makedirs(rundir, exist_ok=True)
+    config_file = os.path.join(rundir, 'simx.json')
+    with open(config_file, 'w') as file:
+        json.dump(job['config'], file, indent=2)
+    perf_file = os.path.join(rundir, 'perf.json')
+    if os.path.exists(perf_file):
+        os.remove(perf_file)
+    env = dict(os.environ)
+    env.update(job['env'])
+    env['VORTEX_DRIVER_PATH'] = job['driver']
+    env['VORTEX_SIMX_CONFIG'] = config_file
+    env['VORTEX_PROFILING'] = str(job['perf_class'])
+    env['VORTEX_PERF_JSON'] = perf_file
+    for name, value in job['run_env'].items():
+        env[name] = value
+    # private working directory exposing the application files (kernel binary, input data)
+    workdir = tempfile.mkdtemp(prefix='work.', dir=rundir)
+    for entry in os.listdir(job['app_path']):
+        os.symlink(os.path.join(job['app_path'], entry), os.path.join(workdir, entry))
+    log = os.path.join(rundir, 'run.log')
+    status = run_command(job['cmd'], cwd=workdir, env=env, log=log, timeout=args.timeout)
+    shutil.rmtree(workdir, ignore_errors=True)
+    perf = None
+    if status == 0 and os.path.exists(perf_file):
+        with open(perf_file, 'r') as file:
+            perf = json.load(file)
+    print("%s %s: %s" % (job['app'], job['point_id'], "PASSED" if perf else "FAILED"))
+    return status, perf
+
+def flatten(prefix, value, row):
+    if isinstance(value, dict):
+        for key, item in value.items():
+            flatten(prefix + '.' + key if prefix else key, item, row)
+    elif isinstance(value, list):
+        row[prefix] = ' '.join(str(item) for item in value)
+    else:
+        row[prefix] = value
+
+def pareto_front(points):
+    # points: list of (area, cycles, row), lower is better for both
+    front = []
+    best_cycles = math.inf
+    for area, cycles, row in sorted(points, key=lambda p: (p[0], p[1])):
+        if cycles < best_cycles:
+            front.append(row)
+            best_cycles = cycles
+    return front
+
+def write_csv(rows, filename):
+    columns = []
+    for row in rows:
+        for key in row.keys():
+            if key not in columns:
+                columns.append(key)
+    with open(filename, 'w', newline='') as file:
+        writer = csv.DictWriter(file, fieldnames=columns)
+        writer.writeheader()
+        for row in rows:
+            writer.writerow(row)
+
+def main():
+    args = parse_args()
+    spec = load_spec(args.spec)
+    outdir = os.path.abspath(args.outdir)
+    base = spec.get('base', {})
+    points = [dict(base, **point) for point in expand_grid(spec.get('grid', {}))]
+    apps = spec['apps']
+    app_opts = spec.get('args', {})
+    perf_class = spec.get('perf_class', 2)
+    weights = dict(AREA_WEIGHTS, **spec.get('area', {}))
+
+    print("sweep: %d points x %d apps" % (len(points), len(apps)))
+    if args.dry_run:
+        for i, point in enumerate(points):
+            config, defines, env = split_params(point)
+            print("p%d: config=%s build=%s env=%s area=%.1f" % (i, json.dumps(config), ' '.join(defines), env, area_proxy(point, weights)))
+        return 0
+
+    os.makedirs(outdir, exist_ok=True)
+
+    # ensure config headers, runtime stub and application binaries are up to date
+    for target in (os.path.join(ROOT_DIR, 'hw'), os.path.join(ROOT_DIR, 'runtime', 'stub')):
+        cmd = ['make', '-C', target] + (['config'] if target.endswith('hw') else [])
+        if run_command(cmd) != 0:
+            sys.exit("Error: failed to build %s" % target)
+    app_paths = {}
+    for app in apps:
+        app_paths[app] = find_app(app)
+        if run_command(['make', '-C', app_paths[app]], log=os.path.join(outdir, os.path.basename(app) + '.build.log')) != 0:
+            sys.exit("Error: failed to build application %s" % app)
+
+    # build one simulator per distinct compile-time configuration
+    builds = {}
+    for point in points:
+        _, defines, _ = split_params(point)
+        builds.setdefault(' '.join(defines), defines)
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        results = dict(zip(builds.keys(), pool.map(lambda d: build_driver(d, outdir), builds.values())))
+
+    # schedule all simulations
+    commands = {}
+    jobs = []
+    for i, point in enumerate(points):
+        config, defines, env = split_params(point)
+        driver, status = results[' '.join(defines)]
+        if status != 0:
+            continue
+        for app in apps:
+            name = os.path.basename(app)
+            opts = app_opts.get(app, app_opts.get(name))
+            if (app, opts) not in commands:
+                commands[(app, opts)] = app_command(app_paths[app], opts)
+            cmd, run_env = commands[(app, opts)]
+            jobs.append({
+                'point_id': 'p%d' % i,
+                'point': point,
+                'app': app,
+                'app_path': app_paths[app],
+                'cmd': cmd,
+                'run_env': run_env,
+                'config': config,
+                'env': env,
+                'driver': driver,
+                'perf_class': perf_class,
+                'rundir': os.path.join(outdir, 'runs', 'p%d' % i, name),
+            })
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        outcomes = list(pool.map(lambda job: run_job(job, args), jobs))
+
+    # aggregate results
+    rows = []
+    by_point = {}
+    for job, (status, perf) in zip(jobs, outcomes):
+        row = {'point': job['point_id'], 'app': job['app']}
+        row.update(job['point'])
+        row['area'] = round(area_proxy(job['point'], weights), 1)
+        row['status'] = 'ok' if perf else 'failed(%d)' % status
+        if perf:
+            perf = dict(perf)
+            perf.pop('core_instrs', None)
+            perf.pop('core_cycles', None)
+            flatten('', perf, row)
+            by_point.setdefault(job['point_id'], {})[job['app']] = row
+        rows.append(row)
+    write_csv(rows, os.path.join(outdir, 'results.csv'))
+    with open(os.path.join(outdir, 'results.json'), 'w') as file:
+        json.dump(rows, file, indent=2)
+
+    # Pareto fronts of cycles vs area, per application and for the geometric mean across applications
+    summary = {}
+    for app in apps:
+        candidates = [(row['area'], row['cycles'], row) for row in rows if row['app'] == app and row['status'] == 'ok']
+        summary[app] = [{'point': row['point'], 'area': row['area'], 'cycles': row['cycles']} for row in pareto_front(candidates)]
+    candidates = []
+    for point_id, app_rows in by_point.items():
+        if len(app_rows) != len(apps):
+            continue
+        gmean = math.exp(sum(math.log(max(row['cycles'], 1)) for row in app_rows.values()) / len(apps))
+        area = next(iter(app_rows.values()))['area']
+        candidates.append((area, gmean, {'point': point_id, 'area': area, 'cycles': round(gmean, 1)}))
+    summary['geomean'] = pareto_front(candidates)
+    with open(os.path.join(outdir, 'pareto.json'), 'w') as file:
+        json.dump(summary, file, indent=2)
+
+    for name, front in summary.items():
+        print("pareto %s:" % name)
+        for entry in front:
+            print("  %s: area=%.1f, cycles=%s" % (entry['point'], entry['area'], entry['cycles']))
+
+    failed = sum(1 for row in rows if row['status'] != 'ok')
+    print("sweep done: %d runs, %d failed, results in %s" % (len(rows), failed, outdir))
+    return 1 if failed else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
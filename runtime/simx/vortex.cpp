@@ -61,13 +61,13 @@ public:
       _value = IMPLEMENTATION_ID;
       break;
     case VX_CAPS_NUM_THREADS:
-      _value = NUM_THREADS;
+      _value = arch_.num_threads();
       break;
     case VX_CAPS_NUM_WARPS:
-      _value = NUM_WARPS;
+      _value = arch_.num_warps();
       break;
     case VX_CAPS_NUM_CORES:
-      _value = NUM_CORES * NUM_CLUSTERS;
+      _value = arch_.num_cores() * arch_.num_clusters();
       break;
     case VX_CAPS_CACHE_LINE_SIZE:
       _value = CACHE_BLOCK_SIZE;
@@ -183,6 +183,11 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t ibuffer_stalls = 0;
   uint64_t scrb_stalls = 0;
   uint64_t opds_stalls = 0;
+  uint64_t uniform_instrs = 0;
+  uint64_t salu_instrs = 0;
+  uint64_t warp_instrs = 0;
+  uint64_t warp_threads = 0;
+  uint64_t compact_instrs = 0;
   uint64_t scrb_alu = 0;
   uint64_t scrb_fpu = 0;
   uint64_t scrb_lsu = 0;
@@ -214,6 +219,9 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t mem_reads = 0;
   uint64_t mem_writes = 0;
   uint64_t mem_lat = 0;
+  // PERF: near-memory atomics
+  uint64_t amo_reqs = 0;
+  uint64_t amo_stalls = 0;
   // PERF: texunit
   uint64_t tex_mem_reads = 0;
   uint64_t tex_mem_lat = 0;
@@ -226,6 +234,9 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t raster_mem_reads = 0;
   uint64_t raster_mem_lat = 0;
   uint64_t raster_stall_cycles = 0;
+  uint64_t raster_stamps = 0;
+  uint64_t raster_hiz_tiles = 0;
+  uint64_t raster_hiz_stamps = 0;
   // PERF: raster cache
   uint64_t rcache_reads = 0;
   uint64_t rcache_read_misses = 0;
@@ -242,12 +253,44 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t ocache_write_misses = 0;
   uint64_t ocache_bank_stalls = 0;
   uint64_t ocache_mshr_stalls = 0;
+  // PERF: om tile buffer
+  uint64_t om_imm_reads = 0;
+  uint64_t om_imm_writes = 0;
+  // PERF: dram
+  uint64_t dram_channels = 0;
+  uint64_t dram_reads = 0;
+  uint64_t dram_writes = 0;
+  uint64_t dram_turns = 0;
+  uint64_t dram_queue_lat = 0;
+  uint64_t dram_lat_hist[8] = {};
+  uint64_t dram_queue_hist[4] = {};
+  uint64_t dram_ch_bytes[8] = {};
+  // PERF: SIMT
+  uint64_t simt_instrs = 0;
+  uint64_t simt_threads = 0;
+  uint64_t simt_splits = 0;
+  uint64_t simt_div_splits = 0;
+  uint64_t simt_joins = 0;
+  uint64_t simt_depth = 0;
+  uint64_t simt_div_cycles = 0;
+  uint64_t simt_lanes_hist[8] = {};
+  // PERF: CPI stack
+  static const char* cpi_names[] = {"base", "icache", "memory", "structural", "alu", "fpu", "sfu", "barrier", "wctl", "idle"};
+  static const int num_cpi = sizeof(cpi_names) / sizeof(cpi_names[0]);
+  uint64_t cpi_stack[num_cpi] = {};
+  std::vector<uint64_t> core_instrs;
+  std::vector<uint64_t> core_cycles;
 
   uint64_t num_cores;
   CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_NUM_CORES, &num_cores), {
     return err;
   });
 
+  uint64_t num_threads;
+  CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_NUM_THREADS, &num_threads), {
+    return err;
+  });
+
   uint64_t isa_flags;
   CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_ISA_FLAGS, &isa_flags), {
     return err;
@@ -388,6 +431,45 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
         }
         opds_stalls += opds_stalls_per_core;
       }
+      // warp-uniform execution
+      {
+        uint64_t uniform_per_core, salu_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_UNIFORM, core_id, &uniform_per_core), {
+          return err;
+        });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SALU, core_id, &salu_per_core), {
+          return err;
+        });
+        if (num_cores > 1) {
+          fprintf(stream, "PERF: core%d: uniform instrs=%ld, scalar unit instrs=%ld\n", core_id, uniform_per_core, salu_per_core);
+        }
+        uniform_instrs += uniform_per_core;
+        salu_instrs += salu_per_core;
+      }
+      // SIMT efficiency
+      {
+        uint64_t warp_instrs_per_core, warp_threads_per_core, compact_instrs_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_WARP_INSTRS, core_id, &warp_instrs_per_core), {
+          return err;
+        });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_WARP_THREADS, core_id, &warp_threads_per_core), {
+          return err;
+        });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_COMPACT_INSTRS, core_id, &compact_instrs_per_core), {
+          return err;
+        });
+        if (num_cores > 1) {
+          int simt_percent_per_core = calcAvgPercent(warp_threads_per_core, warp_instrs_per_core * num_threads);
+          fprintf(stream, "PERF: core%d: SIMT efficiency=%d%%", core_id, simt_percent_per_core);
+          if (compact_instrs_per_core != 0) {
+            fprintf(stream, ", with compaction (upper bound)=%d%%", calcAvgPercent(warp_threads_per_core, compact_instrs_per_core * num_threads));
+          }
+          fprintf(stream, "\n");
+        }
+        warp_instrs += warp_instrs_per_core;
+        warp_threads += warp_threads_per_core;
+        compact_instrs += compact_instrs_per_core;
+      }
       // PERF: memory
       // ifetches
       {
@@ -582,6 +664,13 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
         CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_MEM_LT, core_id, &mem_lat), {
           return err;
         });
+        // PERF: atomics
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_AMO_REQS, core_id, &amo_reqs), {
+          return err;
+        });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_AMO_ST, core_id, &amo_stalls), {
+          return err;
+        });
       }
     } break;
     case VX_DCR_MPM_CLASS_TEX: {
@@ -619,6 +708,13 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 			rcache_bank_stalls += tmp;
       CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_RCACHE_MSHR_ST, core_id, &tmp), { return err; });
 			rcache_mshr_stalls += tmp;
+      // hierarchical-Z counters
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_RASTER_STAMPS, core_id, &tmp), { return err; });
+			raster_stamps += tmp;
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_RASTER_HIZ_TILES, core_id, &tmp), { return err; });
+			raster_hiz_tiles += tmp;
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_RASTER_HIZ_STAMPS, core_id, &tmp), { return err; });
+			raster_hiz_stamps += tmp;
     } break;
     case VX_DCR_MPM_CLASS_OM: {
       uint64_t tmp;
@@ -643,6 +739,70 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 			ocache_bank_stalls += tmp;
       CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_OCACHE_MSHR_ST, core_id, &tmp), { return err; });
 			ocache_mshr_stalls += tmp;
+      // tile buffer perf counters
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_OM_IMM_READS, core_id, &tmp), { return err; });
+			om_imm_reads += tmp;
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_OM_IMM_WRITES, core_id, &tmp), { return err; });
+			om_imm_writes += tmp;
+    } break;
+    case VX_DCR_MPM_CLASS_DRAM: {
+      if (0 == core_id) {
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_CHANNELS, core_id, &dram_channels), { return err; });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_READS, core_id, &dram_reads), { return err; });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_WRITES, core_id, &dram_writes), { return err; });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_TURNS, core_id, &dram_turns), { return err; });
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_QUEUE_LT, core_id, &dram_queue_lat), { return err; });
+        for (int i = 0; i < 8; ++i) {
+          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_LAT_HIST + i, core_id, &dram_lat_hist[i]), { return err; });
+        }
+        for (int i = 0; i < 4; ++i) {
+          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_QUEUE_HIST + i, core_id, &dram_queue_hist[i]), { return err; });
+        }
+        for (int i = 0; i < 8; ++i) {
+          CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DRAM_CH_BYTES + i, core_id, &dram_ch_bytes[i]), { return err; });
+        }
+      }
+    } break;
+    case VX_DCR_MPM_CLASS_SIMT: {
+      uint64_t instrs_per_core, threads_per_core, splits_per_core, div_splits_per_core, joins_per_core, depth_per_core, div_cycles_per_core;
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_INSTRS, core_id, &instrs_per_core), { return err; });
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_THREADS, core_id, &threads_per_core), { return err; });
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_SPLITS, core_id, &splits_per_core), { return err; });
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_DIV_SPLITS, core_id, &div_splits_per_core), { return err; });
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_JOINS, core_id, &joins_per_core), { return err; });
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_DEPTH, core_id, &depth_per_core), { return err; });
+      CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_DIV_CYCLES, core_id, &div_cycles_per_core), { return err; });
+      for (int i = 0; i < 8; ++i) {
+        uint64_t count;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_SIMT_LANES_HIST + i, core_id, &count), { return err; });
+        simt_lanes_hist[i] += count;
+      }
+      if (num_cores > 1) {
+        fprintf(stream, "PERF: core%d: SIMT efficiency=%d%%, divergent splits=%ld/%ld, divergent cycles=%ld, max ipdom depth=%ld\n", core_id, calcAvgPercent(threads_per_core, instrs_per_core * num_threads), div_splits_per_core, splits_per_core, div_cycles_per_core, depth_per_core);
+      }
+      simt_instrs += instrs_per_core;
+      simt_threads += threads_per_core;
+      simt_splits += splits_per_core;
+      simt_div_splits += div_splits_per_core;
+      simt_joins += joins_per_core;
+      simt_depth = std::max<uint64_t>(simt_depth, depth_per_core);
+      simt_div_cycles += div_cycles_per_core;
+    } break;
+    case VX_DCR_MPM_CLASS_CPI: {
+      uint64_t cpi_per_core[num_cpi];
+      uint64_t slots_per_core = 0;
+      for (int i = 0; i < num_cpi; ++i) {
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_CPI_STACK + i, core_id, &cpi_per_core[i]), { return err; });
+        slots_per_core += cpi_per_core[i];
+        cpi_stack[i] += cpi_per_core[i];
+      }
+      if (num_cores > 1) {
+        fprintf(stream, "PERF: core%d: CPI stack:", core_id);
+        for (int i = 0; i < num_cpi; ++i) {
+          fprintf(stream, "%s %s=%d%%", (i ? "," : ""), cpi_names[i], calcAvgPercent(cpi_per_core[i], slots_per_core));
+        }
+        fprintf(stream, "\n");
+      }
     } break;
     default:
       break;
@@ -650,6 +810,8 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 
     float IPC = caclAverage(instrs_per_core, cycles_per_core);
     if (num_cores > 1) fprintf(stream, "PERF: core%d: instrs=%ld, cycles=%ld, IPC=%f\n", core_id, instrs_per_core, cycles_per_core, IPC);
+    core_instrs.push_back(instrs_per_core);
+    core_cycles.push_back(cycles_per_core);
     total_instrs += instrs_per_core;
     total_cycles += cycles_per_core;
     max_cycles = std::max<uint64_t>(cycles_per_core, max_cycles);
@@ -681,6 +843,12 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       , calcAvgPercent(scrb_raster, scrb_total)
     );
     fprintf(stream, "PERF: operands stalls=%ld (%d%%)\n", opds_stalls, opds_percent);
+    fprintf(stream, "PERF: uniform instrs=%ld (%d%%), scalar unit instrs=%ld (%d%%)\n", uniform_instrs, calcAvgPercent(uniform_instrs, total_instrs), salu_instrs, calcAvgPercent(salu_instrs, total_instrs));
+    fprintf(stream, "PERF: SIMT efficiency=%d%% (warp instrs=%ld)", calcAvgPercent(warp_threads, warp_instrs * num_threads), warp_instrs);
+    if (compact_instrs != 0) {
+      fprintf(stream, ", with compaction (upper bound)=%d%% (warp instrs=%ld)", calcAvgPercent(warp_threads, compact_instrs * num_threads), compact_instrs);
+    }
+    fprintf(stream, "\n");
     fprintf(stream, "PERF: ifetches=%ld\n", ifetches);
     fprintf(stream, "PERF: loads=%ld\n", loads);
     fprintf(stream, "PERF: stores=%ld\n", stores);
@@ -721,6 +889,10 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     int mem_avg_lat = caclAverage(mem_lat, mem_reads);
     fprintf(stream, "PERF: memory requests=%ld (reads=%ld, writes=%ld)\n", (mem_reads + mem_writes), mem_reads, mem_writes);
     fprintf(stream, "PERF: memory latency=%d cycles\n", mem_avg_lat);
+    if (amo_reqs != 0) {
+      int amo_utilization = calcAvgPercent(amo_reqs, amo_reqs + amo_stalls);
+      fprintf(stream, "PERF: atomics=%ld, line contention stalls=%ld (utilization=%d%%)\n", amo_reqs, amo_stalls, amo_utilization);
+    }
   } break;
   case VX_DCR_MPM_CLASS_TEX: {
     tex_mem_reads /= num_cores;
@@ -763,6 +935,14 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     fprintf(stream, "PERF: rcache read misses=%ld (hit ratio=%d%%)\n", rcache_read_misses, read_hit_ratio);
     fprintf(stream, "PERF: rcache bank stalls=%ld (utilization=%d%%)\n", rcache_bank_stalls, bank_utilization);
     fprintf(stream, "PERF: rcache mshr stalls=%ld (utilization=%d%%)\n", rcache_mshr_stalls, mshr_utilization);
+    // hierarchical-Z counters
+    raster_stamps /= num_cores;
+    raster_hiz_tiles /= num_cores;
+    raster_hiz_stamps /= num_cores;
+    int hiz_culled_ratio = calcAvgPercent(raster_hiz_stamps, raster_stamps + raster_hiz_stamps);
+    fprintf(stream, "PERF: raster stamps=%ld\n", raster_stamps);
+    fprintf(stream, "PERF: raster hiz culled tiles=%ld\n", raster_hiz_tiles);
+    fprintf(stream, "PERF: raster hiz culled stamps=%ld (%d%%)\n", raster_hiz_stamps, hiz_culled_ratio);
   } break;
   case VX_DCR_MPM_CLASS_OM: {
     om_mem_reads /= num_cores;
@@ -775,6 +955,15 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     fprintf(stream, "PERF: om memory writes=%ld\n", om_mem_writes);
     fprintf(stream, "PERF: om memory latency=%d cycles\n", om_mem_avg_lat);
     fprintf(stream, "PERF: om stalls=%ld (%d%%)\n", om_stall_cycles, om_stall_cycles_ratio);
+    // traffic saved by the tile buffer over immediate mode
+    om_imm_reads /= num_cores;
+    om_imm_writes /= num_cores;
+    uint64_t om_saved_reads  = (om_imm_reads > om_mem_reads) ? (om_imm_reads - om_mem_reads) : 0;
+    uint64_t om_saved_writes = (om_imm_writes > om_mem_writes) ? (om_imm_writes - om_mem_writes) : 0;
+    int om_saved_reads_ratio  = calcAvgPercent(om_saved_reads, om_imm_reads);
+    int om_saved_writes_ratio = calcAvgPercent(om_saved_writes, om_imm_writes);
+    fprintf(stream, "PERF: om tile buffer saved reads=%ld (%d%%)\n", om_saved_reads, om_saved_reads_ratio);
+    fprintf(stream, "PERF: om tile buffer saved writes=%ld (%d%%)\n", om_saved_writes, om_saved_writes_ratio);
     // cache perf counters
     ocache_reads /= num_cores;
     ocache_writes /= num_cores;
@@ -792,6 +981,67 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     fprintf(stream, "PERF: ocache bank stalls=%ld (utilization=%d%%)\n", ocache_bank_stalls, bank_utilization);
     fprintf(stream, "PERF: ocache mshr stalls=%ld (utilization=%d%%)\n", ocache_mshr_stalls, mshr_utilization);
   } break;
+  case VX_DCR_MPM_CLASS_DRAM: {
+    static const char* lat_bins[] = {"<32", "<64", "<128", "<256", "<512", "<1024", "<2048", ">=2048"};
+    static const char* queue_bins[] = {"empty", "<half", ">=half", "full"};
+    uint64_t dram_requests = dram_reads + dram_writes;
+    uint64_t dram_reads_done = 0;
+    for (int i = 0; i < 8; ++i) {
+      dram_reads_done += dram_lat_hist[i];
+    }
+    uint64_t queue_samples = 0;
+    for (int i = 0; i < 4; ++i) {
+      queue_samples += dram_queue_hist[i];
+    }
+    uint64_t dram_bytes = 0;
+    for (uint64_t i = 0; i < dram_channels && i < 8; ++i) {
+      dram_bytes += dram_ch_bytes[i];
+    }
+    fprintf(stream, "PERF: dram channels=%ld\n", dram_channels);
+    fprintf(stream, "PERF: dram requests=%ld (reads=%ld, writes=%ld)\n", dram_requests, dram_reads, dram_writes);
+    fprintf(stream, "PERF: dram bandwidth=%.2f bytes/cycle\n", caclAverage(dram_bytes, max_cycles));
+    for (uint64_t i = 0; i < dram_channels && i < 8; ++i) {
+      fprintf(stream, "PERF: dram channel%ld bandwidth=%.2f bytes/cycle\n", i, caclAverage(dram_ch_bytes[i], max_cycles));
+    }
+    fprintf(stream, "PERF: dram read/write turnarounds=%ld\n", dram_turns);
+    fprintf(stream, "PERF: dram queue latency=%d cycles\n", int(caclAverage(dram_queue_lat, dram_requests)));
+    fprintf(stream, "PERF: dram latency histogram:");
+    for (int i = 0; i < 8; ++i) {
+      fprintf(stream, " %s=%d%%", lat_bins[i], calcAvgPercent(dram_lat_hist[i], dram_reads_done));
+    }
+    fprintf(stream, "\n");
+    fprintf(stream, "PERF: dram queue occupancy:");
+    for (int i = 0; i < 4; ++i) {
+      fprintf(stream, " %s=%d%%", queue_bins[i], calcAvgPercent(dram_queue_hist[i], queue_samples));
+    }
+    fprintf(stream, "\n");
+  } break;
+  case VX_DCR_MPM_CLASS_SIMT: {
+    static const char* lanes_bins[] = {"<=1/8", "<=2/8", "<=3/8", "<=4/8", "<=5/8", "<=6/8", "<=7/8", "full"};
+    fprintf(stream, "PERF: SIMT efficiency=%d%% (warp instrs=%ld, active threads=%ld)\n", calcAvgPercent(simt_threads, simt_instrs * num_threads), simt_instrs, simt_threads);
+    fprintf(stream, "PERF: active lanes histogram:");
+    for (int i = 0; i < 8; ++i) {
+      fprintf(stream, " %s=%d%%", lanes_bins[i], calcAvgPercent(simt_lanes_hist[i], simt_instrs));
+    }
+    fprintf(stream, "\n");
+    fprintf(stream, "PERF: splits=%ld (divergent=%d%%), joins=%ld\n", simt_splits, calcAvgPercent(simt_div_splits, simt_splits), simt_joins);
+    fprintf(stream, "PERF: max ipdom depth=%ld\n", simt_depth);
+    fprintf(stream, "PERF: divergent cycles=%ld (%d%%)\n", simt_div_cycles, calcAvgPercent(simt_div_cycles, total_cycles));
+  } break;
+  case VX_DCR_MPM_CLASS_CPI: {
+    // issue slot cycles per issued warp instruction, stacked by category
+    uint64_t cpi_slots = 0;
+    for (int i = 0; i < num_cpi; ++i) {
+      cpi_slots += cpi_stack[i];
+    }
+    uint64_t cpi_base = cpi_stack[0];
+    fprintf(stream, "PERF: issue slot cycles=%ld, warp instrs=%ld, CPI=%f\n", cpi_slots, cpi_base, caclAverage(cpi_slots, cpi_base));
+    fprintf(stream, "PERF: CPI stack:");
+    for (int i = 0; i < num_cpi; ++i) {
+      fprintf(stream, "%s %s=%f (%d%%)", (i ? "," : ""), cpi_names[i], caclAverage(cpi_stack[i], cpi_base), calcAvgPercent(cpi_stack[i], cpi_slots));
+    }
+    fprintf(stream, "\n");
+  } break;
   default:
     break;
   }
@@ -801,6 +1051,82 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
 
   fflush(stream);
 
+  // dump counters to a JSON file
+  auto json_s = getenv("VORTEX_PERF_JSON");
+  if (json_s && *json_s) {
+    auto json = fopen(json_s, "w");
+    if (nullptr == json) {
+      printf("Error: cannot open perf dump file '%s'\n", json_s);
+      return -1;
+    }
+    auto dump_array = [&](const char* name, const uint64_t* values, uint64_t size) {
+      fprintf(json, "\"%s\": [", name);
+      for (uint64_t i = 0; i < size; ++i) {
+        fprintf(json, "%s%ld", (i ? ", " : ""), values[i]);
+      }
+      fprintf(json, "]");
+    };
+    fprintf(json, "{\n");
+    fprintf(json, "  \"perf_class\": %d,\n", perf_class);
+    fprintf(json, "  \"instrs\": %ld,\n", total_instrs);
+    fprintf(json, "  \"cycles\": %ld,\n", max_cycles);
+    fprintf(json, "  \"ipc\": %f,\n", IPC);
+    fprintf(json, "  ");
+    dump_array("core_instrs", core_instrs.data(), core_instrs.size());
+    fprintf(json, ",\n  ");
+    dump_array("core_cycles", core_cycles.data(), core_cycles.size());
+    switch (perf_class) {
+    case VX_DCR_MPM_CLASS_MEM: {
+      fprintf(json, ",\n  \"memory\": {\"reads\": %ld, \"writes\": %ld, \"latency\": %ld}", mem_reads, mem_writes, mem_lat);
+    } break;
+    case VX_DCR_MPM_CLASS_DRAM: {
+      uint64_t num_channels = std::min<uint64_t>(dram_channels, 8);
+      fprintf(json, ",\n  \"dram\": {\n");
+      fprintf(json, "    \"channels\": %ld,\n", dram_channels);
+      fprintf(json, "    \"reads\": %ld,\n", dram_reads);
+      fprintf(json, "    \"writes\": %ld,\n", dram_writes);
+      fprintf(json, "    \"turnarounds\": %ld,\n", dram_turns);
+      fprintf(json, "    \"queue_latency\": %ld,\n", dram_queue_lat);
+      fprintf(json, "    ");
+      dump_array("channel_bytes", dram_ch_bytes, num_channels);
+      fprintf(json, ",\n    \"channel_bandwidth\": [");
+      for (uint64_t i = 0; i < num_channels; ++i) {
+        fprintf(json, "%s%f", (i ? ", " : ""), caclAverage(dram_ch_bytes[i], max_cycles));
+      }
+      fprintf(json, "],\n    ");
+      dump_array("latency_hist", dram_lat_hist, 8);
+      fprintf(json, ",\n    ");
+      dump_array("queue_hist", dram_queue_hist, 4);
+      fprintf(json, "\n  }");
+    } break;
+    case VX_DCR_MPM_CLASS_SIMT: {
+      fprintf(json, ",\n  \"simt\": {\n");
+      fprintf(json, "    \"warp_instrs\": %ld,\n", simt_instrs);
+      fprintf(json, "    \"active_threads\": %ld,\n", simt_threads);
+      fprintf(json, "    \"efficiency\": %f,\n", caclAverage(simt_threads, simt_instrs * num_threads));
+      fprintf(json, "    \"splits\": %ld,\n", simt_splits);
+      fprintf(json, "    \"divergent_splits\": %ld,\n", simt_div_splits);
+      fprintf(json, "    \"joins\": %ld,\n", simt_joins);
+      fprintf(json, "    \"max_ipdom_depth\": %ld,\n", simt_depth);
+      fprintf(json, "    \"divergent_cycles\": %ld,\n", simt_div_cycles);
+      fprintf(json, "    ");
+      dump_array("lanes_hist", simt_lanes_hist, 8);
+      fprintf(json, "\n  }");
+    } break;
+    case VX_DCR_MPM_CLASS_CPI: {
+      fprintf(json, ",\n  \"cpi_stack\": {");
+      for (int i = 0; i < num_cpi; ++i) {
+        fprintf(json, "%s\"%s\": %ld", (i ? ", " : ""), cpi_names[i], cpi_stack[i]);
+      }
+      fprintf(json, "}");
+    } break;
+    default:
+      break;
+    }
+    fprintf(json, "\n}\n");
+    fclose(json);
+  }
+
   return 0;
 }
 
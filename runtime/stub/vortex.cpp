@@ -63,6 +63,11 @@ extern int vx_dev_open(vx_device_h* hdevice) {
     }
     std::string driverName_s(driverName);
     std::string libName = "libvortex-" + driverName_s + ".so";
+    // load the driver from an explicit directory if requested
+    const char* driverPath = getenv("VORTEX_DRIVER_PATH");
+    if (driverPath != nullptr && *driverPath) {
+      libName = std::string(driverPath) + "/" + libName;
+    }
     auto handle = dlopen(libName.c_str(), RTLD_LAZY);
     if (handle == nullptr) {
       std::cerr << "Cannot open library: " << dlerror() << std::endl;
@@ -82,6 +82,34 @@ inline uint64_t bit_getw(uint64_t bits, uint32_t start, uint32_t end) {
     return (bits << shift) >> (shift + start);
 }
 
+// xor-fold all bits of a value into a width-bit result
+inline uint64_t bit_xorw(uint64_t bits, uint32_t width) {
+    assert(width > 0 && width <= 63);
+    uint64_t mask = (uint64_t(1) << width) - 1;
+    uint64_t value = 0;
+    while (bits != 0) {
+      value ^= (bits & mask);
+      bits >>= width;
+    }
+    return value;
+}
+
+// largest prime number not greater than value
+inline uint32_t prime_floor(uint32_t value) {
+  for (uint32_t n = value; n > 2; --n) {
+    bool is_prime = true;
+    for (uint32_t d = 2; d * d <= n; ++d) {
+      if (0 == (n % d)) {
+        is_prime = false;
+        break;
+      }
+    }
+    if (is_prime)
+      return n;
+  }
+  return value;
+}
+
 template <typename T = uint32_t>
 T sext(const T& word, uint32_t width) {
   assert(width > 1);
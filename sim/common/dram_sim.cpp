@@ -13,7 +13,15 @@
 
 #include "dram_sim.h"
 #include "util.h"
+#include <algorithm>
 #include <fstream>
+#include <iostream>
+#include <string>
+#include <strings.h>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 
 DISABLE_WARNING_PUSH
 DISABLE_WARNING_UNUSED_PARAMETER
@@ -27,33 +35,118 @@ DISABLE_WARNING_POP
 
 using namespace vortex;
 
-class DramSim::Impl {
+namespace {
+
+struct dram_preset_t {
+	const char* name;
+	const char* impl;
+	const char* org;
+	const char* timing;
+	int density;  // 0: org preset default
+	int channels; // 0: org preset default
+	int ranks;    // 0: no rank level
+};
+
+const dram_preset_t dram_presets[] = {
+	{"DDR4",   "DDR4",   "DDR4_8Gb_x8",    "DDR4_2400R",               0,    1, 2},
+	{"GDDR6",  "GDDR6",  "GDDR6_8Gb_x16",  "GDDR6_2000_1350mV_double", 0,    0, 0},
+	{"HBM2",   "HBM2",   "HBM2_8Gb",       "HBM2_2Gbps",               8192, 0, 0},
+	{"HBM3",   "HBM3",   "HBM3_8Gb",       "HBM3_2Gbps",               0,    0, 0},
+	{"LPDDR5", "LPDDR5", "LPDDR5_8Gb_x16", "LPDDR5_6400",              0,    1, 2},
+};
+
+const char* default_dram_preset = "HBM2";
+
+const dram_preset_t* find_dram_preset(const std::string& name) {
+	for (auto& preset : dram_presets) {
+		if (0 == strcasecmp(preset.name, name.c_str()))
+			return &preset;
+	}
+	return nullptr;
+}
+
+// recursively overlay src map entries onto dst
+void merge_yaml(YAML::Node dst, const YAML::Node& src) {
+	if (!src || !src.IsMap()) {
+		return;
+	}
+	for (auto it : src) {
+		auto key = it.first.as<std::string>();
+		if (it.second.IsMap() && dst[key] && dst[key].IsMap()) {
+			merge_yaml(dst[key], it.second);
+		} else {
+			dst[key] = it.second;
+		}
+	}
+}
+
+
+class DramModel {
+public:
+	virtual ~DramModel() {}
+
+	virtual void reset() = 0;
+
+	virtual void tick() = 0;
+
+	virtual bool send_request(bool is_write, uint64_t addr, int source_id, DramSim::ResponseCallback callback, void* arg) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class RamulatorModel : public DramModel {
 private:
 	Ramulator::IFrontEnd* ramulator_frontend_;
 	Ramulator::IMemorySystem* ramulator_memorysystem_;
 
 public:
-	Impl(int clock_ratio) {
+	RamulatorModel(int clock_ratio, const dram_preset_t* preset, const YAML::Node& user) {
 		YAML::Node dram_config;
 		dram_config["Frontend"]["impl"] = "GEM5";
 		dram_config["MemorySystem"]["impl"] = "GenericDRAM";
 		dram_config["MemorySystem"]["clock_ratio"] = clock_ratio;
-		dram_config["MemorySystem"]["DRAM"]["impl"] = "HBM2";
-		dram_config["MemorySystem"]["DRAM"]["org"]["preset"] = "HBM2_8Gb";
-		dram_config["MemorySystem"]["DRAM"]["org"]["density"] = 8192;
-		dram_config["MemorySystem"]["DRAM"]["timing"]["preset"] = "HBM2_2Gbps";
+		dram_config["MemorySystem"]["DRAM"]["impl"] = preset->impl;
+		dram_config["MemorySystem"]["DRAM"]["org"]["preset"] = preset->org;
+		if (preset->density) {
+			dram_config["MemorySystem"]["DRAM"]["org"]["density"] = preset->density;
+		}
+		if (preset->channels) {
+			dram_config["MemorySystem"]["DRAM"]["org"]["channel"] = preset->channels;
+		}
+		if (preset->ranks) {
+			dram_config["MemorySystem"]["DRAM"]["org"]["rank"] = preset->ranks;
+		}
+		dram_config["MemorySystem"]["DRAM"]["timing"]["preset"] = preset->timing;
 		dram_config["MemorySystem"]["Controller"]["impl"] = "Generic";
 		dram_config["MemorySystem"]["Controller"]["Scheduler"]["impl"] = "FRFCFS";
 		dram_config["MemorySystem"]["Controller"]["RefreshManager"]["impl"] = "AllBank";
-		dram_config["MemorySystem"]["Controller"]["RefreshManager"]["impl"] = "AllBank";
 		dram_config["MemorySystem"]["Controller"]["RowPolicy"]["impl"] = "OpenRowPolicy";
-		{
+		dram_config["MemorySystem"]["AddrMapper"]["impl"] = "RoBaRaCoCh";
+
+		// apply user overrides
+		if (user["channels"]) {
+			dram_config["MemorySystem"]["DRAM"]["org"]["channel"] = user["channels"].as<int>();
+		}
+		if (user["ranks"]) {
+			dram_config["MemorySystem"]["DRAM"]["org"]["rank"] = user["ranks"].as<int>();
+		}
+		merge_yaml(dram_config["MemorySystem"], user["MemorySystem"]);
+
+		// command trace recording is disabled by default
+		std::string trace_path;
+		if (user["trace"]) {
+			trace_path = user["trace"].as<std::string>();
+		}
+		auto trace_s = getenv("VORTEX_DRAM_TRACE");
+		if (trace_s && *trace_s) {
+			trace_path = trace_s;
+		}
+		if (!trace_path.empty()) {
 			YAML::Node draw_plugin;
 			draw_plugin["ControllerPlugin"]["impl"] = "TraceRecorder";
-			draw_plugin["ControllerPlugin"]["path"] = "./trace/ramulator.log";
+			draw_plugin["ControllerPlugin"]["path"] = trace_path;
 			dram_config["MemorySystem"]["Controller"]["plugins"].push_back(draw_plugin);
 		}
-		dram_config["MemorySystem"]["AddrMapper"]["impl"] = "RoBaRaCoCh";
 
 		ramulator_frontend_ = Ramulator::Factory::create_frontend(dram_config);
 		ramulator_memorysystem_ = Ramulator::Factory::create_memory_system(dram_config);
@@ -61,7 +154,7 @@ public:
 		ramulator_memorysystem_->connect_frontend(ramulator_frontend_);
 	}
 
-	~Impl() {
+	~RamulatorModel() {
 		std::ofstream nullstream("ramulator.stats.log");
 		auto original_buf = std::cout.rdbuf();
 		std::cout.rdbuf(nullstream.rdbuf());
@@ -70,15 +163,15 @@ public:
 		std::cout.rdbuf(original_buf);
 	}
 
-	void reset() {
+	void reset() override {
 		//--
 	}
 
-	void tick() {
+	void tick() override {
 		ramulator_memorysystem_->tick();
 	}
 
-  bool send_request(bool is_write, uint64_t addr, int source_id, ResponseCallback callback, void* arg) {
+  bool send_request(bool is_write, uint64_t addr, int source_id, DramSim::ResponseCallback callback, void* arg) override {
     if (!ramulator_frontend_->receive_external_requests(
 			is_write ? Ramulator::Request::Type::Write : Ramulator::Request::Type::Read,
 			addr,
@@ -99,6 +192,228 @@ public:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// First-order DRAM model: fixed access latency, a per-channel token bucket
+// bandwidth limiter and an optional open-row buffer per bank.
+// Parameters are given in DRAM cycles and scaled by the clock ratio (core
+// cycles per DRAM cycle), as for the Ramulator memory system.
+// The defaults are first-order estimates from the HBM2 preset (HBM2_2Gbps):
+// - latency: CAS latency plus the burst, plus an allowance for the controller
+//   and frontend queues.
+// - row_miss_latency: precharge plus activate (tRP + tRCD).
+// - bandwidth: one 64-byte burst every two DRAM cycles per channel.
+// They have not been fitted to the Ramulator path: compare both models with
+// tests/regression/dramcal before relying on absolute numbers.
+class AnalyticModel : public DramModel {
+public:
+	struct Params {
+		uint32_t latency;          // access latency on a row hit (DRAM cycles)
+		uint32_t row_miss_latency; // additional latency on a row miss (0: no row model)
+		uint32_t row_size;         // row size (bytes)
+		uint32_t num_banks;        // banks per channel
+		double   bandwidth;        // requests per DRAM cycle per channel
+		uint32_t burst;            // token bucket capacity (requests)
+
+		Params()
+			: latency(24)
+			, row_miss_latency(14)
+			, row_size(1024)
+			, num_banks(16)
+			, bandwidth(0.5)
+			, burst(4)
+		{}
+	};
+
+	AnalyticModel(int clock_ratio, const YAML::Node& user)
+		: clock_ratio_(std::max(clock_ratio, 1))
+		, cycles_(0)
+	{
+		const YAML::Node& node = user["analytic"];
+		if (node) {
+			if (node["latency"])          params_.latency = node["latency"].as<uint32_t>();
+			if (node["row_miss_latency"]) params_.row_miss_latency = node["row_miss_latency"].as<uint32_t>();
+			if (node["row_size"])         params_.row_size = node["row_size"].as<uint32_t>();
+			if (node["banks"])            params_.num_banks = node["banks"].as<uint32_t>();
+			if (node["bandwidth"])        params_.bandwidth = node["bandwidth"].as<double>();
+			if (node["burst"])            params_.burst = node["burst"].as<uint32_t>();
+		}
+		if (params_.row_size == 0 || params_.num_banks == 0
+		 || params_.bandwidth <= 0 || params_.burst == 0) {
+			std::cout << "Error: invalid analytic DRAM parameters" << std::endl;
+			std::abort();
+		}
+		this->reset();
+	}
+
+	void reset() override {
+		// in-flight responses still complete and release their callback
+		// arguments, as with the Ramulator model
+		channels_.clear();
+	}
+
+	void tick() override {
+		++cycles_;
+		while (!pending_rsps_.empty()) {
+			auto& rsp = pending_rsps_.top();
+			if (rsp.cycle > cycles_)
+				break;
+			auto callback = rsp.callback;
+			auto arg = rsp.arg;
+			pending_rsps_.pop();
+			callback(arg);
+		}
+	}
+
+	bool send_request(bool is_write, uint64_t addr, int source_id, DramSim::ResponseCallback callback, void* arg) override {
+		auto it = channels_.find(source_id);
+		if (it == channels_.end()) {
+			it = channels_.emplace(source_id, channel_t(params_, cycles_)).first;
+		}
+		auto& channel = it->second;
+
+		// refill the token bucket
+		channel.tokens = std::min<double>(params_.burst,
+			channel.tokens + (cycles_ - channel.cycle) * params_.bandwidth / clock_ratio_);
+		channel.cycle = cycles_;
+		if (channel.tokens < 1.0)
+			return false;
+		channel.tokens -= 1.0;
+
+		// row buffer lookup
+		uint32_t latency = params_.latency;
+		if (params_.row_miss_latency != 0) {
+			uint64_t row_addr = addr / params_.row_size;
+			auto& open_row = channel.open_rows.at(row_addr % params_.num_banks);
+			uint64_t row = row_addr / params_.num_banks;
+			if (open_row != row) {
+				latency += params_.row_miss_latency;
+				open_row = row;
+			}
+		}
+
+		if (is_write) {
+			// writes are posted
+			callback(arg);
+		} else {
+			pending_rsps_.push({cycles_ + uint64_t(latency) * clock_ratio_, callback, arg});
+		}
+		return true;
+	}
+
+private:
+
+	struct channel_t {
+		double   tokens;
+		uint64_t cycle;
+		std::vector<uint64_t> open_rows;
+
+		channel_t(const Params& params, uint64_t cycles)
+			: tokens(params.burst)
+			, cycle(cycles)
+			, open_rows(params.num_banks, uint64_t(-1))
+		{}
+	};
+
+	struct pending_rsp_t {
+		uint64_t cycle;
+		DramSim::ResponseCallback callback;
+		void* arg;
+
+		bool operator>(const pending_rsp_t& other) const {
+			return cycle > other.cycle;
+		}
+	};
+
+	Params params_;
+	int    clock_ratio_;
+	std::unordered_map<int, channel_t> channels_;
+	std::priority_queue<pending_rsp_t, std::vector<pending_rsp_t>, std::greater<pending_rsp_t>> pending_rsps_;
+	uint64_t cycles_;
+};
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class DramSim::Impl {
+private:
+	std::unique_ptr<DramModel> model_;
+
+public:
+	Impl(int clock_ratio) {
+		// The DRAM model is selected at runtime using VORTEX_DRAM_CONFIG,
+		// which holds either a preset name or the path to a YAML file:
+		//   model: ramulator      # ramulator (default) or analytic
+		//   preset: DDR4          # base preset (default HBM2)
+		//   channels: 2           # channel count override
+		//   ranks: 1              # rank count override
+		//   trace: ./ramulator.log # enable the command trace recorder
+		//   MemorySystem: {...}   # raw Ramulator overrides
+		//   analytic: {...}       # analytic model parameters
+		// VORTEX_DRAM_MODEL and VORTEX_DRAM_TRACE override the model and trace path.
+		YAML::Node user_config;
+		std::string preset_name(default_dram_preset);
+		std::string model_name("ramulator");
+		auto config_s = getenv("VORTEX_DRAM_CONFIG");
+		if (config_s && *config_s) {
+			if (find_dram_preset(config_s)) {
+				preset_name = config_s;
+			} else {
+				try {
+					user_config = YAML::LoadFile(config_s);
+				} catch (const std::exception& e) {
+					std::cout << "Error: invalid DRAM config '" << config_s << "': " << e.what() << std::endl;
+					std::abort();
+				}
+				const YAML::Node& user = user_config;
+				if (user["preset"]) {
+					preset_name = user["preset"].as<std::string>();
+				}
+				if (user["model"]) {
+					model_name = user["model"].as<std::string>();
+				}
+			}
+		}
+
+		auto model_s = getenv("VORTEX_DRAM_MODEL");
+		if (model_s && *model_s) {
+			model_name = model_s;
+		}
+
+		const YAML::Node& user = user_config;
+		if (0 == strcasecmp(model_name.c_str(), "analytic")) {
+			model_.reset(new AnalyticModel(clock_ratio, user));
+		} else if (0 == strcasecmp(model_name.c_str(), "ramulator")) {
+			auto preset = find_dram_preset(preset_name);
+			if (nullptr == preset) {
+				std::cout << "Error: unknown DRAM preset '" << preset_name << "'" << std::endl;
+				std::abort();
+			}
+			model_.reset(new RamulatorModel(clock_ratio, preset, user));
+		} else {
+			std::cout << "Error: unknown DRAM model '" << model_name << "'" << std::endl;
+			std::abort();
+		}
+	}
+
+	~Impl() {
+		//--
+	}
+
+	void reset() {
+		model_->reset();
+	}
+
+	void tick() {
+		model_->tick();
+	}
+
+  bool send_request(bool is_write, uint64_t addr, int source_id, ResponseCallback callback, void* arg) {
+		return model_->send_request(is_write, addr, source_id, callback, arg);
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 DramSim::DramSim(int clock_ratio)
 	: impl_(new Impl(clock_ratio))
 {}
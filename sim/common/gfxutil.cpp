@@ -17,89 +17,51 @@
 #include <cstring>
 #include <math.h>
 #include <iostream>
-#include <map>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 using namespace cocogfx;
 using namespace graphics;
 
-using vec2f_t = TVector2<float>;
-using vec3f_t = TVector3<float>;
-using vec4f_t = TVector4<float>;
-using rectf_t = TRect<float>;
+// minimum number of primitives per binning thread
+#define BINNING_CHUNK_MIN_PRIMS 1024
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static bool EdgeEquation(vec3f_t edges[3],
-                         const vec4f_t& v0,
-                         const vec4f_t& v1,
-                         const vec4f_t& v2) {
-  // Calculate edge equation matrix
-  auto a0 = (v1.y * v2.w) - (v2.y * v1.w);
-  auto a1 = (v2.y * v0.w) - (v0.y * v2.w);
-  auto a2 = (v0.y * v1.w) - (v1.y * v0.w);
-
-  auto b0 = (v2.x * v1.w) - (v1.x * v2.w);
-  auto b1 = (v0.x * v2.w) - (v2.x * v0.w);
-  auto b2 = (v1.x * v0.w) - (v0.x * v1.w);
-
-  auto c0 = (v1.x * v2.y) - (v2.x * v1.y);
-  auto c1 = (v2.x * v0.y) - (v0.x * v2.y);
-  auto c2 = (v0.x * v1.y) - (v1.x * v0.y);
-
-  edges[0] = {a0, b0, c0};
-  edges[1] = {a1, b1, c1};
-  edges[2] = {a2, b2, c2};
-
-  /*printf("E0.x=%f, E0.y=%f, E0.z=%f, E1.x=%f, E1.y=%f, E1.z=%f, E2.x=%f, E2.y=%f, E2.z=%f\n",
-      edges[0].x, edges[0].y, edges[0].z,
-      edges[1].x, edges[1].y, edges[1].z,
-      edges[2].x, edges[2].y, edges[2].z);*/
-
-  auto det = c0 * v0.w + c1 * v1.w + c2 * v2.w;
-  if (det < 0) {
-    edges[0].x *= -1.0f;
-    edges[0].y *= -1.0f;
-    edges[0].z *= -1.0f;
-    edges[1].x *= -1.0f;
-    edges[1].y *= -1.0f;
-    edges[1].z *= -1.0f;
-    edges[2].x *= -1.0f;
-    edges[2].y *= -1.0f;
-    edges[2].z *= -1.0f;
-  }
-
-  return (det != 0);
+static rast_vertex_t ToRastVertex(const CGLTrace::vertex_t& v) {
+  return {v.pos.x, v.pos.y, v.pos.z, v.pos.w,
+          v.color.r, v.color.g, v.color.b, v.color.a,
+          v.texcoord.u, v.texcoord.v};
 }
 
-#ifdef FIXEDPOINT_RASTERIZER
-
-static void EdgeToFixed(vec3e_t out[3], vec3f_t in[3]) {
-  // Normalize the matrix
-  auto maxVal = std::max({std::abs(in[0].x), std::abs(in[1].x), std::abs(in[2].x),
-                          std::abs(in[0].y), std::abs(in[1].y), std::abs(in[2].y)});
-  auto scale = 1.0f / maxVal;
-  auto t0 = vec3f_t{in[0].x * scale, in[0].y * scale, in[0].z * scale};
-  auto t1 = vec3f_t{in[1].x * scale, in[1].y * scale, in[1].z * scale};
-  auto t2 = vec3f_t{in[2].x * scale, in[2].y * scale, in[2].z * scale};
-
-  // Convert the edge equation to fixedpoint
-  out[0] = {FloatE(t0.x), FloatE(t0.y), FloatE(t0.z)};
-  out[1] = {FloatE(t1.x), FloatE(t1.y), FloatE(t1.z)};
-  out[2] = {FloatE(t2.x), FloatE(t2.y), FloatE(t2.z)};
-
-  //printf("*** out0=(%d, %d, %d)\n", outs[0].x.data(), outs[0].y.data(), outs[0].z.data());
-  //printf("*** out1=(%d, %d, %d)\n", outs[1].x.data(), outs[1].y.data(), outs[1].z.data());
-  //printf("*** out2=(%d, %d, %d)\n", outs[2].x.data(), outs[2].y.data(), outs[2].z.data());
+// runs body(chunk) over num_chunks chunks, one thread each
+template <typename F>
+static void ParallelFor(uint32_t num_chunks, const F& body) {
+  if (num_chunks == 1) {
+    body(0);
+    return;
+  }
+  std::vector<std::thread> threads;
+  threads.reserve(num_chunks - 1);
+  for (uint32_t c = 1; c < num_chunks; ++c) {
+    threads.emplace_back(body, c);
+  }
+  body(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
 }
 
-#endif
-
 namespace graphics {
 
-// scan primitives and perform tile assignment
+// scan primitives and perform tile assignment.
+// The primitives are split into contiguous chunks binned in parallel: each
+// chunk sets up its primitives and counts them per tile, a prefix sum over the
+// tiles and chunks assigns every chunk its slots in the output buffers, and
+// each chunk then writes its primitives and tile ids in place. Tiles are laid
+// out in (x, y) order and keep their primitives in submission order.
 uint32_t Binning(std::vector<uint8_t>& tilebuf,
                  std::vector<uint8_t>& primbuf,
                  const std::unordered_map<uint32_t, CGLTrace::vertex_t>& vertices,
@@ -109,170 +71,164 @@ uint32_t Binning(std::vector<uint8_t>& tilebuf,
                  float near,
                  float far,
                  uint32_t tileLogSize) {
-  std::map<std::pair<uint16_t, uint16_t>, std::vector<uint32_t>> tiles;
-
-  std::vector<rast_prim_t> rast_prims;
-  rast_prims.reserve(primitives.size());
-
-  rast_bbox_t global_bbox{-1u, 0, -1u, 0};
-
-  uint32_t total_prims = 0;
-
-  #define POS_TO_V2D(d, s) \
-      d.x = s.x; \
-      d.y = s.y
-
-  #define POS_TO_V4D(d, s) \
-    d.x = s.x; \
-    d.y = s.y; \
-    d.z = s.z; \
-    d.w = s.w
-
-  for (auto& primitive : primitives) {
-    // get primitive vertices
-    auto& v0 = vertices.at(primitive.i0);
-    auto& v1 = vertices.at(primitive.i1);
-    auto& v2 = vertices.at(primitive.i2);
-
-    vec4f_t p0, p1, p2;
-    POS_TO_V4D (p0, v0.pos);
-    POS_TO_V4D (p1, v1.pos);
-    POS_TO_V4D (p2, v2.pos);
-
-    vec3f_t edges[3];
-    rast_bbox_t bbox;
-    vec4f_t ps0, ps1, ps2;
-
-    {
-      vec4f_t ph0, ph1, ph2;
-
-      // Convert position from clip to 2D homogenous device space
-      ClipToHDC(&ph0, p0, 0, width, 0, height, near, far);
-      ClipToHDC(&ph1, p1, 0, width, 0, height, near, far);
-      ClipToHDC(&ph2, p2, 0, width, 0, height, near, far);
-
-      // Calculate edge equation
-      if (!EdgeEquation(edges, ph0, ph1, ph2)) {
-        // reject degenerate triangles
-        printf("warning: degenerate primitive...\n");
+  uint32_t num_prims = primitives.size();
+
+  auto tileSize = 1 << tileLogSize;
+  uint32_t num_tiles_x = (width + tileSize - 1) >> tileLogSize;
+  uint32_t num_tiles_y = (height + tileSize - 1) >> tileLogSize;
+  uint32_t num_tiles = num_tiles_x * num_tiles_y;
+
+  // small draw calls are not worth the threads, and the per-chunk tile
+  // counters are bounded to 64 MB
+  uint32_t num_chunks = std::max(1u, std::thread::hardware_concurrency());
+  num_chunks = std::min(num_chunks, num_prims / BINNING_CHUNK_MIN_PRIMS);
+  num_chunks = std::min<uint64_t>(num_chunks, (16ull << 20) / std::max(1u, num_tiles));
+  num_chunks = std::max(num_chunks, 1u);
+
+  struct chunk_t {
+    std::vector<rast_prim_t> prims;
+    std::vector<rast_bbox_t> bboxes;
+    std::vector<uint32_t> degenerates;
+    std::vector<uint32_t> tile_counts;
+    uint32_t prims_offset;
+  };
+  std::vector<chunk_t> chunks(num_chunks);
+
+  // set up the primitives and count their tiles
+  ParallelFor(num_chunks, [&](uint32_t c) {
+    auto& chunk = chunks.at(c);
+    uint32_t begin = uint64_t(num_prims) * c / num_chunks;
+    uint32_t end = uint64_t(num_prims) * (c + 1) / num_chunks;
+    chunk.prims.reserve(end - begin);
+    chunk.bboxes.reserve(end - begin);
+    chunk.tile_counts.resize(num_tiles, 0);
+    for (uint32_t i = begin; i < end; ++i) {
+      auto& primitive = primitives.at(i);
+      auto v0 = ToRastVertex(vertices.at(primitive.i0));
+      auto v1 = ToRastVertex(vertices.at(primitive.i1));
+      auto v2 = ToRastVertex(vertices.at(primitive.i2));
+      rast_prim_t rast_prim;
+      rast_bbox_t bbox;
+      auto status = SetupPrimitive(&rast_prim, &bbox, v0, v1, v2, width, height, near, far);
+      if (status != PrimSetup::Accepted) {
+        if (status == PrimSetup::Degenerate) {
+          chunk.degenerates.push_back(i);
+        }
         continue;
       }
-    }
-
-    {
-      // Convert position from clip to screen space
-      ClipToScreen(&ps0, p0, 0, width, 0, height, near, far);
-      ClipToScreen(&ps1, p1, 0, width, 0, height, near, far);
-      ClipToScreen(&ps2, p2, 0, width, 0, height, near, far);
-
-      // Calculate bounding box
-      vec2f_t q0, q1, q2;
-      POS_TO_V2D (q0, ps0);
-      POS_TO_V2D (q1, ps1);
-      POS_TO_V2D (q2, ps2);
-
-      //printf("*** screen position: v0=(%f, %f), v1=(%f, %f), v2=(%f, %f)\n", q0.x, q0.y, q1.x, q1.y, q2.x, q2.y);
-
-      rectf_t tmp;
-      CalcBoundingBox(&tmp, q0, q1, q2);
-      auto tbb_left   = static_cast<int>(std::floor(tmp.left));
-      auto tbb_right  = static_cast<int>(std::ceil(tmp.right));
-      auto tbb_top    = static_cast<int>(std::floor(tmp.top));
-      auto tbb_bottom = static_cast<int>(std::ceil(tmp.bottom));
-
-      // clamp to scissor
-      bbox.left   = std::max<int32_t>(tbb_left,   0);
-      bbox.right  = std::min<int32_t>(tbb_right,  width);
-      bbox.top    = std::max<int32_t>(tbb_top,    0);
-      bbox.bottom = std::min<int32_t>(tbb_bottom, height);
-
-      // reject excluded primitives
-		  if (bbox.right <= bbox.left ||
-		      bbox.bottom <= bbox.top)
-			  continue;
-
-      //printf("*** bbpx=(%f, %f, %f, %f)\n", tmp.left, tmp.right, tmp.top, tmp.bottom);
-      global_bbox.left   = std::min(bbox.left, global_bbox.left);
-      global_bbox.right  = std::max(bbox.right, global_bbox.right);
-      global_bbox.top    = std::min(bbox.top, global_bbox.top);
-      global_bbox.bottom = std::max(bbox.bottom, global_bbox.bottom);
-    }
-
-    uint32_t p;
-
-    {
-      #define ATTRIBUTE_DELTA(d, x0, x1, x2) \
-        d.x = FloatA(x0 - x2); \
-        d.y = FloatA(x1 - x2); \
-        d.z = FloatA(x2)
-
-      rast_prim_t rast_prim;
-
-			// add half-pixel offset
-			edges[0].z += edges[0].x * 0.5f + edges[0].y * 0.5f;
-			edges[1].z += edges[1].x * 0.5f + edges[1].y * 0.5f;
-			edges[2].z += edges[2].x * 0.5f + edges[2].y * 0.5f;
-
-    #ifdef FIXEDPOINT_RASTERIZER
-      EdgeToFixed(rast_prim.edges, edges);
-    #else
-      rast_prim.edges[0] = edges[0];
-      rast_prim.edges[1] = edges[1];
-      rast_prim.edges[2] = edges[2];
-    #endif
-
-      ATTRIBUTE_DELTA (rast_prim.attribs.z, ps0.z, ps1.z, ps2.z);
-      ATTRIBUTE_DELTA (rast_prim.attribs.r, v0.color.r, v1.color.r, v2.color.r);
-      ATTRIBUTE_DELTA (rast_prim.attribs.g, v0.color.g, v1.color.g, v2.color.g);
-      ATTRIBUTE_DELTA (rast_prim.attribs.b, v0.color.b, v1.color.b, v2.color.b);
-      ATTRIBUTE_DELTA (rast_prim.attribs.a, v0.color.a, v1.color.a, v2.color.a);
-      ATTRIBUTE_DELTA (rast_prim.attribs.u, v0.texcoord.u, v1.texcoord.u, v2.texcoord.u);
-      ATTRIBUTE_DELTA (rast_prim.attribs.v, v0.texcoord.v, v1.texcoord.v, v2.texcoord.v);
-
-      p = rast_prims.size();
-      rast_prims.push_back(rast_prim);
-    }
-
-    // calculate tiles coverage
-    {
-      auto tileSize = 1 << tileLogSize;
       auto minTileX = bbox.left >> tileLogSize;
       auto maxTileX = (bbox.right + tileSize - 1) >> tileLogSize;
       auto minTileY = bbox.top >> tileLogSize;
       auto maxTileY = (bbox.bottom + tileSize - 1) >> tileLogSize;
+      for (uint32_t tx = minTileX; tx < maxTileX; ++tx) {
+        auto tile_counts = chunk.tile_counts.data() + tx * num_tiles_y;
+        for (uint32_t ty = minTileY; ty < maxTileY; ++ty) {
+          ++tile_counts[ty];
+        }
+      }
+      chunk.prims.push_back(rast_prim);
+      chunk.bboxes.push_back(bbox);
+    }
+  });
 
-      for (uint32_t ty = minTileY; ty < maxTileY; ++ty) {
-				for (uint32_t tx = minTileX; tx < maxTileX; ++tx) {
-					tiles[{tx, ty}].push_back(p);
-          ++total_prims;
-				}
-			}
+  // assign the primitive ids
+  uint32_t total_rast_prims = 0;
+  for (auto& chunk : chunks) {
+    for (size_t i = 0, n = chunk.degenerates.size(); i < n; ++i) {
+      printf("warning: degenerate primitive...\n");
     }
+    chunk.prims_offset = total_rast_prims;
+    total_rast_prims += chunk.prims.size();
   }
 
-  {
-    primbuf.resize(rast_prims.size() * sizeof(rast_prim_t));
-    memcpy(primbuf.data(), rast_prims.data(), primbuf.size());
+  // assign the tile slots, turning the tile counts into write offsets
+  uint32_t active_tiles = 0;
+  uint32_t total_prims = 0;
+  for (uint32_t t = 0; t < num_tiles; ++t) {
+    uint32_t count = 0;
+    for (auto& chunk : chunks) {
+      count += chunk.tile_counts[t];
+    }
+    active_tiles += (count != 0);
+    total_prims += count;
   }
 
+  auto headers_size = active_tiles * sizeof(rast_tile_header_t);
+  tilebuf.resize(headers_size + total_prims * sizeof(uint32_t));
+  primbuf.resize(total_rast_prims * sizeof(rast_prim_t));
+
   {
-    tilebuf.resize(tiles.size() * sizeof(rast_tile_header_t) + total_prims * sizeof(uint32_t));
     auto tile_header = reinterpret_cast<rast_tile_header_t*>(tilebuf.data());
-    auto pids_buffer = reinterpret_cast<uint8_t*>(tilebuf.data() + tiles.size() * sizeof(rast_tile_header_t));
-    for (auto& it : tiles) {
-      tile_header->tile_x = it.first.first;
-      tile_header->tile_y = it.first.second;
-      tile_header->pids_offset = (pids_buffer - reinterpret_cast<uint8_t*>(tile_header + 1)) / sizeof(uint32_t);
-      tile_header->pids_count = it.second.size();
+    auto pids_buffer = reinterpret_cast<uint8_t*>(tilebuf.data() + headers_size);
+    uint32_t pids_index = 0;
+    for (uint32_t t = 0; t < num_tiles; ++t) {
+      uint32_t count = 0;
+      for (auto& chunk : chunks) {
+        auto chunk_count = chunk.tile_counts[t];
+        chunk.tile_counts[t] = pids_index + count;
+        count += chunk_count;
+      }
+      if (count == 0)
+        continue;
+      tile_header->tile_x = t / num_tiles_y;
+      tile_header->tile_y = t % num_tiles_y;
+      tile_header->pids_offset = (pids_buffer + pids_index * sizeof(uint32_t) - reinterpret_cast<uint8_t*>(tile_header + 1)) / sizeof(uint32_t);
+      tile_header->pids_count = count;
       ++tile_header;
-      memcpy(pids_buffer, it.second.data(), it.second.size() * sizeof(uint32_t));
-      pids_buffer += it.second.size() * sizeof(uint32_t);
+      pids_index += count;
     }
   }
 
-  //printf("Binning bounding box={l=%d, r=%d, t=%d, b=%d}\n", global_bbox.left, global_bbox.right, global_bbox.top, global_bbox.bottom);
+  // write the primitives and their tile ids
+  ParallelFor(num_chunks, [&](uint32_t c) {
+    auto& chunk = chunks.at(c);
+    memcpy(primbuf.data() + chunk.prims_offset * sizeof(rast_prim_t), chunk.prims.data(), chunk.prims.size() * sizeof(rast_prim_t));
+    auto pids = reinterpret_cast<uint32_t*>(tilebuf.data() + headers_size);
+    for (uint32_t i = 0, n = chunk.bboxes.size(); i < n; ++i) {
+      auto& bbox = chunk.bboxes[i];
+      uint32_t p = chunk.prims_offset + i;
+      auto minTileX = bbox.left >> tileLogSize;
+      auto maxTileX = (bbox.right + tileSize - 1) >> tileLogSize;
+      auto minTileY = bbox.top >> tileLogSize;
+      auto maxTileY = (bbox.bottom + tileSize - 1) >> tileLogSize;
+      for (uint32_t tx = minTileX; tx < maxTileX; ++tx) {
+        auto tile_offsets = chunk.tile_counts.data() + tx * num_tiles_y;
+        for (uint32_t ty = minTileY; ty < maxTileY; ++ty) {
+          pids[tile_offsets[ty]++] = p;
+        }
+      }
+    }
+  });
+
+  return active_tiles;
+}
 
-  return tiles.size();
+// flatten the vertices and primitives into the buffers of the device binning,
+// numbering the vertices in the order the primitives use them
+void PackPrimitives(std::vector<rast_vertex_t>& vbuf,
+                    std::vector<uint32_t>& ibuf,
+                    const std::unordered_map<uint32_t, CGLTrace::vertex_t>& vertices,
+                    const std::vector<CGLTrace::primitive_t>& primitives) {
+  std::unordered_map<uint32_t, uint32_t> indices;
+  indices.reserve(vertices.size());
+  vbuf.clear();
+  vbuf.reserve(vertices.size());
+  ibuf.resize(primitives.size() * 3);
+
+  auto pack = [&](uint32_t id) {
+    auto result = indices.emplace(id, vbuf.size());
+    if (result.second) {
+      vbuf.push_back(ToRastVertex(vertices.at(id)));
+    }
+    return result.first->second;
+  };
+
+  for (size_t i = 0, n = primitives.size(); i < n; ++i) {
+    auto& primitive = primitives.at(i);
+    ibuf[i * 3 + 0] = pack(primitive.i0);
+    ibuf[i * 3 + 1] = pack(primitive.i1);
+    ibuf[i * 3 + 2] = pack(primitive.i2);
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -15,6 +15,7 @@
 
 #include <cocogfx/include/cgltrace.hpp>
 #include <cocogfx/include/format.hpp>
+#include "graphics.h"
 
 namespace graphics {
 
@@ -36,6 +37,11 @@ uint32_t Binning(std::vector<uint8_t>& tilebuf,
                  float far,
                  uint32_t tileLogSize);
 
+void PackPrimitives(std::vector<rast_vertex_t>& vbuf,
+                    std::vector<uint32_t>& ibuf,
+                    const std::unordered_map<uint32_t, cocogfx::CGLTrace::vertex_t>& vertices,
+                    const std::vector<cocogfx::CGLTrace::primitive_t>& primitives);
+
 std::string ResolveFilePath(const std::string& filename, const std::string& searchPaths);
 
 } // namespace graphics
\ No newline at end of file
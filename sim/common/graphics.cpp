@@ -14,6 +14,8 @@
 #include "graphics.h"
 #include "bitmanip.h"
 #include <assert.h>
+#include <algorithm>
+#include <cmath>
 #include <cocogfx/include/color.hpp>
 
 #ifdef LLVM_VORTEX
@@ -700,7 +702,13 @@ Rasterizer::Rasterizer(const ShaderCB& shader_cb,
   , tile_logsize_(tile_logsize)
   , block_logsize_(block_logsize) {
   assert(block_logsize >= 1);
+  assert(block_logsize <= RASTER_BLOCK_LOGSIZE_MAX);
   assert(tile_logsize >= block_logsize);
+  // lane l of a block row is pixel (l & 3) of its (l / 4)-th quad
+  for (uint32_t l = 0; l < RASTER_BLOCK_LANES; ++l) {
+    lane_x_[l] = (l >> 2) * 2 + (l & 1);
+    lane_y_[l] = (l >> 1) & 1;
+  }
 }
 
 Rasterizer::~Rasterizer() {} 
@@ -752,7 +760,11 @@ void Rasterizer::renderTile(uint32_t tileLogSize,
    || (edges.z + ShiftLeft(delta.extents.z, tileLogSize)) < fxZero)
     return;
   
+#ifdef FIXEDPOINT_RASTERIZER
+  if (tileLogSize > block_logsize_) {
+#else
   if (tileLogSize > 1) {
+#endif
     // printf("*** raster-tile: x=%d, y=%d\n", x, y);
     --tileLogSize;
     auto subTileSize = 1 << tileLogSize;    
@@ -792,6 +804,12 @@ void Rasterizer::renderTile(uint32_t tileLogSize,
       this->renderTile(tileLogSize, sx, sy, pid, sedges, delta);
     }
   } else {
+  #ifdef FIXEDPOINT_RASTERIZER
+    if (block_logsize_ > 1) {
+      this->renderBlock(x, y, pid, edges, delta);
+      return;
+    }
+  #endif
     this->renderQuad(x, y, pid, edges, delta);
   }
 }
@@ -840,4 +858,444 @@ void Rasterizer::renderQuad(uint32_t x,
     auto pos_mask = (quad_y << (4 + VX_RASTER_DIM_BITS-1)) | (quad_x << 4) | mask;
     shader_cb_(pos_mask, bcoords, pid, cb_arg_);
   }
-}  
\ No newline at end of file
+}  
+
+///////////////////////////////////////////////////////////////////////////////
+
+using vec2f_t = TVector2<float>;
+using vec3f_t = TVector3<float>;
+using vec4f_t = TVector4<float>;
+using rectf_t = TRect<float>;
+
+static bool EdgeEquation(vec3f_t edges[3],
+                         const vec4f_t& v0,
+                         const vec4f_t& v1,
+                         const vec4f_t& v2) {
+  // Calculate edge equation matrix
+  auto a0 = (v1.y * v2.w) - (v2.y * v1.w);
+  auto a1 = (v2.y * v0.w) - (v0.y * v2.w);
+  auto a2 = (v0.y * v1.w) - (v1.y * v0.w);
+
+  auto b0 = (v2.x * v1.w) - (v1.x * v2.w);
+  auto b1 = (v0.x * v2.w) - (v2.x * v0.w);
+  auto b2 = (v1.x * v0.w) - (v0.x * v1.w);
+
+  auto c0 = (v1.x * v2.y) - (v2.x * v1.y);
+  auto c1 = (v2.x * v0.y) - (v0.x * v2.y);
+  auto c2 = (v0.x * v1.y) - (v1.x * v0.y);
+
+  edges[0] = {a0, b0, c0};
+  edges[1] = {a1, b1, c1};
+  edges[2] = {a2, b2, c2};
+
+  /*printf("E0.x=%f, E0.y=%f, E0.z=%f, E1.x=%f, E1.y=%f, E1.z=%f, E2.x=%f, E2.y=%f, E2.z=%f\n",
+      edges[0].x, edges[0].y, edges[0].z,
+      edges[1].x, edges[1].y, edges[1].z,
+      edges[2].x, edges[2].y, edges[2].z);*/
+
+  auto det = c0 * v0.w + c1 * v1.w + c2 * v2.w;
+  if (det < 0) {
+    edges[0].x *= -1.0f;
+    edges[0].y *= -1.0f;
+    edges[0].z *= -1.0f;
+    edges[1].x *= -1.0f;
+    edges[1].y *= -1.0f;
+    edges[1].z *= -1.0f;
+    edges[2].x *= -1.0f;
+    edges[2].y *= -1.0f;
+    edges[2].z *= -1.0f;
+  }
+
+  return (det != 0);
+}
+
+#ifdef FIXEDPOINT_RASTERIZER
+
+// Evaluates a block one row of quads at a time, the same way the RTL block
+// evaluator does: every pixel of the row gets its edge values computed
+// directly from the block origin, and the quads are emitted in row-major
+// order. The lane loops use plain wrapping integer math, which the compiler
+// maps to SIMD instructions, and produce the same values as the fixed-point
+// increments of the recursive rasterizer.
+void Rasterizer::renderBlock(uint32_t x,
+                             uint32_t y,
+                             uint32_t pid,
+                             const vec3e_t& edges,
+                             const delta_t& delta) const {
+  uint32_t num_quads = 1 << (block_logsize_ - 1);
+  uint32_t num_lanes = num_quads * 4;
+
+  uint32_t e0 = edges.x.data(), dx0 = delta.dx.x.data(), dy0 = delta.dy.x.data();
+  uint32_t e1 = edges.y.data(), dx1 = delta.dx.y.data(), dy1 = delta.dy.y.data();
+  uint32_t e2 = edges.z.data(), dx2 = delta.dx.z.data(), dy2 = delta.dy.z.data();
+
+  uint32_t ee0[RASTER_BLOCK_LANES];
+  uint32_t ee1[RASTER_BLOCK_LANES];
+  uint32_t ee2[RASTER_BLOCK_LANES];
+  uint32_t coverage[RASTER_BLOCK_LANES];
+
+  // largest increment over a row of quads, for rejecting rows outside an edge
+  uint32_t block_w = num_quads * 2 - 1;
+  int32_t rx0 = std::max<int32_t>(dx0, 0) * block_w + std::max<int32_t>(dy0, 0);
+  int32_t rx1 = std::max<int32_t>(dx1, 0) * block_w + std::max<int32_t>(dy1, 0);
+  int32_t rx2 = std::max<int32_t>(dx2, 0) * block_w + std::max<int32_t>(dy2, 0);
+
+  for (uint32_t row = 0; row < num_quads; ++row) {
+    uint32_t row_y = row * 2;
+    if (int32_t(e0 + dy0 * row_y + rx0) < 0
+     || int32_t(e1 + dy1 * row_y + rx1) < 0
+     || int32_t(e2 + dy2 * row_y + rx2) < 0)
+      continue;
+    for (uint32_t l = 0; l < num_lanes; ++l) {
+      uint32_t px = lane_x_[l];
+      uint32_t py = row_y + lane_y_[l];
+      ee0[l] = e0 + dx0 * px + dy0 * py;
+      ee1[l] = e1 + dx1 * px + dy1 * py;
+      ee2[l] = e2 + dx2 * px + dy2 * py;
+      uint32_t sx = x + px;
+      uint32_t sy = y + py;
+      coverage[l] = (((ee0[l] | ee1[l] | ee2[l]) >> 31) ^ 1)
+                  & (sx >= scissor_left_) & (sx < scissor_right_)
+                  & (sy >= scissor_top_)  & (sy < scissor_bottom_);
+    }
+
+    for (uint32_t q = 0; q < num_quads; ++q) {
+      auto lane = q * 4;
+      uint32_t mask = coverage[lane + 0]
+                    | (coverage[lane + 1] << 1)
+                    | (coverage[lane + 2] << 2)
+                    | (coverage[lane + 3] << 3);
+      if (0 == mask)
+        continue;
+      vec3e_t bcoords[4];
+      for (uint32_t p = 0; p < 4; ++p) {
+        bcoords[p].x = FloatE::make(ee0[lane + p]);
+        bcoords[p].y = FloatE::make(ee1[lane + p]);
+        bcoords[p].z = FloatE::make(ee2[lane + p]);
+      }
+      auto quad_x = (x + q * 2) / 2;
+      auto quad_y = (y + row_y) / 2;
+      auto pos_mask = (quad_y << (4 + VX_RASTER_DIM_BITS-1)) | (quad_x << 4) | mask;
+      shader_cb_(pos_mask, bcoords, pid, cb_arg_);
+    }
+  }
+}
+
+#endif
+
+#ifdef FIXEDPOINT_RASTERIZER
+
+static void EdgeToFixed(vec3e_t out[3], vec3f_t in[3]) {
+  // Normalize the matrix
+  auto maxVal = std::max({std::abs(in[0].x), std::abs(in[1].x), std::abs(in[2].x),
+                          std::abs(in[0].y), std::abs(in[1].y), std::abs(in[2].y)});
+  auto scale = 1.0f / maxVal;
+  auto t0 = vec3f_t{in[0].x * scale, in[0].y * scale, in[0].z * scale};
+  auto t1 = vec3f_t{in[1].x * scale, in[1].y * scale, in[1].z * scale};
+  auto t2 = vec3f_t{in[2].x * scale, in[2].y * scale, in[2].z * scale};
+
+  // Convert the edge equation to fixedpoint
+  out[0] = {FloatE(t0.x), FloatE(t0.y), FloatE(t0.z)};
+  out[1] = {FloatE(t1.x), FloatE(t1.y), FloatE(t1.z)};
+  out[2] = {FloatE(t2.x), FloatE(t2.y), FloatE(t2.z)};
+
+  //printf("*** out0=(%d, %d, %d)\n", outs[0].x.data(), outs[0].y.data(), outs[0].z.data());
+  //printf("*** out1=(%d, %d, %d)\n", outs[1].x.data(), outs[1].y.data(), outs[1].z.data());
+  //printf("*** out2=(%d, %d, %d)\n", outs[2].x.data(), outs[2].y.data(), outs[2].z.data());
+}
+
+#endif
+
+PrimSetup graphics::SetupPrimitive(rast_prim_t* rast_prim,
+                                   rast_bbox_t* bbox,
+                                   const rast_vertex_t& v0,
+                                   const rast_vertex_t& v1,
+                                   const rast_vertex_t& v2,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   float near,
+                                   float far) {
+  #define POS_TO_V2D(d, s) \
+      d.x = s.x; \
+      d.y = s.y
+
+  #define POS_TO_V4D(d, s) \
+    d.x = s.x; \
+    d.y = s.y; \
+    d.z = s.z; \
+    d.w = s.w
+
+  vec4f_t p0, p1, p2;
+  POS_TO_V4D (p0, v0);
+  POS_TO_V4D (p1, v1);
+  POS_TO_V4D (p2, v2);
+
+  vec3f_t edges[3];
+  vec4f_t ps0, ps1, ps2;
+
+  {
+    vec4f_t ph0, ph1, ph2;
+
+    // Convert position from clip to 2D homogenous device space
+    ClipToHDC(&ph0, p0, 0, width, 0, height, near, far);
+    ClipToHDC(&ph1, p1, 0, width, 0, height, near, far);
+    ClipToHDC(&ph2, p2, 0, width, 0, height, near, far);
+
+    // Calculate edge equation
+    if (!EdgeEquation(edges, ph0, ph1, ph2)) {
+      // reject degenerate triangles
+      return PrimSetup::Degenerate;
+    }
+  }
+
+  {
+    // Convert position from clip to screen space
+    ClipToScreen(&ps0, p0, 0, width, 0, height, near, far);
+    ClipToScreen(&ps1, p1, 0, width, 0, height, near, far);
+    ClipToScreen(&ps2, p2, 0, width, 0, height, near, far);
+
+    // Calculate bounding box
+    vec2f_t q0, q1, q2;
+    POS_TO_V2D (q0, ps0);
+    POS_TO_V2D (q1, ps1);
+    POS_TO_V2D (q2, ps2);
+
+    //printf("*** screen position: v0=(%f, %f), v1=(%f, %f), v2=(%f, %f)\n", q0.x, q0.y, q1.x, q1.y, q2.x, q2.y);
+
+    rectf_t tmp;
+    CalcBoundingBox(&tmp, q0, q1, q2);
+    auto tbb_left   = static_cast<int>(std::floor(tmp.left));
+    auto tbb_right  = static_cast<int>(std::ceil(tmp.right));
+    auto tbb_top    = static_cast<int>(std::floor(tmp.top));
+    auto tbb_bottom = static_cast<int>(std::ceil(tmp.bottom));
+
+    // clamp to scissor
+    auto bb_left   = std::max<int32_t>(tbb_left,   0);
+    auto bb_right  = std::min<int32_t>(tbb_right,  width);
+    auto bb_top    = std::max<int32_t>(tbb_top,    0);
+    auto bb_bottom = std::min<int32_t>(tbb_bottom, height);
+
+    // reject excluded primitives
+    if (bb_right <= bb_left ||
+        bb_bottom <= bb_top)
+      return PrimSetup::Excluded;
+
+    bbox->left   = bb_left;
+    bbox->right  = bb_right;
+    bbox->top    = bb_top;
+    bbox->bottom = bb_bottom;
+
+    //printf("*** bbpx=(%f, %f, %f, %f)\n", tmp.left, tmp.right, tmp.top, tmp.bottom);
+  }
+
+  {
+    #define ATTRIBUTE_DELTA(d, x0, x1, x2) \
+      d.x = FloatA(x0 - x2); \
+      d.y = FloatA(x1 - x2); \
+      d.z = FloatA(x2)
+
+    // add half-pixel offset
+    edges[0].z += edges[0].x * 0.5f + edges[0].y * 0.5f;
+    edges[1].z += edges[1].x * 0.5f + edges[1].y * 0.5f;
+    edges[2].z += edges[2].x * 0.5f + edges[2].y * 0.5f;
+
+  #ifdef FIXEDPOINT_RASTERIZER
+    EdgeToFixed(rast_prim->edges, edges);
+  #else
+    rast_prim->edges[0] = edges[0];
+    rast_prim->edges[1] = edges[1];
+    rast_prim->edges[2] = edges[2];
+  #endif
+
+    ATTRIBUTE_DELTA (rast_prim->attribs.z, ps0.z, ps1.z, ps2.z);
+    ATTRIBUTE_DELTA (rast_prim->attribs.r, v0.r, v1.r, v2.r);
+    ATTRIBUTE_DELTA (rast_prim->attribs.g, v0.g, v1.g, v2.g);
+    ATTRIBUTE_DELTA (rast_prim->attribs.b, v0.b, v1.b, v2.b);
+    ATTRIBUTE_DELTA (rast_prim->attribs.a, v0.a, v1.a, v2.a);
+    ATTRIBUTE_DELTA (rast_prim->attribs.u, v0.u, v1.u, v2.u);
+    ATTRIBUTE_DELTA (rast_prim->attribs.v, v0.v, v1.v, v2.v);
+  }
+
+  return PrimSetup::Accepted;
+}
+
+namespace {
+
+struct bin_scratch_t {
+  rast_prim_t* prims;
+  rast_bbox_t* bboxes;
+  uint32_t*    prim_counts;
+  uint32_t*    tile_counts;
+};
+
+struct bin_grid_t {
+  uint32_t tile_size;
+  uint32_t num_tiles_y;
+  uint32_t num_tiles;
+};
+
+inline bin_grid_t BinGrid(const rast_bin_args_t& args) {
+  bin_grid_t grid;
+  grid.tile_size = 1 << args.tile_logsize;
+  uint32_t num_tiles_x = (args.width + grid.tile_size - 1) >> args.tile_logsize;
+  grid.num_tiles_y = (args.height + grid.tile_size - 1) >> args.tile_logsize;
+  grid.num_tiles = num_tiles_x * grid.num_tiles_y;
+  return grid;
+}
+
+// the scratch buffer holds the set up primitives and their bounding boxes,
+// followed by the per-task primitive counts and per-task tile counts
+inline bin_scratch_t BinScratch(const rast_bin_args_t& args) {
+  auto base = reinterpret_cast<uint8_t*>(args.scratch_addr);
+  bin_scratch_t scratch;
+  scratch.prims = reinterpret_cast<rast_prim_t*>(base);
+  base += args.num_prims * sizeof(rast_prim_t);
+  scratch.bboxes = reinterpret_cast<rast_bbox_t*>(base);
+  base += args.num_prims * sizeof(rast_bbox_t);
+  scratch.prim_counts = reinterpret_cast<uint32_t*>(base);
+  base += args.num_tasks * sizeof(uint32_t);
+  scratch.tile_counts = reinterpret_cast<uint32_t*>(base);
+  return scratch;
+}
+
+}
+
+uint64_t graphics::BinningScratchSize(uint32_t num_prims, uint32_t num_tiles, uint32_t num_tasks) {
+  return uint64_t(num_prims) * (sizeof(rast_prim_t) + sizeof(rast_bbox_t))
+       + uint64_t(num_tasks) * (1 + num_tiles) * sizeof(uint32_t);
+}
+
+void graphics::BinningSetup(const rast_bin_args_t& args, uint32_t task_id) {
+  auto grid = BinGrid(args);
+  auto scratch = BinScratch(args);
+  auto vertices = reinterpret_cast<const rast_vertex_t*>(args.vbuf_addr);
+  auto indices = reinterpret_cast<const uint32_t*>(args.ibuf_addr);
+
+  auto tile_counts = scratch.tile_counts + task_id * grid.num_tiles;
+  for (uint32_t t = 0; t < grid.num_tiles; ++t) {
+    tile_counts[t] = 0;
+  }
+
+  uint32_t begin = uint64_t(args.num_prims) * task_id / args.num_tasks;
+  uint32_t end = uint64_t(args.num_prims) * (task_id + 1) / args.num_tasks;
+  uint32_t num_prims = 0;
+  for (uint32_t i = begin; i < end; ++i) {
+    auto& v0 = vertices[indices[i * 3 + 0]];
+    auto& v1 = vertices[indices[i * 3 + 1]];
+    auto& v2 = vertices[indices[i * 3 + 2]];
+    auto& bbox = scratch.bboxes[i];
+    auto status = SetupPrimitive(&scratch.prims[i], &bbox, v0, v1, v2, args.width, args.height, args.near, args.far);
+    if (status != PrimSetup::Accepted) {
+      // an empty box covers no tiles
+      bbox = {0, 0, 0, 0};
+      continue;
+    }
+    auto minTileX = bbox.left >> args.tile_logsize;
+    auto maxTileX = (bbox.right + grid.tile_size - 1) >> args.tile_logsize;
+    auto minTileY = bbox.top >> args.tile_logsize;
+    auto maxTileY = (bbox.bottom + grid.tile_size - 1) >> args.tile_logsize;
+    for (uint32_t tx = minTileX; tx < maxTileX; ++tx) {
+      auto counts = tile_counts + tx * grid.num_tiles_y;
+      for (uint32_t ty = minTileY; ty < maxTileY; ++ty) {
+        ++counts[ty];
+      }
+    }
+    ++num_prims;
+  }
+  scratch.prim_counts[task_id] = num_prims;
+}
+
+void graphics::BinningPrefix(const rast_bin_args_t& args) {
+  auto grid = BinGrid(args);
+  auto scratch = BinScratch(args);
+  auto status = reinterpret_cast<rast_bin_status_t*>(args.status_addr);
+
+  // size the tile buffer
+  uint32_t active_tiles = 0;
+  uint32_t total_pids = 0;
+  for (uint32_t t = 0; t < grid.num_tiles; ++t) {
+    uint32_t count = 0;
+    for (uint32_t c = 0; c < args.num_tasks; ++c) {
+      count += scratch.tile_counts[c * grid.num_tiles + t];
+    }
+    active_tiles += (count != 0);
+    total_pids += count;
+  }
+  uint32_t headers_size = active_tiles * sizeof(rast_tile_header_t);
+  uint32_t tbuf_size = headers_size + total_pids * sizeof(uint32_t);
+
+  status->num_tiles = active_tiles;
+  status->tbuf_size = tbuf_size;
+  status->overflow  = (tbuf_size > args.tbuf_size);
+  if (status->overflow) {
+    // keep the counts for the rerun with a larger buffer
+    status->num_prims = 0;
+    return;
+  }
+
+  // assign the primitive ids
+  uint32_t num_prims = 0;
+  for (uint32_t c = 0; c < args.num_tasks; ++c) {
+    auto count = scratch.prim_counts[c];
+    scratch.prim_counts[c] = num_prims;
+    num_prims += count;
+  }
+  status->num_prims = num_prims;
+
+  // assign the tile slots, turning the tile counts into write offsets
+  auto tile_headers = reinterpret_cast<rast_tile_header_t*>(args.tbuf_addr);
+  uint32_t tile_index = 0;
+  uint32_t pids_index = 0;
+  for (uint32_t t = 0; t < grid.num_tiles; ++t) {
+    uint32_t count = 0;
+    for (uint32_t c = 0; c < args.num_tasks; ++c) {
+      auto& tile_count = scratch.tile_counts[c * grid.num_tiles + t];
+      auto chunk_count = tile_count;
+      tile_count = pids_index + count;
+      count += chunk_count;
+    }
+    if (count == 0)
+      continue;
+    // the pids offset is relative to the end of the header
+    auto& tile_header = tile_headers[tile_index];
+    tile_header.tile_x = t / grid.num_tiles_y;
+    tile_header.tile_y = t % grid.num_tiles_y;
+    tile_header.pids_offset = (headers_size + pids_index * sizeof(uint32_t) - (tile_index + 1) * sizeof(rast_tile_header_t)) / sizeof(uint32_t);
+    tile_header.pids_count = count;
+    ++tile_index;
+    pids_index += count;
+  }
+}
+
+void graphics::BinningScatter(const rast_bin_args_t& args, uint32_t task_id) {
+  auto status = reinterpret_cast<const rast_bin_status_t*>(args.status_addr);
+  if (status->overflow)
+    return;
+
+  auto grid = BinGrid(args);
+  auto scratch = BinScratch(args);
+  auto prims = reinterpret_cast<rast_prim_t*>(args.pbuf_addr);
+  auto pids = reinterpret_cast<uint32_t*>(args.tbuf_addr + status->num_tiles * sizeof(rast_tile_header_t));
+  auto tile_offsets = scratch.tile_counts + task_id * grid.num_tiles;
+
+  uint32_t begin = uint64_t(args.num_prims) * task_id / args.num_tasks;
+  uint32_t end = uint64_t(args.num_prims) * (task_id + 1) / args.num_tasks;
+  uint32_t p = scratch.prim_counts[task_id];
+  for (uint32_t i = begin; i < end; ++i) {
+    auto& bbox = scratch.bboxes[i];
+    if (bbox.right == 0)
+      continue; // rejected
+    prims[p] = scratch.prims[i];
+    auto minTileX = bbox.left >> args.tile_logsize;
+    auto maxTileX = (bbox.right + grid.tile_size - 1) >> args.tile_logsize;
+    auto minTileY = bbox.top >> args.tile_logsize;
+    auto maxTileY = (bbox.bottom + grid.tile_size - 1) >> args.tile_logsize;
+    for (uint32_t tx = minTileX; tx < maxTileX; ++tx) {
+      auto offsets = tile_offsets + tx * grid.num_tiles_y;
+      for (uint32_t ty = minTileY; ty < maxTileY; ++ty) {
+        pids[offsets[ty]++] = p;
+      }
+    }
+    ++p;
+  }
+}
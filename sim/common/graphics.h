@@ -70,6 +70,36 @@ typedef struct {
   uint16_t pids_count;
 } rast_tile_header_t;
 
+typedef struct {
+  float x, y, z, w;
+  float r, g, b, a;
+  float u, v;
+} rast_vertex_t;
+
+typedef struct {
+  uint64_t vbuf_addr;     // rast_vertex_t array
+  uint64_t ibuf_addr;     // three vertex indices per primitive
+  uint64_t tbuf_addr;     // tile buffer
+  uint64_t pbuf_addr;     // primitive buffer
+  uint64_t scratch_addr;  // BinningScratchSize() bytes
+  uint64_t status_addr;   // rast_bin_status_t
+  uint32_t tbuf_size;     // tile buffer capacity
+  uint32_t num_prims;
+  uint32_t num_tasks;
+  uint32_t width;
+  uint32_t height;
+  uint32_t tile_logsize;
+  float    near;
+  float    far;
+} rast_bin_args_t;
+
+typedef struct {
+  uint32_t num_tiles;     // active tiles
+  uint32_t num_prims;     // primitives written to the primitive buffer
+  uint32_t tbuf_size;     // tile buffer bytes needed
+  uint32_t overflow;      // the tile buffer was too small
+} rast_bin_status_t;
+
 inline void Unpack8888(uint32_t texel, uint32_t* lo, uint32_t* hi) {
   *lo = texel & 0x00ff00ff;
   *hi = (texel >> 8) & 0x00ff00ff;
@@ -279,6 +309,11 @@ protected:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// pixels evaluated together by the block rasterizer: one row of quads of the
+// largest supported block (32x32)
+#define RASTER_BLOCK_LOGSIZE_MAX 5
+#define RASTER_BLOCK_LANES       (4 << (RASTER_BLOCK_LOGSIZE_MAX - 1))
+
 class Rasterizer {
 public:
   typedef void (*ShaderCB)(
@@ -322,6 +357,12 @@ protected:
                   const vec3e_t& edges, 
                   const delta_t& delta) const; 
 
+  void renderBlock(uint32_t x,
+                   uint32_t y,
+                   uint32_t id,
+                   const vec3e_t& edges,
+                   const delta_t& delta) const;
+
   ShaderCB shader_cb_;
   void*    cb_arg_;
   uint32_t tile_logsize_;
@@ -330,6 +371,45 @@ protected:
   uint32_t scissor_top_; 
   uint32_t scissor_right_; 
   uint32_t scissor_bottom_;
+  uint32_t lane_x_[RASTER_BLOCK_LANES];
+  uint32_t lane_y_[RASTER_BLOCK_LANES];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class PrimSetup {
+  Accepted,
+  Degenerate,
+  Excluded,
 };
 
+// compute a primitive's edge equations, attributes and screen bounding box
+PrimSetup SetupPrimitive(rast_prim_t* rast_prim,
+                         rast_bbox_t* bbox,
+                         const rast_vertex_t& v0,
+                         const rast_vertex_t& v1,
+                         const rast_vertex_t& v2,
+                         uint32_t width,
+                         uint32_t height,
+                         float near,
+                         float far);
+
+// Device tile binning.
+// Produces the same tile and primitive buffers as the host Binning() in three
+// kernel launches. The setup pass splits the primitives into one contiguous
+// chunk per task, sets them up and counts each chunk's primitives per tile.
+// The prefix pass runs on a single task: it turns the counts into offsets,
+// writes the tile headers and the status. The scatter pass writes each chunk's
+// primitives and tile ids in place. When the tile buffer is too small, the
+// prefix pass only reports the needed size, and the host can grow the buffer
+// and rerun the prefix and scatter passes.
+
+uint64_t BinningScratchSize(uint32_t num_prims, uint32_t num_tiles, uint32_t num_tasks);
+
+void BinningSetup(const rast_bin_args_t& args, uint32_t task_id);
+
+void BinningPrefix(const rast_bin_args_t& args);
+
+void BinningScatter(const rast_bin_args_t& args, uint32_t task_id);
+
 } // namespace graphics
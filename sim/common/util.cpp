@@ -13,6 +13,8 @@
 
 #include "util.h"
 #include <string.h>
+#include <string>
+#include <sstream>
 
 // return file extension
 const char* fileExtension(const char* filepath) {
@@ -22,6 +24,23 @@ const char* fileExtension(const char* filepath) {
     return ext + 1;
 }
 
+std::unordered_set<uint32_t> parseIdList(const char* str) {
+  std::unordered_set<uint32_t> ids;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty())
+      continue;
+    auto dash = item.find('-');
+    uint32_t first = std::stoul(item.substr(0, dash));
+    uint32_t last = (dash == std::string::npos) ? first : std::stoul(item.substr(dash + 1));
+    for (uint32_t i = first; i <= last; ++i) {
+      ids.insert(i);
+    }
+  }
+  return ids;
+}
+
 void* aligned_malloc(size_t size, size_t alignment) {
   // reserve margin for alignment and storing of unaligned address
   assert((alignment & (alignment - 1)) == 0);   // Power of 2 alignment.
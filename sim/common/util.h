@@ -15,6 +15,7 @@
 
 #include <cstdint>
 #include <algorithm>
+#include <unordered_set>
 #include <assert.h>
 #include <bitmanip.h>
 
@@ -26,6 +27,9 @@ void unused(Args&&...) {}
 // return file extension
 const char* fileExtension(const char* filepath);
 
+// parse an id list such as "0,2-3"
+std::unordered_set<uint32_t> parseIdList(const char* str);
+
 #if defined(_MSC_VER)
 #define DISABLE_WARNING_PUSH __pragma(warning(push))
 #define DISABLE_WARNING_POP __pragma(warning(pop))
@@ -0,0 +1,170 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "arch.h"
+#include <iostream>
+#include <yaml-cpp/yaml.h>
+
+using namespace vortex;
+
+namespace {
+
+// read an optional integer parameter, enforcing its range and power-of-two constraint
+template <typename T>
+void read_param(const std::string& filename,
+                const YAML::Node& node,
+                const char* section,
+                const char* key,
+                T* value,
+                uint64_t min_value,
+                uint64_t max_value,
+                bool pow2 = false) {
+  auto param = node[key];
+  if (!param)
+    return;
+  uint64_t v;
+  try {
+    v = param.as<uint64_t>();
+  } catch (const std::exception&) {
+    v = 0;
+    min_value = 1;
+  }
+  if (v < min_value || v > max_value || (pow2 && !ispow2(v))) {
+    std::cout << "Error: invalid SimX config '" << filename << "': ";
+    if (section) std::cout << section << ".";
+    std::cout << key << "=" << param << std::endl;
+    std::abort();
+  }
+  *value = T(v);
+}
+
+void read_cache(const std::string& filename,
+                const YAML::Node& root,
+                const char* section,
+                uint32_t line_size,
+                Arch::CacheConfig* cache) {
+  auto node = root[section];
+  if (!node)
+    return;
+  if (node["enabled"]) {
+    cache->enabled = node["enabled"].as<bool>();
+  }
+  read_param(filename, node, section, "size", &cache->size, 64, 1u << 30, true);
+  read_param(filename, node, section, "ways", &cache->num_ways, 1, 64, true);
+  read_param(filename, node, section, "banks", &cache->num_banks, 1, 64, true);
+  read_param(filename, node, section, "mshr", &cache->mshr_size, 1, 255);
+  if (cache->size < line_size * cache->num_ways * cache->num_banks) {
+    std::cout << "Error: invalid SimX config '" << filename << "': " << section
+              << ".size=" << cache->size << " is smaller than ways * banks * line size" << std::endl;
+    std::abort();
+  }
+}
+
+}
+
+void Arch::load_config(const std::string& filename) {
+  // Configuration file layout (all keys optional, JSON uses the same structure):
+  //   threads: 4
+  //   warps: 4
+  //   cores: 1               # cores per cluster
+  //   clusters: 1
+  //   socket_size: 1
+  //   barriers: 4
+  //   ibuf_size: 4
+  //   lmem: {banks: 4}
+  //   gpr: {banks: 4, read_ports: 1, write_ports: 1, collectors: 1}
+  //   salu: false            # scalar ALU for warp-uniform operations
+  //   compaction: {window: 0}  # warp compaction study window in cycles (0: disabled)
+  //   hiz: false             # hierarchical-Z culling in the raster units
+  //   om: {tile_buffers: 0}  # on-chip screen tiles per output merger (0: immediate mode)
+  //   latency: {imul: 3, fma: 4, fdiv: 16, fsqrt: 16, fcvt: 5}
+  //   icache: {enabled: true, size: 16384, ways: 1, banks: 2, mshr: 4}
+  //   dcache: {...}
+  //   l2cache: {...}
+  //   l3cache: {...}
+  //   memory: {banks: 2}
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(filename);
+  } catch (const std::exception& e) {
+    std::cout << "Error: invalid SimX config '" << filename << "': " << e.what() << std::endl;
+    std::abort();
+  }
+  if (!root.IsMap()) {
+    std::cout << "Error: invalid SimX config '" << filename << "': expected a map" << std::endl;
+    std::abort();
+  }
+
+  read_param(filename, root, nullptr, "threads", &num_threads_, 1, MAX_NUM_THREADS, true);
+  read_param(filename, root, nullptr, "warps", &num_warps_, 1, MAX_NUM_WARPS, true);
+  read_param(filename, root, nullptr, "cores", &num_cores_, 1, MAX_NUM_CORES);
+  read_param(filename, root, nullptr, "clusters", &num_clusters_, 1, 255);
+  read_param(filename, root, nullptr, "socket_size", &socket_size_, 1, MAX_NUM_CORES);
+  read_param(filename, root, nullptr, "barriers", &num_barriers_, 1, 1024);
+  read_param(filename, root, nullptr, "ibuf_size", &ibuf_size_, 1, 1024);
+
+  if (auto lmem = root["lmem"]) {
+    read_param(filename, lmem, "lmem", "banks", &lmem_num_banks_, 1, 64, true);
+  }
+
+  if (auto gpr = root["gpr"]) {
+    read_param(filename, gpr, "gpr", "banks", &gpr_num_banks_, 1, 64, true);
+    read_param(filename, gpr, "gpr", "read_ports", &gpr_read_ports_, 1, 8);
+    read_param(filename, gpr, "gpr", "write_ports", &gpr_write_ports_, 0, 8);
+    read_param(filename, gpr, "gpr", "collectors", &num_opcs_, 1, 16);
+  }
+
+  if (root["salu"]) {
+    salu_enabled_ = root["salu"].as<bool>();
+  }
+
+  if (auto compaction = root["compaction"]) {
+    read_param(filename, compaction, "compaction", "window", &compact_window_, 0, 4096);
+  }
+
+  if (root["hiz"]) {
+    hiz_enabled_ = root["hiz"].as<bool>();
+  }
+
+  if (auto om = root["om"]) {
+    read_param(filename, om, "om", "tile_buffers", &om_tile_buffers_, 0, 64);
+  }
+
+  if (auto latency = root["latency"]) {
+    read_param(filename, latency, "latency", "imul", &latency_imul_, 1, 1024);
+    read_param(filename, latency, "latency", "fma", &latency_fma_, 1, 1024);
+    read_param(filename, latency, "latency", "fdiv", &latency_fdiv_, 1, 1024);
+    read_param(filename, latency, "latency", "fsqrt", &latency_fsqrt_, 1, 1024);
+    read_param(filename, latency, "latency", "fcvt", &latency_fcvt_, 1, 1024);
+  }
+
+  // the instruction cache tracks one miss per warp by default
+  icache_.mshr_size = num_warps_;
+  read_cache(filename, root, "icache", L1_LINE_SIZE, &icache_);
+  read_cache(filename, root, "dcache", L1_LINE_SIZE, &dcache_);
+  read_cache(filename, root, "l2cache", MEM_BLOCK_SIZE, &l2cache_);
+  read_cache(filename, root, "l3cache", MEM_BLOCK_SIZE, &l3cache_);
+
+  if (auto memory = root["memory"]) {
+    read_param(filename, memory, "memory", "banks", &memory_banks_, 1, 64, true);
+  }
+
+  if (num_warps_ < ISSUE_WIDTH) {
+    std::cout << "Error: invalid SimX config '" << filename << "': warps=" << num_warps_ << " is less than the issue width" << std::endl;
+    std::abort();
+  }
+
+  if (socket_size_ > num_cores_) {
+    socket_size_ = num_cores_;
+  }
+}
@@ -19,10 +19,20 @@
 #include <cstdlib>
 #include <stdio.h>
 #include "types.h"
+#include "constants.h"
 
 namespace vortex {
 
 class Arch {
+public:
+  struct CacheConfig {
+    bool     enabled;
+    uint32_t size;      // capacity in bytes
+    uint16_t num_ways;
+    uint16_t num_banks;
+    uint16_t mshr_size;
+  };
+
 private:
   uint16_t num_threads_;
   uint16_t num_warps_;
@@ -31,6 +41,26 @@ private:
   uint16_t socket_size_;
   uint16_t num_barriers_;
   uint64_t local_mem_base_;
+  uint16_t ibuf_size_;
+  uint16_t lmem_num_banks_;
+  uint16_t gpr_num_banks_;
+  uint16_t gpr_read_ports_;
+  uint16_t gpr_write_ports_;
+  uint16_t num_opcs_;
+  bool     salu_enabled_;
+  uint16_t compact_window_;
+  bool     hiz_enabled_;
+  uint16_t om_tile_buffers_;
+  uint16_t latency_imul_;
+  uint16_t latency_fma_;
+  uint16_t latency_fdiv_;
+  uint16_t latency_fsqrt_;
+  uint16_t latency_fcvt_;
+  CacheConfig icache_;
+  CacheConfig dcache_;
+  CacheConfig l2cache_;
+  CacheConfig l3cache_;
+  uint16_t memory_banks_;
 
 public:
   Arch(uint16_t num_threads, uint16_t num_warps, uint16_t num_cores)
@@ -41,7 +71,36 @@ public:
     , socket_size_(SOCKET_SIZE)
     , num_barriers_(NUM_BARRIERS)
     , local_mem_base_(LMEM_BASE_ADDR)
-  {}
+    , ibuf_size_(IBUF_SIZE)
+    , lmem_num_banks_(LMEM_NUM_BANKS)
+    , gpr_num_banks_(GPR_NUM_BANKS)
+    , gpr_read_ports_(GPR_READ_PORTS)
+    , gpr_write_ports_(GPR_WRITE_PORTS)
+    , num_opcs_(NUM_OPCS)
+    , salu_enabled_(SALU_ENABLED)
+    , compact_window_(WARP_COMPACT_WINDOW)
+    , hiz_enabled_(HIZ_ENABLED)
+    , om_tile_buffers_(OM_TILE_BUFFERS)
+    , latency_imul_(LATENCY_IMUL)
+    , latency_fma_(LATENCY_FMA)
+    , latency_fdiv_(LATENCY_FDIV)
+    , latency_fsqrt_(LATENCY_FSQRT)
+    , latency_fcvt_(LATENCY_FCVT)
+    , icache_{ICACHE_ENABLED, ICACHE_SIZE, ICACHE_NUM_WAYS, 2, num_warps}
+    , dcache_{DCACHE_ENABLED, DCACHE_SIZE, DCACHE_NUM_WAYS, DCACHE_NUM_BANKS, DCACHE_MSHR_SIZE}
+    , l2cache_{L2_ENABLED, L2_CACHE_SIZE, L2_NUM_WAYS, L2_NUM_BANKS, L2_MSHR_SIZE}
+    , l3cache_{L3_ENABLED, L3_CACHE_SIZE, L3_NUM_WAYS, L3_NUM_BANKS, L3_MSHR_SIZE}
+    , memory_banks_(MEMORY_BANKS)
+  {
+    // runtime overrides of the compile-time defaults
+    auto config_s = getenv("VORTEX_SIMX_CONFIG");
+    if (config_s && *config_s) {
+      this->load_config(config_s);
+    }
+  }
+
+  // override the configuration from a YAML or JSON file
+  void load_config(const std::string& filename);
 
   uint16_t num_barriers() const {
     return num_barriers_;
@@ -70,6 +129,90 @@ public:
   uint16_t socket_size() const {
     return socket_size_;
   }
+
+  uint16_t num_sockets() const {
+    return (num_cores_ + socket_size_ - 1) / socket_size_;
+  }
+
+  uint16_t ibuf_size() const {
+    return ibuf_size_;
+  }
+
+  uint16_t lmem_num_banks() const {
+    return lmem_num_banks_;
+  }
+
+  uint16_t gpr_num_banks() const {
+    return gpr_num_banks_;
+  }
+
+  uint16_t gpr_read_ports() const {
+    return gpr_read_ports_;
+  }
+
+  uint16_t gpr_write_ports() const {
+    return gpr_write_ports_;
+  }
+
+  uint16_t num_opcs() const {
+    return num_opcs_;
+  }
+
+  bool salu_enabled() const {
+    return salu_enabled_;
+  }
+
+  uint16_t compact_window() const {
+    return compact_window_;
+  }
+
+  bool hiz_enabled() const {
+    return hiz_enabled_;
+  }
+
+  uint16_t om_tile_buffers() const {
+    return om_tile_buffers_;
+  }
+
+  uint16_t latency_imul() const {
+    return latency_imul_;
+  }
+
+  uint16_t latency_fma() const {
+    return latency_fma_;
+  }
+
+  uint16_t latency_fdiv() const {
+    return latency_fdiv_;
+  }
+
+  uint16_t latency_fsqrt() const {
+    return latency_fsqrt_;
+  }
+
+  uint16_t latency_fcvt() const {
+    return latency_fcvt_;
+  }
+
+  const CacheConfig& icache() const {
+    return icache_;
+  }
+
+  const CacheConfig& dcache() const {
+    return dcache_;
+  }
+
+  const CacheConfig& l2cache() const {
+    return l2cache_;
+  }
+
+  const CacheConfig& l3cache() const {
+    return l3cache_;
+  }
+
+  uint16_t memory_banks() const {
+    return memory_banks_;
+  }
 };
 
-}
\ No newline at end of file
+}
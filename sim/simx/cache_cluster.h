@@ -77,8 +77,8 @@ public:
 				caches_.at(i)->CoreRspPorts.at(j).bind(&mem_arbs.at(j)->RspOut.at(i));
 			}
 
-			caches_.at(i)->MemReqPort.bind(&cache_arb->ReqIn.at(i));
-			cache_arb->RspIn.at(i).bind(&caches_.at(i)->MemRspPort);
+			caches_.at(i)->MemReqPorts.at(0).bind(&cache_arb->ReqIn.at(i));
+			cache_arb->RspIn.at(i).bind(&caches_.at(i)->MemRspPorts.at(0));
 		}
 
 		cache_arb->ReqOut.at(0).bind(&this->MemReqPort);
@@ -91,6 +91,36 @@ public:
 	
 	void tick() {}
 
+	void flush(bool invalidate) {
+		for (auto cache : caches_) {
+			cache->flush(invalidate);
+		}
+	}
+
+	bool flushing() const {
+		for (auto cache : caches_) {
+			if (cache->flushing())
+				return true;
+		}
+		return false;
+	}
+
+	uint64_t flush_writebacks() const {
+		uint64_t count = 0;
+		for (auto cache : caches_) {
+			count += cache->flush_writebacks();
+		}
+		return count;
+	}
+
+	uint64_t flush_arrivals() const {
+		uint64_t count = 0;
+		for (auto cache : caches_) {
+			count += cache->flush_arrivals();
+		}
+		return count;
+	}
+
 	CacheSim::PerfStats perf_stats() const {
 		CacheSim::PerfStats perf;
 		for (auto cache : caches_) {
@@ -14,6 +14,7 @@
 #include "cache_sim.h"
 #include "debug.h"
 #include "types.h"
+#include "timeline.h"
 #include <util.h>
 #include <unordered_map>
 #include <vector>
@@ -40,6 +41,9 @@ struct params_t {
 	int32_t tag_select_addr_start;
 	int32_t tag_select_addr_end;
 
+	AddrHash index_hash;
+	uint32_t set_prime;
+
 	params_t(const CacheSim::Config& config) {
 		int32_t offset_bits = config.L - config.W;
 		int32_t index_bits = config.C - (config.L + config.A + config.B);
@@ -69,39 +73,87 @@ struct params_t {
 		// Tag select
 		this->tag_select_addr_start = (1+this->set_select_addr_end);
 		this->tag_select_addr_end = (config.addr_width-1);
+
+		// Index hashing
+		this->index_hash = config.index_hash;
+		this->set_prime = prime_floor(this->sets_per_bank);
 	}
 
 	uint32_t addr_bank_id(uint64_t addr) const {
-		if (bank_select_addr_end >= bank_select_addr_start)
-			return (uint32_t)bit_getw(addr, bank_select_addr_start, bank_select_addr_end);
-		else
+		if (bank_select_addr_end < bank_select_addr_start)
 			return 0;
+		switch (index_hash) {
+		case AddrHash::Xor:
+			// fold the set and tag bits into the bank index
+			return (uint32_t)bit_getw(addr, bank_select_addr_start, bank_select_addr_end)
+			     ^ (uint32_t)bit_xorw(this->addr_upper(addr, set_select_addr_start), bank_select_addr_end - bank_select_addr_start + 1);
+		default:
+			// prime hashing keeps the plain bank select so that all banks stay in use
+			return (uint32_t)bit_getw(addr, bank_select_addr_start, bank_select_addr_end);
+		}
 	}
 
 	uint32_t addr_set_id(uint64_t addr) const {
-		if (set_select_addr_end >= set_select_addr_start)
-			return (uint32_t)bit_getw(addr, set_select_addr_start, set_select_addr_end);
-		else
+		if (set_select_addr_end < set_select_addr_start)
 			return 0;
+		switch (index_hash) {
+		case AddrHash::Xor:
+			// fold the tag bits into the set index
+			return (uint32_t)bit_getw(addr, set_select_addr_start, set_select_addr_end)
+			     ^ (uint32_t)bit_xorw(this->addr_tag(addr), set_select_addr_end - set_select_addr_start + 1);
+		case AddrHash::Prime:
+			// the (sets_per_bank - set_prime) highest sets are left unused
+			return (uint32_t)(this->addr_upper(addr, set_select_addr_start) % set_prime);
+		default:
+			return (uint32_t)bit_getw(addr, set_select_addr_start, set_select_addr_end);
+		}
 	}
 
 	uint64_t addr_tag(uint64_t addr) const {
-		if (tag_select_addr_end >= tag_select_addr_start)
-			return bit_getw(addr, tag_select_addr_start, tag_select_addr_end);
-		else
-			return 0;
+		if (index_hash == AddrHash::Prime) {
+			// the modulo is not invertible, keep the full line address
+			return this->addr_line(addr);
+		}
+		return this->addr_upper(addr, tag_select_addr_start);
 	}
 
 	uint64_t mem_addr(uint32_t bank_id, uint32_t set_id, uint64_t tag) const {
 		uint64_t addr(0);
-		if (bank_select_addr_end >= bank_select_addr_start)
-			addr = bit_setw(addr, bank_select_addr_start, bank_select_addr_end, bank_id);
-		if (set_select_addr_end >= set_select_addr_start)
-			addr = bit_setw(addr, set_select_addr_start, set_select_addr_end, set_id);
+		if (index_hash == AddrHash::Prime) {
+			__unused (bank_id, set_id);
+			if (tag_select_addr_end >= bank_select_addr_start)
+				addr = bit_setw(addr, bank_select_addr_start, tag_select_addr_end, tag);
+			return addr;
+		}
 		if (tag_select_addr_end >= tag_select_addr_start)
 			addr = bit_setw(addr, tag_select_addr_start, tag_select_addr_end, tag);
+		if (set_select_addr_end >= set_select_addr_start) {
+			if (index_hash == AddrHash::Xor) {
+				set_id ^= (uint32_t)bit_xorw(tag, set_select_addr_end - set_select_addr_start + 1);
+			}
+			addr = bit_setw(addr, set_select_addr_start, set_select_addr_end, set_id);
+		}
+		if (bank_select_addr_end >= bank_select_addr_start) {
+			if (index_hash == AddrHash::Xor) {
+				bank_id ^= (uint32_t)bit_xorw(this->addr_upper(addr, set_select_addr_start), bank_select_addr_end - bank_select_addr_start + 1);
+			}
+			addr = bit_setw(addr, bank_select_addr_start, bank_select_addr_end, bank_id);
+		}
 		return addr;
 	}
+
+private:
+
+	uint64_t addr_upper(uint64_t addr, int32_t start) const {
+		if (tag_select_addr_end >= start)
+			return bit_getw(addr, start, tag_select_addr_end);
+		else
+			return 0;
+	}
+
+	uint64_t addr_line(uint64_t addr) const {
+		return this->addr_upper(addr, bank_select_addr_start);
+	}
 };
 
 struct line_t {
@@ -109,6 +161,7 @@ struct line_t {
 	uint32_t lru_ctr;
 	bool     valid;
 	bool     dirty;
+	bool     pending; // reserved for an in-flight fill
 
 	void clear() {
 		valid = false;
@@ -126,6 +179,7 @@ struct set_t {
 	void clear() {
 		for (auto& line : lines) {
 			line.clear();
+			line.pending = false;
 		}
 	}
 };
@@ -156,6 +210,8 @@ struct bank_req_t {
 	uint64_t uuid;
 	ReqType  type;
 	bool     write;
+	bool     evict;
+	bool     atomic;
 
 	bank_req_t(uint32_t num_ports)
 		: ports(num_ports)
@@ -171,7 +227,7 @@ struct bank_req_t {
 
 struct mshr_entry_t {
 	bank_req_t bank_req;
-	uint32_t   line_id;
+	int32_t    line_id; // -1 if the fill is not allocated
 
 	mshr_entry_t(uint32_t num_ports)
 		: bank_req(num_ports)
@@ -212,7 +268,7 @@ public:
 		return false;
 	}
 
-	int allocate(const bank_req_t& bank_req, uint32_t line_id) {
+	int allocate(const bank_req_t& bank_req, int32_t line_id) {
 		for (uint32_t i = 0, n = entries_.size(); i < n; ++i) {
 			auto& entry = entries_.at(i);
 			if (entry.bank_req.type == bank_req_t::None) {
@@ -259,14 +315,75 @@ public:
 	}
 };
 
+struct victim_entry_t {
+	uint64_t tag;
+	uint32_t set_id;
+	bool     dirty;
+};
+
+class VictimCache {
+private:
+	std::list<victim_entry_t> entries_; // most recent first
+	uint32_t capacity_;
+
+public:
+	VictimCache(uint32_t capacity)
+		: capacity_(capacity)
+	{}
+
+	bool enabled() const {
+		return (capacity_ != 0);
+	}
+
+	bool remove(uint32_t set_id, uint64_t tag, bool* dirty) {
+		for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+			if (it->set_id == set_id && it->tag == tag) {
+				*dirty = it->dirty;
+				entries_.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool insert(const victim_entry_t& entry, victim_entry_t* displaced) {
+		entries_.push_front(entry);
+		if (entries_.size() <= capacity_)
+			return false;
+		*displaced = entries_.back();
+		entries_.pop_back();
+		return true;
+	}
+
+	template <typename F>
+	void flush(bool invalidate, const F& writeback) {
+		for (auto& entry : entries_) {
+			if (entry.dirty) {
+				writeback(entry);
+				entry.dirty = false;
+			}
+		}
+		if (invalidate) {
+			entries_.clear();
+		}
+	}
+
+	void clear() {
+		entries_.clear();
+	}
+};
+
 struct bank_t {
 	std::vector<set_t> sets;
 	MSHR               mshr;
+	VictimCache        victim;
+	std::unordered_map<uint64_t, uint64_t> amo_locks; // line address -> unlock cycle
 
 	bank_t(const CacheSim::Config& config,
 				 const params_t& params)
 		: sets(params.sets_per_bank, params.lines_per_set)
 		, mshr(config.mshr_size, config.ports_per_bank)
+		, victim(config.victim_size)
 	{}
 
 	void clear() {
@@ -274,6 +391,8 @@ struct bank_t {
 			set.clear();
 		}
 		mshr.clear();
+		victim.clear();
+		amo_locks.clear();
 	}
 };
 
@@ -286,15 +405,21 @@ private:
 	params_t params_;
 	std::vector<bank_t> banks_;
 	MemSwitch::Ptr bank_switch_;
-	MemSwitch::Ptr bypass_switch_;
+	std::vector<MemSwitch::Ptr> bypass_switches_;
+	uint32_t num_mem_ports_;
 	std::vector<SimPort<MemReq>> mem_req_ports_;
 	std::vector<SimPort<MemRsp>> mem_rsp_ports_;
 	std::vector<bank_req_t> pipeline_reqs_;
 	uint32_t init_cycles_;
+	uint32_t flush_cursor_;
+	bool flush_invalidate_;
+	uint64_t flush_writebacks_;
+	uint64_t flush_arrivals_;
 	PerfStats perf_stats_;
 	uint64_t pending_read_reqs_;
 	uint64_t pending_write_reqs_;
 	uint64_t pending_fill_reqs_;
+	MemTimeline::Ptr timeline_;
 
 public:
 	Impl(CacheSim* simobject, const Config& config)
@@ -305,49 +430,95 @@ public:
 		, mem_req_ports_((1 << config.B), simobject)
 		, mem_rsp_ports_((1 << config.B), simobject)
 		, pipeline_reqs_((1 << config.B), config.ports_per_bank)
+		, timeline_(MemTimeline::Create(simobject->name()))
 	{
 		char sname[100];
-		snprintf(sname, 100, "%s-bypass-arb", simobject->name().c_str());
+
+		// maintenance write-backs issued and received
+		flush_writebacks_ = 0;
+		flush_arrivals_ = 0;
+
+		// trace core requests on the timeline
+		if (timeline_) {
+			for (uint32_t i = 0; i < config_.num_inputs; ++i) {
+				simobject->CoreReqPorts.at(i).tx_callback([this, i](const MemReq& req, uint64_t cycle) {
+					timeline_->request(i, req, cycle);
+				});
+				simobject->CoreRspPorts.at(i).tx_callback([this, i](const MemRsp& rsp, uint64_t cycle) {
+					timeline_->response(i, rsp, cycle);
+				});
+			}
+		}
+
+		// memory ports in use, each must serve the same number of sources
+		assert(config_.mem_ports != 0);
+		num_mem_ports_ = config_.mem_ports;
+		uint32_t num_sources = config_.bypass ? config_.num_inputs : (1 << config.B);
+		while ((num_sources % num_mem_ports_) != 0) {
+			num_mem_ports_ >>= 1;
+		}
 
 		if (config_.bypass) {
-			bypass_switch_ = MemSwitch::Create(sname, ArbiterType::RoundRobin, config_.num_inputs);
+			snprintf(sname, 100, "%s-bypass-arb", simobject->name().c_str());
+			auto bypass_switch = MemSwitch::Create(sname, ArbiterType::RoundRobin, config_.num_inputs, num_mem_ports_);
 			for (uint32_t i = 0; i < config_.num_inputs; ++i) {
-				simobject->CoreReqPorts.at(i).bind(&bypass_switch_->ReqIn.at(i));
-				bypass_switch_->RspIn.at(i).bind(&simobject->CoreRspPorts.at(i));
+				simobject->CoreReqPorts.at(i).bind(&bypass_switch->ReqIn.at(i));
+				bypass_switch->RspIn.at(i).bind(&simobject->CoreRspPorts.at(i));
+			}
+			for (uint32_t i = 0; i < num_mem_ports_; ++i) {
+				bypass_switch->ReqOut.at(i).bind(&simobject->MemReqPorts.at(i));
+				simobject->MemRspPorts.at(i).bind(&bypass_switch->RspOut.at(i));
 			}
-			bypass_switch_->ReqOut.at(0).bind(&simobject->MemReqPort);
-			simobject->MemRspPort.bind(&bypass_switch_->RspOut.at(0));
+			bypass_switches_.push_back(bypass_switch);
 			return;
 		}
 
-		bypass_switch_ = MemSwitch::Create(sname, ArbiterType::Priority, 2);
-		bypass_switch_->ReqOut.at(0).bind(&simobject->MemReqPort);
-		simobject->MemRspPort.bind(&bypass_switch_->RspOut.at(0));
+		for (uint32_t i = 0; i < num_mem_ports_; ++i) {
+			snprintf(sname, 100, "%s-bypass-arb%d", simobject->name().c_str(), i);
+			auto bypass_switch = MemSwitch::Create(sname, ArbiterType::Priority, 2);
+			bypass_switch->ReqOut.at(0).bind(&simobject->MemReqPorts.at(i));
+			simobject->MemRspPorts.at(i).bind(&bypass_switch->RspOut.at(0));
+			bypass_switches_.push_back(bypass_switch);
+		}
 
 		if (config.B != 0) {
 			snprintf(sname, 100, "%s-bank-arb", simobject->name().c_str());
-			bank_switch_ = MemSwitch::Create(sname, ArbiterType::RoundRobin, (1 << config.B));
+			bank_switch_ = MemSwitch::Create(sname, ArbiterType::RoundRobin, (1 << config.B), num_mem_ports_);
 			for (uint32_t i = 0, n = (1 << config.B); i < n; ++i) {
 				mem_req_ports_.at(i).bind(&bank_switch_->ReqIn.at(i));
 				bank_switch_->RspIn.at(i).bind(&mem_rsp_ports_.at(i));
 			}
-			bank_switch_->ReqOut.at(0).bind(&bypass_switch_->ReqIn.at(0));
-			bypass_switch_->RspIn.at(0).bind(&bank_switch_->RspOut.at(0));
+			for (uint32_t i = 0; i < num_mem_ports_; ++i) {
+				bank_switch_->ReqOut.at(i).bind(&bypass_switches_.at(i)->ReqIn.at(0));
+				bypass_switches_.at(i)->RspIn.at(0).bind(&bank_switch_->RspOut.at(i));
+			}
 		} else {
-			mem_req_ports_.at(0).bind(&bypass_switch_->ReqIn.at(0));
-			bypass_switch_->RspIn.at(0).bind(&mem_rsp_ports_.at(0));
+			mem_req_ports_.at(0).bind(&bypass_switches_.at(0)->ReqIn.at(0));
+			bypass_switches_.at(0)->RspIn.at(0).bind(&mem_rsp_ports_.at(0));
 		}
 
 		// calculate cache initialization cycles
 		init_cycles_ = params_.sets_per_bank * params_.lines_per_set;
+
+		// no pending flush
+		flush_cursor_ = init_cycles_;
+		flush_invalidate_ = false;
 	}
 
   void reset() {
 		if (config_.bypass)
 			return;
 
+		// cache contents persist across launches, only drop in-flight state
 		for (auto& bank : banks_) {
-			bank.clear();
+			bank.mshr.clear();
+			bank.amo_locks.clear();
+			// release the lines reserved by the dropped fills
+			for (auto& set : bank.sets) {
+				for (auto& line : set.lines) {
+					line.pending = false;
+				}
+			}
 		}
 		perf_stats_ = PerfStats();
 		pending_read_reqs_  = 0;
@@ -365,9 +536,9 @@ public:
 			return;
 		}
 
-		// handle cache bypasss responses
-		{
-			auto& bypass_port = bypass_switch_->RspIn.at(1);
+		// handle cache bypasss responses, they never touch the lines
+		for (auto& bypass_switch : bypass_switches_) {
+			auto& bypass_port = bypass_switch->RspIn.at(1);
 			if (!bypass_port.empty()) {
 				auto& mem_rsp = bypass_port.front();
 				this->processBypassResponse(mem_rsp);
@@ -375,6 +546,15 @@ public:
 			}
 		}
 
+		// walk cache lines for pending flush
+		// fills and core requests wait, a line installed behind the cursor would
+		// be missed by the walk. Maintenance runs between launches, so none are
+		// outstanding in practice.
+		if (flush_cursor_ < params_.sets_per_bank * params_.lines_per_set) {
+			this->processFlush();
+			return;
+		}
+
 		// initialize pipeline request
 		for (auto& pipeline_req : pipeline_reqs_) {
 			pipeline_req.clear();
@@ -414,6 +594,13 @@ public:
 
 			auto& core_req = core_req_port.front();
 
+			// drop clean evictions if not installed at this level
+			if (core_req.evict && !core_req.write
+			 && config_.inclusion == InclusionPolicy::Inclusive) {
+				core_req_port.pop();
+				continue;
+			}
+
 			// check cache bypassing
 			if (core_req.type == AddrType::IO) {
 				// send bypass request
@@ -423,6 +610,13 @@ public:
 				continue;
 			}
 
+			// forward atomics to the level executing them
+			if (core_req.atomic && 0 == config_.amo_latency) {
+				this->processBypassRequest(core_req, req_id);
+				core_req_port.pop();
+				continue;
+			}
+
 			auto bank_id = params_.addr_bank_id(core_req.addr);
 			auto& bank = banks_.at(bank_id);
 			auto& pipeline_req = pipeline_reqs_.at(bank_id);
@@ -435,8 +629,15 @@ public:
 			auto tag     = params_.addr_tag(core_req.addr);
 			auto port_id = req_id % config_.ports_per_bank;
 
+			// serialize atomics to the same line
+			if (core_req.atomic && this->is_line_locked(bank, core_req.addr >> config_.L)) {
+				++perf_stats_.atomic_stalls;
+				continue;
+			}
+
 			// check MSHR capacity
 			if ((!core_req.write || config_.write_back)
+			 && !this->is_install(core_req.evict)
 		   && bank.mshr.full()) {
 				++perf_stats_.mshr_stalls;
 				continue;
@@ -446,6 +647,8 @@ public:
 			if (pipeline_req.type == bank_req_t::Core) {
 				// check port conflict
 				if (pipeline_req.write != core_req.write
+				 || pipeline_req.evict || core_req.evict
+				 || pipeline_req.atomic || core_req.atomic
 				 || pipeline_req.set_id != set_id
 				 || pipeline_req.tag != tag
 				 || pipeline_req.ports.at(port_id).valid) {
@@ -464,14 +667,23 @@ public:
 				bank_req.uuid  = core_req.uuid;
 				bank_req.type  = bank_req_t::Core;
 				bank_req.write = core_req.write;
+				bank_req.evict = core_req.evict;
+				bank_req.atomic = core_req.atomic;
 				pipeline_req   = bank_req;
 			}
 
-			if (core_req.write)
+			if (core_req.atomic) {
+				// hold the line until the atomic executes
+				bank.amo_locks[core_req.addr >> config_.L] = UINT64_MAX;
+				++perf_stats_.atomics;
+			} else if (core_req.write)
 				++perf_stats_.writes;
-			else
+			else if (!core_req.evict)
 				++perf_stats_.reads;
 
+			// track maintenance write-backs from the upper levels
+			flush_arrivals_ += core_req.flush;
+
 			// remove request
 			auto time = core_req_port.pop();
 			perf_stats_.pipeline_stalls += (SimPlatform::instance().cycles() - time);
@@ -481,12 +693,56 @@ public:
 		this->processBankRequests();
 	}
 
+	void flush(bool invalidate) {
+		if (config_.bypass)
+			return;
+		flush_cursor_ = 0;
+		flush_invalidate_ = invalidate;
+	}
+
+	bool flushing() const {
+		if (config_.bypass)
+			return false;
+		return flush_cursor_ < params_.sets_per_bank * params_.lines_per_set;
+	}
+
+	uint64_t flush_writebacks() const {
+		return flush_writebacks_;
+	}
+
+	uint64_t flush_arrivals() const {
+		return flush_arrivals_;
+	}
+
 	const PerfStats& perf_stats() const {
 		return perf_stats_;
 	}
 
 private:
 
+	// write back (and optionally drop) one line per bank each cycle
+	void processFlush() {
+		uint32_t set_id  = flush_cursor_ / params_.lines_per_set;
+		uint32_t line_id = flush_cursor_ % params_.lines_per_set;
+		for (uint32_t bank_id = 0, n = (1 << config_.B); bank_id < n; ++bank_id) {
+			auto& bank = banks_.at(bank_id);
+			auto& line = bank.sets.at(set_id).lines.at(line_id);
+			if (line.valid && line.dirty) {
+				this->releaseLine(bank_id, set_id, line.tag, true, 0, true);
+				line.dirty = false;
+			}
+			if (flush_invalidate_) {
+				line.clear();
+			}
+			if (0 == flush_cursor_) {
+				bank.victim.flush(flush_invalidate_, [&](const victim_entry_t& entry) {
+					this->releaseLine(bank_id, entry.set_id, entry.tag, true, 0, true);
+				});
+			}
+		}
+		++flush_cursor_;
+	}
+
 	void processBypassResponse(const MemRsp& mem_rsp) {
 		uint32_t req_id = mem_rsp.tag & ((1 << params_.log2_num_inputs)-1);
 		uint64_t tag = mem_rsp.tag >> params_.log2_num_inputs;
@@ -499,7 +755,7 @@ private:
 		{
 			MemReq mem_req(core_req);
 			mem_req.tag = (core_req.tag << params_.log2_num_inputs) + req_id;
-			bypass_switch_->ReqIn.at(1).push(mem_req, 1);
+			bypass_switches_.at(req_id % num_mem_ports_)->ReqIn.at(1).push(mem_req, 1);
 			DT(3, simobject_->name() << " dram-req: " << mem_req);
 		}
 
@@ -510,6 +766,118 @@ private:
 		}
 	}
 
+	bool is_line_locked(bank_t& bank, uint64_t line_addr) {
+		auto it = bank.amo_locks.find(line_addr);
+		if (it == bank.amo_locks.end())
+			return false;
+		if (it->second > SimPlatform::instance().cycles())
+			return true;
+		bank.amo_locks.erase(it);
+		return false;
+	}
+
+	// read-modify-write the line in the bank's atomic unit
+	void processAtomic(uint32_t bank_id, const bank_req_t& bank_req, uint32_t latency) {
+		auto& bank = banks_.at(bank_id);
+		auto line_addr = params_.mem_addr(bank_id, bank_req.set_id, bank_req.tag);
+
+		line_t* hit_line = nullptr;
+		for (auto& line : bank.sets.at(bank_req.set_id).lines) {
+			if (line.valid && line.tag == bank_req.tag) {
+				hit_line = &line;
+				break;
+			}
+		}
+
+		if (hit_line && config_.write_back) {
+			hit_line->dirty = true;
+		} else {
+			// forward the updated word to memory
+			MemReq mem_req;
+			mem_req.addr  = line_addr;
+			mem_req.write = true;
+			mem_req.cid   = bank_req.cid;
+			mem_req.uuid  = bank_req.uuid;
+			mem_req_ports_.at(bank_id).push(mem_req, 1);
+			DT(3, simobject_->name() << "-bank" << bank_id << " amo-writethrough: " << mem_req);
+		}
+
+		// the line stays locked for the duration of the ALU operation
+		auto cycles = SimPlatform::instance().cycles();
+		bank.amo_locks[line_addr >> config_.L] = cycles + config_.amo_latency;
+		if (bank.amo_locks.size() > config_.mshr_size) {
+			for (auto it = bank.amo_locks.begin(); it != bank.amo_locks.end();) {
+				if (it->second <= cycles) {
+					it = bank.amo_locks.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+
+		this->sendCoreResponse(bank_id, bank_req, latency + config_.amo_latency);
+	}
+
+	bool is_install(bool evict) const {
+		return evict && (config_.inclusion != InclusionPolicy::Inclusive);
+	}
+
+	void sendCoreResponse(uint32_t bank_id, const bank_req_t& bank_req, uint32_t latency) {
+		for (auto& info : bank_req.ports) {
+			if (!info.valid)
+				continue;
+			MemRsp core_rsp{info.req_tag, bank_req.cid, bank_req.uuid};
+			simobject_->CoreRspPorts.at(info.req_id).push(core_rsp, latency);
+			DT(3, simobject_->name() << "-bank" << bank_id << " core-rsp: " << core_rsp);
+		}
+		__unused (bank_id);
+	}
+
+	// release a line leaving this cache level
+	void releaseLine(uint32_t bank_id, uint32_t set_id, uint64_t tag, bool dirty, uint32_t cid, bool flush = false) {
+		if (!dirty && !config_.evict_clean)
+			return;
+		MemReq mem_req;
+		mem_req.addr  = params_.mem_addr(bank_id, set_id, tag);
+		mem_req.write = dirty;
+		mem_req.cid   = cid;
+		mem_req.evict = true;
+		mem_req.flush = flush;
+		mem_req_ports_.at(bank_id).push(mem_req, 1);
+		DT(3, simobject_->name() << "-bank" << bank_id << " writeback: " << mem_req);
+		if (dirty) {
+			++perf_stats_.evictions;
+		}
+		flush_writebacks_ += flush;
+	}
+
+	// evict a line from its set, through the victim cache if enabled
+	void evictLine(uint32_t bank_id, uint32_t set_id, line_t& line, uint32_t cid) {
+		auto& bank = banks_.at(bank_id);
+		if (bank.victim.enabled()) {
+			victim_entry_t displaced;
+			if (bank.victim.insert({line.tag, set_id, line.dirty}, &displaced)) {
+				this->releaseLine(bank_id, displaced.set_id, displaced.tag, displaced.dirty, cid);
+			}
+		} else {
+			this->releaseLine(bank_id, set_id, line.tag, line.dirty, cid);
+		}
+		line.clear();
+	}
+
+	// install a line into its set, evicting the current occupant
+	void installLine(uint32_t bank_id, uint32_t set_id, uint32_t line_id, uint64_t tag, bool dirty, uint32_t cid) {
+		auto& line = banks_.at(bank_id).sets.at(set_id).lines.at(line_id);
+		if (line.valid) {
+			this->evictLine(bank_id, set_id, line, cid);
+		}
+		line.valid   = true;
+		line.dirty   = dirty;
+		line.pending = false;
+		line.tag     = tag;
+		line.lru_ctr = 0;
+	}
+
 	void processBankRequests() {
 		for (uint32_t bank_id = 0, n = (1 << config_.B); bank_id < n; ++bank_id) {
 			auto& bank = banks_.at(bank_id);
@@ -520,38 +888,37 @@ private:
 				break;
 			case bank_req_t::Fill: {
 				// update cache line
-				auto& bank  = banks_.at(bank_id);
 				auto& entry = bank.mshr.replay(pipeline_req.tag);
-				auto& set   = bank.sets.at(entry.bank_req.set_id);
-				auto& line  = set.lines.at(entry.line_id);
-				line.valid  = true;
-				line.tag    = entry.bank_req.tag;
+				if (entry.line_id != -1) {
+					this->installLine(bank_id, entry.bank_req.set_id, entry.line_id, entry.bank_req.tag, entry.bank_req.write, entry.bank_req.cid);
+				}
 				--pending_fill_reqs_;
 			} break;
 			case bank_req_t::Replay: {
+				if (pipeline_req.atomic) {
+					this->processAtomic(bank_id, pipeline_req, config_.latency);
+					break;
+				}
 				// send core response
 				if (!pipeline_req.write || config_.write_reponse) {
-					for (auto& info : pipeline_req.ports) {
-						if (!info.valid)
-							continue;
-						MemRsp core_rsp{info.req_tag, pipeline_req.cid, pipeline_req.uuid};
-						simobject_->CoreRspPorts.at(info.req_id).push(core_rsp, config_.latency);
-						DT(3, simobject_->name() << "-bank" << bank_id << " replay: " << core_rsp);
-					}
+					this->sendCoreResponse(bank_id, pipeline_req, config_.latency);
 				}
 			} break;
 			case bank_req_t::Core: {
 				int32_t hit_line_id  = -1;
 				int32_t free_line_id = -1;
-				int32_t repl_line_id = 0;
+				int32_t repl_line_id = -1;
 				uint32_t max_cnt = 0;
+				uint32_t latency = config_.latency;
 
 				auto& set = bank.sets.at(pipeline_req.set_id);
 
-				// tag lookup
+				// tag lookup, lines reserved for pending fills cannot be replaced
 				for (uint32_t i = 0, n = set.lines.size(); i < n; ++i) {
 					auto& line = set.lines.at(i);
-					if (max_cnt < line.lru_ctr) {
+					if (line.pending)
+						continue;
+					if (repl_line_id == -1 || max_cnt < line.lru_ctr) {
 						max_cnt = line.lru_ctr;
 						repl_line_id = i;
 					}
@@ -567,11 +934,42 @@ private:
 					}
 				}
 
-				if (hit_line_id != -1) {
+				// line to allocate on a miss, none when all are reserved
+				auto alloc_line_id = (free_line_id != -1) ? free_line_id : repl_line_id;
+
+				// victim cache lookup
+				if (hit_line_id == -1 && alloc_line_id != -1) {
+					bool dirty;
+					if (bank.victim.remove(pipeline_req.set_id, pipeline_req.tag, &dirty)) {
+						// swap the victim line back into the set
+						hit_line_id = alloc_line_id;
+						this->installLine(bank_id, pipeline_req.set_id, hit_line_id, pipeline_req.tag, dirty, pipeline_req.cid);
+						DT(3, simobject_->name() << "-bank" << bank_id << " victim-hit: set=" << pipeline_req.set_id << ", tag=0x" << std::hex << pipeline_req.tag << std::dec);
+						++perf_stats_.victim_hits;
+						latency += 1;
+					}
+				}
+
+				if (this->is_install(pipeline_req.evict)) {
+					// install upper-level eviction
+					if (hit_line_id != -1) {
+						set.lines.at(hit_line_id).dirty |= pipeline_req.write;
+					} else if (alloc_line_id != -1) {
+						this->installLine(bank_id, pipeline_req.set_id, alloc_line_id, pipeline_req.tag, pipeline_req.write, pipeline_req.cid);
+					} else {
+						// no line available, pass the eviction down
+						this->releaseLine(bank_id, pipeline_req.set_id, pipeline_req.tag, pipeline_req.write, pipeline_req.cid);
+					}
+					break;
+				}
+
+				if (hit_line_id != -1 && pipeline_req.atomic) {
+					this->processAtomic(bank_id, pipeline_req, latency);
+				} else if (hit_line_id != -1) {
 					// Hit handling
+					auto& hit_line = set.lines.at(hit_line_id);
 					if (pipeline_req.write) {
 						// handle write has_hit
-						auto& hit_line = set.lines.at(hit_line_id);
 						if (!config_.write_back) {
 							// forward write request to memory
 							MemReq mem_req;
@@ -585,16 +983,16 @@ private:
 							// mark line as dirty
 							hit_line.dirty = true;
 						}
+					} else if (config_.inclusion == InclusionPolicy::Exclusive) {
+						// move the line up to the requesting level
+						if (hit_line.dirty) {
+							this->releaseLine(bank_id, pipeline_req.set_id, hit_line.tag, true, pipeline_req.cid);
+						}
+						hit_line.clear();
 					}
 					// send core response
 					if (!pipeline_req.write || config_.write_reponse) {
-						for (auto& info : pipeline_req.ports) {
-							if (!info.valid)
-								continue;
-							MemRsp core_rsp{info.req_tag, pipeline_req.cid, pipeline_req.uuid};
-							simobject_->CoreRspPorts.at(info.req_id).push(core_rsp, config_.latency);
-							DT(3, simobject_->name() << "-bank" << bank_id << " core-rsp: " << core_rsp);
-						}
+						this->sendCoreResponse(bank_id, pipeline_req, latency);
 					}
 				} else {
 					// Miss handling
@@ -603,20 +1001,6 @@ private:
 					else
 						++perf_stats_.read_misses;
 
-					if (free_line_id == -1 && config_.write_back) {
-						// write back dirty line
-						auto& repl_line = set.lines.at(repl_line_id);
-						if (repl_line.dirty) {
-							MemReq mem_req;
-							mem_req.addr  = params_.mem_addr(bank_id, pipeline_req.set_id, repl_line.tag);
-							mem_req.write = true;
-							mem_req.cid   = pipeline_req.cid;
-							mem_req_ports_.at(bank_id).push(mem_req, 1);
-							DT(3, simobject_->name() << "-bank" << bank_id << " writeback: " << mem_req);
-							++perf_stats_.evictions;
-						}
-					}
-
 					if (pipeline_req.write && !config_.write_back) {
 						// forward write request to memory
 						{
@@ -630,20 +1014,31 @@ private:
 						}
 						// send core response
 						if (config_.write_reponse) {
-							for (auto& info : pipeline_req.ports) {
-								if (!info.valid)
-									continue;
-								MemRsp core_rsp{info.req_tag, pipeline_req.cid, pipeline_req.uuid};
-								simobject_->CoreRspPorts.at(info.req_id).push(core_rsp, config_.latency);
-								DT(3, simobject_->name() << "-bank" << bank_id << " core-rsp: " << core_rsp);
-							}
+							this->sendCoreResponse(bank_id, pipeline_req, latency);
 						}
 					} else {
 						// MSHR lookup
 						auto mshr_pending = bank.mshr.lookup(pipeline_req);
 
+						// select the fill line, exclusive caches only allocate on writes and atomics.
+						// The line stays reserved until the fill arrives, so that later misses
+						// to the same set do not pick it again.
+						int32_t line_id = -1;
+						if (!mshr_pending
+						 && (pipeline_req.write || pipeline_req.atomic
+						  || config_.inclusion != InclusionPolicy::Exclusive)) {
+							line_id = alloc_line_id;
+							if (line_id != -1) {
+								auto& repl_line = set.lines.at(line_id);
+								if (repl_line.valid) {
+									this->evictLine(bank_id, pipeline_req.set_id, repl_line, pipeline_req.cid);
+								}
+								repl_line.pending = true;
+							}
+						}
+
 						// allocate MSHR
-						auto mshr_id = bank.mshr.allocate(pipeline_req, (free_line_id != -1) ? free_line_id : repl_line_id);
+						auto mshr_id = bank.mshr.allocate(pipeline_req, line_id);
 
 						// send fill request
 						if (!mshr_pending) {
@@ -673,8 +1068,8 @@ CacheSim::CacheSim(const SimContext& ctx, const char* name, const Config& config
 	: SimObject<CacheSim>(ctx, name)
 	, CoreReqPorts(config.num_inputs, this)
 	, CoreRspPorts(config.num_inputs, this)
-	, MemReqPort(this)
-	, MemRspPort(this)
+	, MemReqPorts(config.mem_ports, this)
+	, MemRspPorts(config.mem_ports, this)
 	, impl_(new Impl(this, config))
 {}
 
@@ -690,6 +1085,22 @@ void CacheSim::tick() {
   impl_->tick();
 }
 
+void CacheSim::flush(bool invalidate) {
+  impl_->flush(invalidate);
+}
+
+bool CacheSim::flushing() const {
+  return impl_->flushing();
+}
+
+uint64_t CacheSim::flush_writebacks() const {
+  return impl_->flush_writebacks();
+}
+
+uint64_t CacheSim::flush_arrivals() const {
+  return impl_->flush_arrivals();
+}
+
 const CacheSim::PerfStats& CacheSim::perf_stats() const {
   return impl_->perf_stats();
 }
\ No newline at end of file
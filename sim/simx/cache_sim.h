@@ -18,6 +18,22 @@
 
 namespace vortex {
 
+enum class InclusionPolicy {
+	Inclusive,    // allocate on fill, drop clean upper-level evictions
+	NonInclusive, // allocate on fill, install upper-level evictions
+	Exclusive     // no fill allocation, move hits up, install upper-level evictions
+};
+
+inline std::ostream &operator<<(std::ostream &os, const InclusionPolicy& policy) {
+	switch (policy) {
+	case InclusionPolicy::Inclusive:    os << "Inclusive"; break;
+	case InclusionPolicy::NonInclusive: os << "NonInclusive"; break;
+	case InclusionPolicy::Exclusive:    os << "Exclusive"; break;
+	default: assert(false);
+	}
+	return os;
+}
+
 class CacheSim : public SimObject<CacheSim> {
 public:
 	struct Config {
@@ -30,10 +46,16 @@ public:
 		uint8_t addr_width;     // word address bits
 		uint8_t ports_per_bank; // number of ports per bank
 		uint8_t num_inputs;     // number of inputs
+		uint8_t mem_ports;      // number of memory ports
 		bool    write_back;     // is write-back
 		bool    write_reponse;  // enable write response
 		uint16_t mshr_size;     // MSHR buffer size
 		uint8_t latency;        // pipeline latency
+		AddrHash index_hash;    // bank/set index hashing
+		uint8_t victim_size;    // victim cache entries per bank
+		InclusionPolicy inclusion; // inclusion policy for upper-level evictions
+		bool    evict_clean;    // forward clean evictions to the next level
+		uint8_t amo_latency;    // atomic ALU latency (0: forward atomics to the next level)
 	};
 
 	struct PerfStats {
@@ -46,6 +68,9 @@ public:
 		uint64_t bank_stalls;
 		uint64_t mshr_stalls;
 		uint64_t mem_latency;
+		uint64_t victim_hits;
+		uint64_t atomics;
+		uint64_t atomic_stalls;
 
 		PerfStats()
 			: reads(0)
@@ -57,6 +82,9 @@ public:
 			, bank_stalls(0)
 			, mshr_stalls(0)
 			, mem_latency(0)
+			, victim_hits(0)
+			, atomics(0)
+			, atomic_stalls(0)
 		{}
 
 		PerfStats& operator+=(const PerfStats& rhs) {
@@ -69,14 +97,17 @@ public:
 			this->bank_stalls += rhs.bank_stalls;
 			this->mshr_stalls += rhs.mshr_stalls;
 			this->mem_latency += rhs.mem_latency;
+			this->victim_hits += rhs.victim_hits;
+			this->atomics += rhs.atomics;
+			this->atomic_stalls += rhs.atomic_stalls;
 			return *this;
 		}
 	};
 
 	std::vector<SimPort<MemReq>> CoreReqPorts;
 	std::vector<SimPort<MemRsp>> CoreRspPorts;
-	SimPort<MemReq>              MemReqPort;
-	SimPort<MemRsp>              MemRspPort;
+	std::vector<SimPort<MemReq>> MemReqPorts;
+	std::vector<SimPort<MemRsp>> MemRspPorts;
 
 	CacheSim(const SimContext& ctx, const char* name, const Config& config);
 	~CacheSim();
@@ -85,6 +116,18 @@ public:
 
 	void tick();
 
+	// write back dirty lines before serving new requests, optionally dropping all lines
+	void flush(bool invalidate);
+
+	// a flush walk is in progress
+	bool flushing() const;
+
+	// write-backs issued by flush walks
+	uint64_t flush_writebacks() const;
+
+	// flush write-backs received from the upper levels
+	uint64_t flush_arrivals() const;
+
 	const PerfStats& perf_stats() const;
 
 private:
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include "cluster.h"
+#include "processor_impl.h"
 
 using namespace vortex;
 
@@ -25,7 +26,7 @@ Cluster::Cluster(const SimContext& ctx,
   , mem_rsp_port(this)
   , cluster_id_(cluster_id)
   , processor_(processor)
-  , sockets_(NUM_SOCKETS)
+  , sockets_(arch.num_sockets())
   , barriers_(arch.num_barriers(), 0)
   , raster_units_(NUM_RASTER_UNITS)
   , tex_units_(NUM_TEX_UNITS)
@@ -34,6 +35,8 @@ Cluster::Cluster(const SimContext& ctx,
 {
   char sname[100];
 
+  auto hiz_buffer = processor->hiz_buffer();
+
   uint32_t sockets_per_cluster = sockets_.size();
 
   // create raster units
@@ -44,13 +47,13 @@ Cluster::Cluster(const SimContext& ctx,
     raster_units_.at(i) = RasterUnit::Create(sname, raster_idx, raster_count, arch, dcrs.raster_dcrs, RasterUnit::Config{
       RASTER_TILE_LOGSIZE,
       RASTER_BLOCK_LOGSIZE
-    });
+    }, hiz_buffer);
   }
 
   // create om units
   for (uint32_t i = 0; i < NUM_OM_UNITS; ++i) {
     snprintf(sname, 100, "cluster%d-om_unit%d", cluster_id, i);
-    om_units_.at(i) = OMUnit::Create(sname, arch, dcrs.om_dcrs);
+    om_units_.at(i) = OMUnit::Create(sname, arch, dcrs.om_dcrs, hiz_buffer);
   }
 
   // create tex units
@@ -114,23 +117,29 @@ Cluster::Cluster(const SimContext& ctx,
 
   snprintf(sname, 100, "cluster%d-l2cache", cluster_id);
   l2cache_ = CacheSim::Create(sname, CacheSim::Config{
-    !L2_ENABLED,
-    log2ceil(L2_CACHE_SIZE),// C
+    !arch.l2cache().enabled,
+    uint8_t(log2ceil(arch.l2cache().size)), // C
     log2ceil(MEM_BLOCK_SIZE),// L
     log2ceil(L1_LINE_SIZE), // W
-    log2ceil(L2_NUM_WAYS),  // A
-    log2ceil(L2_NUM_BANKS), // B
+    uint8_t(log2ceil(arch.l2cache().num_ways)), // A
+    uint8_t(log2ceil(arch.l2cache().num_banks)), // B
     XLEN,                   // address bits
     1,                      // number of ports
     5,                      // request size
+    1,                      // memory ports
     true,                   // write-through
     false,                  // write response
-    L2_MSHR_SIZE,           // mshr size
+    arch.l2cache().mshr_size, // mshr size
     2,                      // pipeline latency
+    AddrHash(L2_INDEX_HASH), // index hashing
+    L2_VICTIM_SIZE,         // victim cache size
+    InclusionPolicy::Inclusive, // inclusion policy
+    (arch.l3cache().enabled && L3_INCLUSION != 0), // evict clean lines into a non-inclusive L3
+    (AMO_LEVEL == 2) ? AMO_LATENCY : 0, // atomic latency
   });
 
-  l2cache_->MemReqPort.bind(&this->mem_req_port);
-  this->mem_rsp_port.bind(&l2cache_->MemRspPort);
+  l2cache_->MemReqPorts.at(0).bind(&this->mem_req_port);
+  this->mem_rsp_port.bind(&l2cache_->MemRspPorts.at(0));
 
   icache_switch->ReqOut.at(0).bind(&l2cache_->CoreReqPorts.at(0));
   l2cache_->CoreRspPorts.at(0).bind(&icache_switch->RspOut.at(0));
@@ -151,10 +160,16 @@ Cluster::Cluster(const SimContext& ctx,
     XLEN,                   // address bits
     1,                      // number of ports
     TCACHE_NUM_BANKS,       // number of inputs
+    1,                      // memory ports
     true,                   // write-through
     false,                  // write response
     TCACHE_MSHR_SIZE,       // mshr
     4,                      // pipeline latency
+    AddrHash(L1_INDEX_HASH), // index hashing
+    L1_VICTIM_SIZE,         // victim cache size
+    InclusionPolicy::Inclusive, // inclusion policy
+    false,                  // evict clean lines
+    0,                      // atomic latency
   });
 
   tcaches_->MemReqPort.bind(&l2cache_->CoreReqPorts.at(2));
@@ -180,10 +195,16 @@ Cluster::Cluster(const SimContext& ctx,
     XLEN,                   // address bits
     1,                      // number of ports
     RCACHE_NUM_BANKS,       // number of inputs
+    1,                      // memory ports
     true,                   // write-through
     false,                  // write response
     RCACHE_MSHR_SIZE,       // mshr
     4,                      // pipeline latency
+    AddrHash(L1_INDEX_HASH), // index hashing
+    L1_VICTIM_SIZE,         // victim cache size
+    InclusionPolicy::Inclusive, // inclusion policy
+    false,                  // evict clean lines
+    0,                      // atomic latency
   });
 
   rcaches_->MemReqPort.bind(&l2cache_->CoreReqPorts.at(4));
@@ -207,10 +228,16 @@ Cluster::Cluster(const SimContext& ctx,
     XLEN,                   // address bits
     1,                      // number of ports
     OCACHE_NUM_BANKS,       // number of inputs
+    1,                      // memory ports
     true,                   // write-through
     false,                  // write response
     OCACHE_MSHR_SIZE,       // mshr
     4,                      // pipeline latency
+    AddrHash(L1_INDEX_HASH), // index hashing
+    L1_VICTIM_SIZE,         // victim cache size
+    InclusionPolicy::Inclusive, // inclusion policy
+    false,                  // evict clean lines
+    0,                      // atomic latency
   });
 
   ocaches_->MemReqPort.bind(&l2cache_->CoreReqPorts.at(3));
@@ -235,7 +262,14 @@ void Cluster::reset() {
 }
 
 void Cluster::tick() {
-  //--
+  // write back the output mergers' tile buffers once the cores are done
+  for (auto& socket : sockets_) {
+    if (socket->running())
+      return;
+  }
+  for (auto& om_unit : om_units_) {
+    om_unit->flush();
+  }
 }
 
 void Cluster::attach_ram(RAM* ram) {
@@ -258,6 +292,10 @@ bool Cluster::running() const {
     if (socket->running())
       return true;
   }
+  for (auto& om_unit : om_units_) {
+    if (om_unit->busy())
+      return true;
+  }
   return false;
 }
 
@@ -296,11 +334,55 @@ void Cluster::barrier(uint32_t bar_id, uint32_t count, uint32_t core_id) {
     }
 }
 
+void Cluster::flush_caches(uint32_t level, bool invalidate) {
+  if (level != 0) {
+    l2cache_->flush(invalidate);
+    return;
+  }
+  for (auto& socket : sockets_) {
+    socket->flush_caches(invalidate);
+  }
+  tcaches_->flush(invalidate);
+  rcaches_->flush(invalidate);
+  ocaches_->flush(invalidate);
+}
+
+bool Cluster::flushing_caches(uint32_t level) const {
+  if (level != 0)
+    return l2cache_->flushing();
+  for (auto& socket : sockets_) {
+    if (socket->flushing_caches())
+      return true;
+  }
+  return tcaches_->flushing()
+      || rcaches_->flushing()
+      || ocaches_->flushing();
+}
+
+void Cluster::flush_counts(uint64_t* writebacks, uint64_t* arrivals) const {
+  for (auto& socket : sockets_) {
+    socket->flush_counts(writebacks, arrivals);
+  }
+  *writebacks += tcaches_->flush_writebacks() + rcaches_->flush_writebacks()
+               + ocaches_->flush_writebacks() + l2cache_->flush_writebacks();
+  *arrivals += tcaches_->flush_arrivals() + rcaches_->flush_arrivals()
+             + ocaches_->flush_arrivals() + l2cache_->flush_arrivals();
+}
+
 Cluster::PerfStats Cluster::perf_stats() const {
   PerfStats perf_stats;
   perf_stats.l2cache = l2cache_->perf_stats();
   perf_stats.rcache = rcaches_->perf_stats();
   perf_stats.tcache = tcaches_->perf_stats();
   perf_stats.ocache = ocaches_->perf_stats();
+  for (auto& raster_unit : raster_units_) {
+    perf_stats.raster += raster_unit->perf_stats();
+  }
+  for (auto& tex_unit : tex_units_) {
+    perf_stats.tex += tex_unit->perf_stats();
+  }
+  for (auto& om_unit : om_units_) {
+    perf_stats.om += om_unit->perf_stats();
+  }
   return perf_stats;
 }
\ No newline at end of file
@@ -36,6 +36,9 @@ public:
     CacheSim::PerfStats rcache;
     CacheSim::PerfStats tcache;
     CacheSim::PerfStats ocache;
+    RasterUnit::PerfStats raster;
+    TexUnit::PerfStats tex;
+    OMUnit::PerfStats om;
   };
 
   SimPort<MemReq> mem_req_port;
@@ -69,7 +72,19 @@ public:
 
   void barrier(uint32_t bar_id, uint32_t count, uint32_t core_id);
 
+  // cache maintenance of one level: 0 for the L1 caches, 1 for the L2
+  void flush_caches(uint32_t level, bool invalidate);
+
+  bool flushing_caches(uint32_t level) const;
+
+  // adds the flush write-backs issued and received by the cluster caches
+  void flush_counts(uint64_t* writebacks, uint64_t* arrivals) const;
+
   PerfStats perf_stats() const;
+
+  const std::vector<Socket::Ptr>& sockets() const {
+    return sockets_;
+  }
   
 private:
   uint32_t                    cluster_id_;
@@ -25,6 +25,100 @@
 #define MEMORY_BANKS      2
 #endif
 
+// memory channel interleave granularity (bytes)
+#ifndef MEMORY_INTERLEAVE
+#define MEMORY_INTERLEAVE MEM_BLOCK_SIZE
+#endif
+
+#ifndef MEMORY_QUEUE_SIZE
+#define MEMORY_QUEUE_SIZE 8
+#endif
+
+#ifndef MEMORY_ROW_SIZE
+#define MEMORY_ROW_SIZE   2048
+#endif
+
+// cache/local memory index hashing: 0=none, 1=xor, 2=prime
+// prime hashing applies to the cache set index; the local memory has no sets,
+// so there it models a prime number of banks and leaves the others idle
+#ifndef L1_INDEX_HASH
+#define L1_INDEX_HASH     0
+#endif
+
+#ifndef L2_INDEX_HASH
+#define L2_INDEX_HASH     0
+#endif
+
+#ifndef L3_INDEX_HASH
+#define L3_INDEX_HASH     0
+#endif
+
+#ifndef LMEM_INDEX_HASH
+#define LMEM_INDEX_HASH   0
+#endif
+
+// victim cache entries per bank (0=disabled)
+#ifndef L1_VICTIM_SIZE
+#define L1_VICTIM_SIZE    0
+#endif
+
+#ifndef L2_VICTIM_SIZE
+#define L2_VICTIM_SIZE    0
+#endif
+
+// L3 inclusion policy: 0=inclusive, 1=non-inclusive, 2=exclusive
+#ifndef L3_INCLUSION
+#define L3_INCLUSION      0
+#endif
+
+// near-memory atomics: cache level executing AMOs (2=L2, 3=L3) and ALU latency
+#ifndef AMO_LEVEL
+#define AMO_LEVEL         2
+#endif
+
+#ifndef AMO_LATENCY
+#define AMO_LATENCY       4
+#endif
+
+// register file: banks, read ports per bank, write ports per bank
+// (0: writebacks share the read ports) and operand collectors per issue slot
+#ifndef GPR_NUM_BANKS
+#define GPR_NUM_BANKS     4
+#endif
+
+#ifndef GPR_READ_PORTS
+#define GPR_READ_PORTS    1
+#endif
+
+#ifndef GPR_WRITE_PORTS
+#define GPR_WRITE_PORTS   1
+#endif
+
+#ifndef NUM_OPCS
+#define NUM_OPCS          1
+#endif
+
+// scalar ALU executing warp-uniform integer operations (one per issue slot)
+#ifndef SALU_ENABLED
+#define SALU_ENABLED      0
+#endif
+
+// hierarchical-Z culling of occluded stamps in the raster units, applied to
+// draws whose depth state sets VX_OM_DEPTH_HIZ_SAFE
+#ifndef HIZ_ENABLED
+#define HIZ_ENABLED       0
+#endif
+
+// screen tiles held on-chip by each output merger (0: immediate mode)
+#ifndef OM_TILE_BUFFERS
+#define OM_TILE_BUFFERS   0
+#endif
+
+// dynamic warp compaction study: window in cycles for regrouping divergent warps at the same PC (0: disabled)
+#ifndef WARP_COMPACT_WINDOW
+#define WARP_COMPACT_WINDOW 0
+#endif
+
 #define LSU_WORD_SIZE     (XLEN / 8)
 #define LSU_CHANNELS      NUM_LSU_LANES
 #define LSU_NUM_REQS	    (NUM_LSU_BLOCKS * LSU_CHANNELS)
@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include <string.h>
 #include <assert.h>
 #include <util.h>
@@ -20,6 +21,9 @@
 #include "arch.h"
 #include "mem.h"
 #include "core.h"
+#include "socket.h"
+#include "cluster.h"
+#include "processor_impl.h"
 #include "debug.h"
 #include "constants.h"
 
@@ -45,7 +49,7 @@ Core::Core(const SimContext& ctx,
     , tex_units_(tex_units)
     , om_units_(om_units)
     , emulator_(arch, dcrs, this)
-    , ibuffers_(arch.num_warps(), IBUF_SIZE)
+    , ibuffers_(arch.num_warps(), arch.ibuf_size())
     , scoreboard_(arch_)
     , operands_(ISSUE_WIDTH)
     , dispatchers_((uint32_t)FUType::Count)
@@ -55,12 +59,14 @@ Core::Core(const SimContext& ctx,
     , lsu_dcache_adapter_(NUM_LSU_BLOCKS)
     , lsu_lmem_adapter_(NUM_LSU_BLOCKS)
     , pending_icache_(arch_.num_warps())
+    , profiler_(socket->cluster()->processor()->profiler())
+    , timeline_(Timeline::instance())
     , commit_arbs_(ISSUE_WIDTH)
 {
   char sname[100];
 
   for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
-    operands_.at(i) = SimPlatform::instance().create_object<Operand>();
+    operands_.at(i) = SimPlatform::instance().create_object<Operand>(arch);
   }
 
   // create the memory coalescer
@@ -75,8 +81,9 @@ Core::Core(const SimContext& ctx,
     (1 << LMEM_LOG_SIZE),
     LSU_WORD_SIZE,
     LSU_NUM_REQS,
-    log2ceil(LMEM_NUM_BANKS),
-    false
+    log2ceil(arch.lmem_num_banks()),
+    false,
+    AddrHash(LMEM_INDEX_HASH)
   });
 
   // create lsu demux
@@ -135,12 +142,14 @@ Core::Core(const SimContext& ctx,
   dispatchers_.at((int)FUType::FPU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, NUM_FPU_BLOCKS, NUM_FPU_LANES);
   dispatchers_.at((int)FUType::LSU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, NUM_LSU_BLOCKS, NUM_LSU_LANES);
   dispatchers_.at((int)FUType::SFU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, NUM_SFU_BLOCKS, NUM_SFU_LANES);
+  dispatchers_.at((int)FUType::SALU) = SimPlatform::instance().create_object<Dispatcher>(arch, 2, ISSUE_WIDTH, arch.num_threads());
 
   // initialize execute units
   func_units_.at((int)FUType::ALU) = SimPlatform::instance().create_object<AluUnit>(this);
   func_units_.at((int)FUType::FPU) = SimPlatform::instance().create_object<FpuUnit>(this);
   func_units_.at((int)FUType::LSU) = SimPlatform::instance().create_object<LsuUnit>(this);
   func_units_.at((int)FUType::SFU) = SimPlatform::instance().create_object<SfuUnit>(this);
+  func_units_.at((int)FUType::SALU) = SimPlatform::instance().create_object<AluUnit>(this, "salu-unit");
 
   // bind commit arbiters
   for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
@@ -156,7 +165,29 @@ Core::Core(const SimContext& ctx,
 }
 
 Core::~Core() {
-  //--
+#ifdef PERF_ENABLE
+  // dump the most expensive divergent regions of all launches
+  std::vector<std::pair<Word, const simt_region_t*>> regions;
+  for (auto& region : simt_regions_) {
+    if (region.second.divergent != 0) {
+      regions.push_back({region.first, &region.second});
+    }
+  }
+  std::sort(regions.begin(), regions.end(), [](const auto& a, const auto& b) {
+    return a.second->cycles > b.second->cycles;
+  });
+  for (uint32_t i = 0, n = std::min<uint32_t>(regions.size(), 8); i < n; ++i) {
+    auto& region = *regions.at(i).second;
+    std::cout << std::dec << "PERF: core" << core_id_ << ": simt region 0x" << std::hex << regions.at(i).first
+              << "-0x" << region.join_PC << std::dec
+              << ": splits=" << region.splits
+              << ", divergent=" << region.divergent
+              << ", cycles=" << region.cycles
+              << ", instrs=" << region.instrs
+              << ", SIMT efficiency=" << (region.instrs ? (region.threads * 100 / (region.instrs * arch_.num_threads())) : 0) << "%"
+              << std::endl;
+  }
+#endif
 }
 
 void Core::reset() {
@@ -175,6 +206,11 @@ void Core::reset() {
   fetch_latch_.clear();
   decode_latch_.clear();
   pending_icache_.clear();
+  fetch_warps_.reset();
+  compact_groups_.clear();
+  // divergent regions accumulate over all launches, only the IPDOM stacks restart
+  simt_stacks_.assign(arch_.num_warps(), std::vector<Word>());
+  divergent_warps_ = 0;
 
   ibuffer_idx_ = 0;
   pending_instrs_ = 0;
@@ -184,6 +220,16 @@ void Core::reset() {
 }
 
 void Core::tick() {
+  if (divergent_warps_ != 0) {
+    // account time spent inside divergent regions
+    for (auto& stack : simt_stacks_) {
+      if (!stack.empty()) {
+        ++simt_regions_.at(stack.back()).cycles;
+      }
+    }
+    ++perf_stats_.divergent_cycles;
+  }
+
   this->commit();
   this->execute();
   this->issue();
@@ -202,8 +248,30 @@ void Core::schedule() {
     return;
   }
 
+  if (profiler_) {
+    profiler_->issue(trace);
+  }
+  if (timeline_) {
+    trace->sched_cycle = SimPlatform::instance().cycles();
+  }
+
+  auto active_threads = trace->tmask.count();
+  ++perf_stats_.warp_instrs;
+  perf_stats_.warp_threads += active_threads;
+  ++perf_stats_.lanes_hist[(active_threads * LANES_BINS - 1) / arch_.num_threads()];
+  auto& simt_stack = simt_stacks_.at(trace->wid);
+  if (!simt_stack.empty()) {
+    auto& region = simt_regions_.at(simt_stack.back());
+    ++region.instrs;
+    region.threads += active_threads;
+  }
+  if (arch_.compact_window() != 0) {
+    this->compact(trace);
+  }
+
   // suspend warp until decode
   emulator_.suspend(trace->wid);
+  fetch_warps_.set(trace->wid);
 
   DT(3, "pipeline-schedule: " << *trace);
 
@@ -212,6 +280,38 @@ void Core::schedule() {
   ++pending_instrs_;
 }
 
+void Core::compact(const instr_trace_t* trace) {
+  // Dynamic warp compaction study: a divergent warp instruction joins a pending
+  // group of another warp at the same PC if none of its threads overlaps the group's
+  // lanes, since a thread must stay in its register file lane. Each group costs one
+  // issue slot. Groups ignore operand readiness and issue order, so the resulting
+  // count is an upper bound on the achievable compaction, not a measured schedule.
+  auto cycle = perf_stats_.cycles;
+  auto window = arch_.compact_window();
+  for (auto it = compact_groups_.begin(); it != compact_groups_.end();) {
+    if (cycle - it->cycle >= window) {
+      it = compact_groups_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (trace->tmask.count() != arch_.num_threads()) {
+    for (auto& group : compact_groups_) {
+      if (group.PC == trace->PC && group.wid != trace->wid && (group.tmask & trace->tmask).none()) {
+        group.tmask |= trace->tmask;
+        DT(3, "warp-compact: PC=0x" << std::hex << trace->PC << std::dec << ", wid=" << trace->wid << ", threads=" << group.tmask.count());
+        return;
+      }
+    }
+    // track up to one pending group per warp
+    if (compact_groups_.size() >= arch_.num_warps()) {
+      compact_groups_.erase(compact_groups_.begin());
+    }
+    compact_groups_.push_back({trace->PC, trace->tmask, trace->wid, cycle});
+  }
+  ++perf_stats_.compact_instrs;
+}
+
 void Core::fetch() {
   perf_stats_.ifetch_latency += pending_ifetches_;
 
@@ -257,6 +357,9 @@ void Core::decode() {
       DT(4, "*** ibuffer-stall: " << *trace);
     }
     ++perf_stats_.ibuf_stalls;
+    if (profiler_) {
+      profiler_->ibuf_stall(trace->PC);
+    }
     return;
   } else {
     trace->log_once(false);
@@ -270,34 +373,45 @@ void Core::decode() {
   DT(3, "pipeline-decode: " << *trace);
 
   // insert to ibuffer
+  if (timeline_) {
+    trace->decode_cycle = SimPlatform::instance().cycles();
+  }
   ibuffer.push(trace);
+  fetch_warps_.reset(trace->wid);
 
   decode_latch_.pop();
 }
 
 void Core::issue() {
   // operands to dispatchers
+  bool dispatch_stalls[ISSUE_WIDTH] = {};
   for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
     auto& operand = operands_.at(i);
     if (operand->Output.empty())
       continue;
     auto trace = operand->Output.front();
     if (dispatchers_.at((int)trace->fu_type)->push(i, trace)) {
+      if (timeline_) {
+        trace->dispatch_cycle = SimPlatform::instance().cycles();
+      }
       operand->Output.pop();
       trace->log_once(false);
     } else {
       if (!trace->log_once(true)) {
         DT(4, "*** dispatch-stall: " << *trace);
       }
+      dispatch_stalls[i] = true;
     }
   }
 
   // issue ibuffer instructions
+  uint32_t per_issue_warps = arch_.num_warps() / ISSUE_WIDTH;
   for (uint32_t i = 0; i < ISSUE_WIDTH; ++i) {
     bool has_instrs = false;
     bool found_match = false;
-    for (uint32_t w = 0; w < PER_ISSUE_WARPS; ++w) {
-      uint32_t kk = (ibuffer_idx_ + w) % PER_ISSUE_WARPS;
+    FUType stall_fu = FUType::Count;
+    for (uint32_t w = 0; w < per_issue_warps; ++w) {
+      uint32_t kk = (ibuffer_idx_ + w) % per_issue_warps;
       uint32_t ii = kk * ISSUE_WIDTH + i;
       auto& ibuffer = ibuffers_.at(ii);
       if (ibuffer.empty())
@@ -307,6 +421,9 @@ void Core::issue() {
       auto trace = ibuffer.top();
       if (scoreboard_.in_use(trace)) {
         auto uses = scoreboard_.get_uses(trace);
+        if (stall_fu == FUType::Count) {
+          stall_fu = uses.at(0).fu_type;
+        }
         if (!trace->log_once(true)) {
           DTH(4, "*** scoreboard-stall: dependents={");
           for (uint32_t j = 0, n = uses.size(); j < n; ++j) {
@@ -319,8 +436,12 @@ void Core::issue() {
         }
         for (uint32_t j = 0, n = uses.size(); j < n; ++j) {
           auto& use = uses.at(j);
+          if (profiler_) {
+            profiler_->scrb_stall(trace->PC, use.fu_type);
+          }
           switch (use.fu_type) {
-          case FUType::ALU: ++perf_stats_.scrb_alu; break;
+          case FUType::ALU:
+          case FUType::SALU: ++perf_stats_.scrb_alu; break;
           case FUType::FPU: ++perf_stats_.scrb_fpu; break;
           case FUType::LSU: ++perf_stats_.scrb_lsu; break;
           case FUType::SFU: {
@@ -346,12 +467,19 @@ void Core::issue() {
         }
       } else {
         trace->log_once(false);
+        // route warp-uniform ALU operations to the scalar unit
+        if (trace->uniform && trace->fu_type == FUType::ALU && arch_.salu_enabled()) {
+          trace->fu_type = FUType::SALU;
+        }
         // update scoreboard
         DT(3, "pipeline-scoreboard: " << *trace);
         if (trace->wb) {
           scoreboard_.reserve(trace);
         }
         // to operand stage
+        if (timeline_) {
+          trace->issue_cycle = SimPlatform::instance().cycles();
+        }
         operands_.at(i)->Input.push(trace, 2);
         ibuffer.pop();
         found_match = true;
@@ -361,10 +489,49 @@ void Core::issue() {
     if (has_instrs && !found_match) {
       ++perf_stats_.scrb_stalls;
     }
+    // CPI stack accounting
+    auto cpi = CpiStack::Base;
+    if (!found_match) {
+      if (has_instrs) {
+        // blocked on a dependency, or on its producer being unable to dispatch
+        if (dispatch_stalls[i]) {
+          cpi = CpiStack::Struct;
+        } else {
+          switch (stall_fu) {
+          case FUType::LSU: cpi = CpiStack::Memory; break;
+          case FUType::FPU: cpi = CpiStack::FPU; break;
+          case FUType::SFU: cpi = CpiStack::SFU; break;
+          default: cpi = CpiStack::ALU; break;
+          }
+        }
+      } else {
+        cpi = this->cpi_frontend(i);
+      }
+    }
+    ++perf_stats_.cpi_stack[(int)cpi];
   }
   ++ibuffer_idx_;
 }
 
+Core::CpiStack Core::cpi_frontend(uint32_t issue_slot) const {
+  // the slot's instruction buffers are empty: charge the warp closest to issue
+  auto cpi = CpiStack::Idle;
+  for (uint32_t wid = issue_slot; wid < arch_.num_warps(); wid += ISSUE_WIDTH) {
+    if (!emulator_.warp_active(wid))
+      continue;
+    if (fetch_warps_.test(wid) || emulator_.warp_ready(wid))
+      return CpiStack::ICache;
+    if (emulator_.warp_at_barrier(wid)) {
+      if (cpi == CpiStack::Idle) {
+        cpi = CpiStack::Barrier;
+      }
+    } else {
+      cpi = CpiStack::WCtl;
+    }
+  }
+  return cpi;
+}
+
 void Core::execute() {
   for (uint32_t i = 0; i < (uint32_t)FUType::Count; ++i) {
     auto& dispatch = dispatchers_.at(i);
@@ -391,6 +558,9 @@ void Core::commit() {
     DT(3, "pipeline-commit: " << *trace);
     assert(trace->cid == core_id_);
 
+    // register file writeback
+    operands_.at(i)->writeback(trace);
+
     // update scoreboard
     if (trace->eop) {
       if (trace->wb) {
@@ -400,6 +570,16 @@ void Core::commit() {
       --pending_instrs_;
 
       perf_stats_.instrs += trace->tmask.count();
+      if (trace->uniform) {
+        perf_stats_.uniform_instrs += trace->tmask.count();
+      }
+      if (trace->fu_type == FUType::SALU) {
+        perf_stats_.salu_instrs += trace->tmask.count();
+      }
+
+      if (timeline_) {
+        timeline_->instr(*trace, SimPlatform::instance().cycles());
+      }
     }
 
     perf_stats_.opds_stalls = 0;
@@ -414,6 +594,38 @@ void Core::commit() {
   }
 }
 
+void Core::simt_split(uint32_t wid, Word PC, bool divergent, uint32_t ipdom_depth) {
+  auto& region = simt_regions_[PC];
+  ++region.splits;
+  ++perf_stats_.splits;
+  if (profiler_) {
+    profiler_->split(PC, divergent);
+  }
+  if (divergent) {
+    ++region.divergent;
+    ++perf_stats_.divergent_splits;
+    auto& stack = simt_stacks_.at(wid);
+    if (stack.empty()) {
+      ++divergent_warps_;
+    }
+    stack.push_back(PC);
+  }
+  perf_stats_.ipdom_depth = std::max<uint64_t>(perf_stats_.ipdom_depth, ipdom_depth);
+}
+
+void Core::simt_join(uint32_t wid, Word PC, bool reconverged) {
+  ++perf_stats_.joins;
+  if (!reconverged)
+    return;
+  auto& stack = simt_stacks_.at(wid);
+  assert(!stack.empty());
+  simt_regions_.at(stack.back()).join_PC = PC;
+  stack.pop_back();
+  if (stack.empty()) {
+    --divergent_warps_;
+  }
+}
+
 int Core::get_exitcode() const {
   return emulator_.get_exitcode();
 }
@@ -426,6 +638,10 @@ void Core::resume(uint32_t wid) {
   emulator_.resume(wid);
 }
 
+void Core::perf_region(uint32_t id, bool begin) {
+  socket_->cluster()->processor()->perf_region(id, begin);
+}
+
 bool Core::barrier(uint32_t bar_id, uint32_t count, uint32_t wid) {
   return emulator_.barrier(bar_id, count, wid);
 }
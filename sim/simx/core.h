@@ -14,6 +14,7 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include <simobject.h>
 #include "types.h"
 #include "emulator.h"
@@ -26,6 +27,8 @@
 #include "dispatcher.h"
 #include "func_unit.h"
 #include "mem_coalescer.h"
+#include "profiler.h"
+#include "timeline.h"
 
 namespace vortex {
 
@@ -37,6 +40,23 @@ using TraceSwitch = Mux<instr_trace_t*>;
 
 class Core : public SimObject<Core> {
 public:
+  static constexpr uint32_t LANES_BINS = 8;
+
+  // CPI stack: each issue slot cycle is attributed to exactly one category
+  enum class CpiStack {
+    Base,    // a warp instruction issued
+    ICache,  // warps in instruction fetch
+    Memory,  // scoreboard wait on a load (dcache/local memory latency)
+    Struct,  // functional unit busy (dispatch stall)
+    ALU,     // scoreboard wait on an ALU result
+    FPU,     // scoreboard wait on an FPU result
+    SFU,     // scoreboard wait on an SFU result
+    Barrier, // warps waiting at a barrier
+    WCtl,    // warps waiting for a branch or warp control to resolve
+    Idle,    // no active warps
+    Count
+  };
+
   struct PerfStats {
     uint64_t cycles;
     uint64_t instrs;
@@ -59,6 +79,18 @@ public:
     uint64_t stores;
     uint64_t ifetch_latency;
     uint64_t load_latency;
+    uint64_t uniform_instrs;
+    uint64_t salu_instrs;
+    uint64_t warp_instrs;
+    uint64_t warp_threads;
+    uint64_t compact_instrs;
+    uint64_t lanes_hist[LANES_BINS]; // issued warp instructions by active lanes (eighths of the warp)
+    uint64_t splits;
+    uint64_t divergent_splits;
+    uint64_t joins;
+    uint64_t ipdom_depth;            // maximum IPDOM stack depth
+    uint64_t divergent_cycles;       // cycles with at least one divergent warp
+    uint64_t cpi_stack[(int)CpiStack::Count]; // issue slot cycles by category
 
     PerfStats()
       : cycles(0)
@@ -82,6 +114,18 @@ public:
       , stores(0)
       , ifetch_latency(0)
       , load_latency(0)
+      , uniform_instrs(0)
+      , salu_instrs(0)
+      , warp_instrs(0)
+      , warp_threads(0)
+      , compact_instrs(0)
+      , lanes_hist{}
+      , splits(0)
+      , divergent_splits(0)
+      , joins(0)
+      , ipdom_depth(0)
+      , divergent_cycles(0)
+      , cpi_stack{}
     {}
   };
 
@@ -116,6 +160,12 @@ public:
 
   bool wspawn(uint32_t num_warps, Word nextPC);
 
+  void simt_split(uint32_t wid, Word PC, bool divergent, uint32_t ipdom_depth);
+
+  void simt_join(uint32_t wid, Word PC, bool reconverged);
+
+  void perf_region(uint32_t id, bool begin);
+
   uint32_t id() const {
     return core_id_;
   }
@@ -159,6 +209,10 @@ private:
   void execute();
   void commit();
 
+  void compact(const instr_trace_t* trace);
+
+  CpiStack cpi_frontend(uint32_t issue_slot) const;
+
   uint32_t core_id_;
   Socket* socket_;
   const Arch& arch_;
@@ -188,10 +242,37 @@ private:
 
   uint64_t pending_ifetches_;
 
+  WarpMask fetch_warps_;
+
   PerfStats perf_stats_;
 
+  Profiler* profiler_;
+
+  Timeline* timeline_;
+
   std::vector<TraceSwitch::Ptr> commit_arbs_;
 
+  struct compact_group_t {
+    Word       PC;
+    ThreadMask tmask;
+    uint32_t   wid;
+    uint64_t   cycle;
+  };
+  std::vector<compact_group_t> compact_groups_;
+
+  // divergent regions, keyed by the PC of their split
+  struct simt_region_t {
+    Word     join_PC;
+    uint64_t splits;
+    uint64_t divergent;
+    uint64_t cycles;   // warp cycles spent inside the region
+    uint64_t instrs;
+    uint64_t threads;
+  };
+  std::unordered_map<Word, simt_region_t> simt_regions_;
+  std::vector<std::vector<Word>> simt_stacks_;
+  uint32_t divergent_warps_;
+
   uint32_t commit_exe_;
   uint32_t ibuffer_idx_;
 
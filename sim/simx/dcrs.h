@@ -22,6 +22,10 @@ namespace vortex {
 
 class BaseDCRS {
 public:
+  BaseDCRS() {
+    states_.fill(0);
+  }
+
   uint32_t read(uint32_t addr) const {
     uint32_t state = VX_DCR_BASE_STATE(addr);
     return states_.at(state);
@@ -65,14 +65,40 @@
 } while(0)
 
 
+#define DSCOPE(cid, wid, PC) do {} while(0)
+
 #else
 
-#define DP(lvl, x) do {} while(0)
-#define DPH(lvl, x) do {} while(0)
-#define DPN(lvl, x) do {} while(0)
+// release builds trace at runtime through the tracer (see tracer.h),
+// which keeps the level at -1 unless tracing is enabled and in range
+
+#include <iostream>
+#include <iomanip>
+#include "tracer.h"
+
+#define DTRACE_BEGIN(lvl, kind, x, close) do { \
+  if (__builtin_expect((lvl) <= vortex::Tracer::level, 0)) { \
+    vortex::Tracer::begin(vortex::Tracer::kind) << x; \
+    vortex::Tracer::close(); \
+  } \
+} while(0)
+
+#define DTRACE_APPEND(lvl, x) do { \
+  if (__builtin_expect((lvl) <= vortex::Tracer::level, 0)) { \
+    vortex::Tracer::append() << x; \
+    vortex::Tracer::end_line(); \
+  } \
+} while(0)
+
+#define DP(lvl, x)  DTRACE_BEGIN(lvl, Debug, x, end)
+#define DPH(lvl, x) DTRACE_BEGIN(lvl, Debug, x, end_line)
+#define DPN(lvl, x) DTRACE_APPEND(lvl, x)
+
+#define DT(lvl, x)  DTRACE_BEGIN(lvl, Trace, x, end)
+#define DTH(lvl, x) DTRACE_BEGIN(lvl, Trace, x, end_line)
+#define DTN(lvl, x) DTRACE_APPEND(lvl, x)
 
-#define DT(lvl, x) do {} while(0)
-#define DTH(lvl, x) do {} while(0)
-#define DTN(lvl, x) do {} while(0)
+// instruction context of the records emitted within the current block
+#define DSCOPE(cid, wid, PC) vortex::Tracer::Scope __trace_scope(cid, wid, PC)
 
 #endif
\ No newline at end of file
@@ -139,6 +139,7 @@ void Emulator::clear() {
   csr_mscratch_ = startup_arg;
 
   stalled_warps_.reset();
+  barrier_warps_.reset();
   active_warps_.reset();
 
   // activate first warp and thread
@@ -188,13 +189,12 @@ instr_trace_t* Emulator::step() {
   auto& warp = warps_.at(scheduled_warp);
   assert(warp.tmask.any());
 
-#ifndef NDEBUG
+  // unique instruction id, also used by the timeline trace in release builds
   uint32_t instr_uuid = warp.uuid++;
   uint32_t g_wid = core_->id() * arch_.num_warps() + scheduled_warp;
   uint64_t uuid = (uint64_t(g_wid) << 32) | instr_uuid;
-#else
-  uint64_t uuid = 0;
-#endif
+
+  DSCOPE(core_->id(), scheduled_warp, warp.PC);
 
   DPH(1, "Fetch: cid=" << core_->id() << ", wid=" << scheduled_warp << ", tmask=");
   for (uint32_t i = 0, n = arch_.num_threads(); i < n; ++i)
@@ -255,11 +255,25 @@ void Emulator::resume(uint32_t wid) {
   if (wid != 0xffffffff) {
     assert(stalled_warps_.test(wid));
     stalled_warps_.reset(wid);
+    barrier_warps_.reset(wid);
   } else {
     stalled_warps_.reset();
+    barrier_warps_.reset();
   }
 }
 
+bool Emulator::warp_active(uint32_t wid) const {
+  return active_warps_.test(wid);
+}
+
+bool Emulator::warp_ready(uint32_t wid) const {
+  return active_warps_.test(wid) && !stalled_warps_.test(wid);
+}
+
+bool Emulator::warp_at_barrier(uint32_t wid) const {
+  return barrier_warps_.test(wid);
+}
+
 bool Emulator::wspawn(uint32_t num_warps, Word nextPC) {
   num_warps = std::min<uint32_t>(num_warps, arch_.num_warps());
   if (num_warps < 2 && active_warps_.count() == 1)
@@ -279,6 +293,7 @@ bool Emulator::barrier(uint32_t bar_id, uint32_t count, uint32_t wid) {
 
   auto& barrier = barriers_.at(bar_idx);
   barrier.set(wid);
+  barrier_warps_.set(wid);
   DP(3, "*** Suspend core #" << core_->id() << ", warp #" << wid << " at barrier #" << bar_idx);
 
   if (is_global) {
@@ -295,6 +310,7 @@ bool Emulator::barrier(uint32_t bar_id, uint32_t count, uint32_t wid) {
         if (barrier.test(i)) {
           DP(3, "*** Resume core #" << core_->id() << ", warp #" << i << " at barrier #" << bar_idx);
           stalled_warps_.reset(i);
+          barrier_warps_.reset(i);
         }
       }
       barrier.reset();
@@ -394,6 +410,8 @@ Word Emulator::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
   case VX_CSR_MEPC:
   case VX_CSR_MNSTATUS:
   case VX_CSR_MCAUSE:
+  case VX_CSR_MPM_REGION_BEGIN:
+  case VX_CSR_MPM_REGION_END:
     return 0;
 
   case VX_CSR_FFLAGS:     return warps_.at(wid).fcsr & 0x1F;
@@ -438,13 +456,20 @@ Word Emulator::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
         CSR_READ_64(VX_CSR_MPM_STORES, core_perf.stores);
         CSR_READ_64(VX_CSR_MPM_IFETCH_LT, core_perf.ifetch_latency);
         CSR_READ_64(VX_CSR_MPM_LOAD_LT, core_perf.load_latency);
+        CSR_READ_64(VX_CSR_MPM_UNIFORM, core_perf.uniform_instrs);
+        CSR_READ_64(VX_CSR_MPM_SALU, core_perf.salu_instrs);
+        CSR_READ_64(VX_CSR_MPM_WARP_INSTRS, core_perf.warp_instrs);
+        CSR_READ_64(VX_CSR_MPM_WARP_THREADS, core_perf.warp_threads);
+        CSR_READ_64(VX_CSR_MPM_COMPACT_INSTRS, core_perf.compact_instrs);
         }
       } break;
       case VX_DCR_MPM_CLASS_MEM: {
-        auto proc_perf = core_->socket()->cluster()->processor()->perf_stats();
+        auto& proc_perf = core_->socket()->cluster()->processor()->perf_stats();
         auto cluster_perf = core_->socket()->cluster()->perf_stats();
         auto socket_perf = core_->socket()->perf_stats();
         auto lmem_perf = core_->local_mem()->perf_stats();
+        uint64_t amo_reqs = proc_perf.l2cache.atomics + proc_perf.l3cache.atomics;
+        uint64_t amo_stalls = proc_perf.l2cache.atomic_stalls + proc_perf.l3cache.atomic_stalls;
         switch (addr) {
         CSR_READ_64(VX_CSR_MPM_ICACHE_READS, socket_perf.icache.reads);
         CSR_READ_64(VX_CSR_MPM_ICACHE_MISS_R, socket_perf.icache.read_misses);
@@ -478,6 +503,89 @@ Word Emulator::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
         CSR_READ_64(VX_CSR_MPM_LMEM_READS, lmem_perf.reads);
         CSR_READ_64(VX_CSR_MPM_LMEM_WRITES, lmem_perf.writes);
         CSR_READ_64(VX_CSR_MPM_LMEM_BANK_ST, lmem_perf.bank_stalls);
+
+        CSR_READ_64(VX_CSR_MPM_AMO_REQS, amo_reqs);
+        CSR_READ_64(VX_CSR_MPM_AMO_ST, amo_stalls);
+        }
+      } break;
+      case VX_DCR_MPM_CLASS_DRAM: {
+        auto& proc_perf = core_->socket()->cluster()->processor()->perf_stats();
+        auto& dram_perf = proc_perf.memsim;
+        auto channel_bytes = [&](uint32_t channel)->uint64_t {
+          if (channel >= proc_perf.mem_channels.size())
+            return 0;
+          auto& perf = proc_perf.mem_channels.at(channel);
+          return (perf.reads + perf.writes) * MEM_BLOCK_SIZE;
+        };
+        switch (addr) {
+        CSR_READ_64(VX_CSR_MPM_DRAM_CHANNELS, proc_perf.mem_channels.size());
+        CSR_READ_64(VX_CSR_MPM_DRAM_READS, dram_perf.reads);
+        CSR_READ_64(VX_CSR_MPM_DRAM_WRITES, dram_perf.writes);
+        CSR_READ_64(VX_CSR_MPM_DRAM_TURNS, dram_perf.turnarounds);
+        CSR_READ_64(VX_CSR_MPM_DRAM_QUEUE_LT, dram_perf.queue_latency);
+
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+0, dram_perf.latency_hist[0]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+1, dram_perf.latency_hist[1]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+2, dram_perf.latency_hist[2]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+3, dram_perf.latency_hist[3]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+4, dram_perf.latency_hist[4]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+5, dram_perf.latency_hist[5]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+6, dram_perf.latency_hist[6]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_LAT_HIST+7, dram_perf.latency_hist[7]);
+
+        CSR_READ_64(VX_CSR_MPM_DRAM_QUEUE_HIST+0, dram_perf.queue_hist[0]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_QUEUE_HIST+1, dram_perf.queue_hist[1]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_QUEUE_HIST+2, dram_perf.queue_hist[2]);
+        CSR_READ_64(VX_CSR_MPM_DRAM_QUEUE_HIST+3, dram_perf.queue_hist[3]);
+
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+0, channel_bytes(0));
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+1, channel_bytes(1));
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+2, channel_bytes(2));
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+3, channel_bytes(3));
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+4, channel_bytes(4));
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+5, channel_bytes(5));
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+6, channel_bytes(6));
+        CSR_READ_64(VX_CSR_MPM_DRAM_CH_BYTES+7, channel_bytes(7));
+        default:
+          return 0;
+        }
+      } break;
+      case VX_DCR_MPM_CLASS_SIMT: {
+        switch (addr) {
+        CSR_READ_64(VX_CSR_MPM_SIMT_INSTRS, core_perf.warp_instrs);
+        CSR_READ_64(VX_CSR_MPM_SIMT_THREADS, core_perf.warp_threads);
+        CSR_READ_64(VX_CSR_MPM_SIMT_SPLITS, core_perf.splits);
+        CSR_READ_64(VX_CSR_MPM_SIMT_DIV_SPLITS, core_perf.divergent_splits);
+        CSR_READ_64(VX_CSR_MPM_SIMT_JOINS, core_perf.joins);
+        CSR_READ_64(VX_CSR_MPM_SIMT_DEPTH, core_perf.ipdom_depth);
+        CSR_READ_64(VX_CSR_MPM_SIMT_DIV_CYCLES, core_perf.divergent_cycles);
+
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+0, core_perf.lanes_hist[0]);
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+1, core_perf.lanes_hist[1]);
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+2, core_perf.lanes_hist[2]);
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+3, core_perf.lanes_hist[3]);
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+4, core_perf.lanes_hist[4]);
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+5, core_perf.lanes_hist[5]);
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+6, core_perf.lanes_hist[6]);
+        CSR_READ_64(VX_CSR_MPM_SIMT_LANES_HIST+7, core_perf.lanes_hist[7]);
+        default:
+          return 0;
+        }
+      } break;
+      case VX_DCR_MPM_CLASS_CPI: {
+        switch (addr) {
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+0, core_perf.cpi_stack[0]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+1, core_perf.cpi_stack[1]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+2, core_perf.cpi_stack[2]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+3, core_perf.cpi_stack[3]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+4, core_perf.cpi_stack[4]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+5, core_perf.cpi_stack[5]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+6, core_perf.cpi_stack[6]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+7, core_perf.cpi_stack[7]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+8, core_perf.cpi_stack[8]);
+        CSR_READ_64(VX_CSR_MPM_CPI_STACK+9, core_perf.cpi_stack[9]);
+        default:
+          return 0;
         }
       } break;
       case VX_DCR_MPM_CLASS_TEX: {
@@ -512,6 +620,10 @@ Word Emulator::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
         CSR_READ_64(VX_CSR_MPM_RCACHE_MISS_R, cluster_perf.rcache.read_misses);
         CSR_READ_64(VX_CSR_MPM_RCACHE_BANK_ST, cluster_perf.rcache.bank_stalls);
         CSR_READ_64(VX_CSR_MPM_RCACHE_MSHR_ST, cluster_perf.rcache.mshr_stalls);
+
+        CSR_READ_64(VX_CSR_MPM_RASTER_STAMPS, raster_perf_stats.stamps);
+        CSR_READ_64(VX_CSR_MPM_RASTER_HIZ_TILES, raster_perf_stats.hiz_tiles);
+        CSR_READ_64(VX_CSR_MPM_RASTER_HIZ_STAMPS, raster_perf_stats.hiz_stamps);
         default:
           return 0;
         }
@@ -534,6 +646,9 @@ Word Emulator::get_csr(uint32_t addr, uint32_t tid, uint32_t wid) {
         CSR_READ_64(VX_CSR_MPM_OCACHE_MISS_W, cluster_perf.ocache.write_misses);
         CSR_READ_64(VX_CSR_MPM_OCACHE_BANK_ST, cluster_perf.ocache.bank_stalls);
         CSR_READ_64(VX_CSR_MPM_OCACHE_MSHR_ST, cluster_perf.ocache.mshr_stalls);
+
+        CSR_READ_64(VX_CSR_MPM_OM_IMM_READS, om_perf_stats.imm_reads);
+        CSR_READ_64(VX_CSR_MPM_OM_IMM_WRITES, om_perf_stats.imm_writes);
         default:
           return 0;
         }
@@ -585,6 +700,18 @@ void Emulator::set_csr(uint32_t addr, Word value, uint32_t tid, uint32_t wid) {
   case VX_CSR_MNSTATUS:
   case VX_CSR_MCAUSE:
     break;
+  case VX_CSR_MPM_REGION_BEGIN:
+  case VX_CSR_MPM_REGION_END: {
+    // one marker per warp, taken by its first active thread
+    auto& tmask = warps_.at(wid).tmask;
+    uint32_t first_tid = 0;
+    while (!tmask.test(first_tid)) {
+      ++first_tid;
+    }
+    if (tid == first_tid) {
+      core_->perf_region(value, addr == VX_CSR_MPM_REGION_BEGIN);
+    }
+  } break;
   default:
   #ifdef EXT_OM_ENABLE
     if (addr >= VX_CSR_OM_BEGIN
@@ -57,6 +57,13 @@ public:
 
   int get_exitcode() const;
 
+  // warp scheduling state, for CPI stack accounting
+  bool warp_active(uint32_t wid) const;
+
+  bool warp_ready(uint32_t wid) const;
+
+  bool warp_at_barrier(uint32_t wid) const;
+
 private:
 
   struct ipdom_entry_t {
@@ -126,6 +133,7 @@ private:
   std::vector<warp_t> warps_;
   WarpMask    active_warps_;
   WarpMask    stalled_warps_;
+  WarpMask    barrier_warps_;
   std::vector<WarpMask> barriers_;
   std::unordered_map<int, std::stringstream> print_bufs_;
   MemoryUnit  mmu_;
@@ -134,6 +134,37 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     }
   }
 
+  // integer ALU operations whose source operands are identical across the active
+  // threads are warp-uniform: execute them once and broadcast the result
+  bool uniform = false;
+  switch (opcode) {
+  case Opcode::LUI:
+  case Opcode::AUIPC:
+  case Opcode::R:
+  case Opcode::I:
+  case Opcode::R_W:
+  case Opcode::I_W:
+  case Opcode::B:
+  case Opcode::JAL:
+  case Opcode::JALR:
+    uniform = true;
+    for (uint32_t i = 0; i < num_rsrcs && uniform; ++i) {
+      if (instr.getRSType(i) != RegType::Integer)
+        continue;
+      for (uint32_t t = thread_start + 1; t < num_threads; ++t) {
+        if (warp.tmask.test(t) && rsdata[t][i].u != rsdata[thread_start][i].u) {
+          uniform = false;
+          break;
+        }
+      }
+    }
+    break;
+  default:
+    break;
+  }
+  trace->uniform = uniform;
+  uint32_t thread_end = uniform ? (thread_start + 1) : num_threads;
+
   bool rd_write = false;
 
   switch (opcode) {
@@ -141,7 +172,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     // RV32I: LUI
     trace->fu_type = FUType::ALU;
     trace->alu_type = AluType::ARITH;
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       rddata[t].i = immsrc;
@@ -153,7 +184,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     // RV32I: AUIPC
     trace->fu_type = FUType::ALU;
     trace->alu_type = AluType::ARITH;
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       rddata[t].i = immsrc + warp.PC;
@@ -166,7 +197,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     trace->alu_type = AluType::ARITH;
     trace->src_regs[0] = {RegType::Integer, rsrc0};
     trace->src_regs[1] = {RegType::Integer, rsrc1};
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       if (func7 == 0x7) {
@@ -342,7 +373,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     trace->fu_type = FUType::ALU;
     trace->alu_type = AluType::ARITH;
     trace->src_regs[0] = {RegType::Integer, rsrc0};
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       switch (func3) {
@@ -403,7 +434,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     trace->alu_type = AluType::ARITH;
     trace->src_regs[0] = {RegType::Integer, rsrc0};
     trace->src_regs[1] = {RegType::Integer, rsrc1};
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       if (func7 & 0x1) {
@@ -529,7 +560,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     trace->fu_type = FUType::ALU;
     trace->alu_type = AluType::ARITH;
     trace->src_regs[0] = {RegType::Integer, rsrc0};
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       switch (func3) {
@@ -574,7 +605,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     trace->src_regs[0] = {RegType::Integer, rsrc0};
     trace->src_regs[1] = {RegType::Integer, rsrc1};
     bool all_taken = false;
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       bool curr_taken = false;
@@ -646,7 +677,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     // RV32I: JAL
     trace->fu_type = FUType::ALU;
     trace->alu_type = AluType::BRANCH;
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       rddata[t].i = next_pc;
@@ -661,7 +692,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
     trace->fu_type = FUType::ALU;
     trace->alu_type = AluType::BRANCH;
     trace->src_regs[0] = {RegType::Integer, rsrc0};
-    for (uint32_t t = thread_start; t < num_threads; ++t) {
+    for (uint32_t t = thread_start; t < thread_end; ++t) {
       if (!warp.tmask.test(t))
         continue;
       rddata[t].i = next_pc;
@@ -746,7 +777,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
   }
   case Opcode::AMO: {
     trace->fu_type = FUType::LSU;
-    trace->lsu_type = LsuType::LOAD;
+    trace->lsu_type = LsuType::AMO;
     trace->src_regs[0] = {RegType::Integer, rsrc0};
     trace->src_regs[1] = {RegType::Integer, rsrc1};
     auto trace_data = std::make_shared<LsuTraceData>(num_threads);
@@ -1354,6 +1385,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
           auto ntaken_tmask = ~next_tmask & warp.tmask;
           warp.ipdom_stack.emplace(ntaken_tmask, next_pc);
         }
+        core_->simt_split(wid, warp.PC, is_divergent, warp.ipdom_stack.size());
         // return divergent state
         for (uint32_t t = thread_start; t < num_threads; ++t) {
           rddata[t].i = stack_size;
@@ -1368,6 +1400,7 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
         trace->fetch_stall = true;
 
         auto stack_ptr = warp.ireg_file.at(thread_last).at(rsrc0);
+        bool reconverged = false;
         if (stack_ptr != warp.ipdom_stack.size()) {
           if (warp.ipdom_stack.empty()) {
             std::cout << "IPDOM stack is empty!\n" << std::flush;
@@ -1377,8 +1410,10 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
           if (!warp.ipdom_stack.top().fallthrough) {
             next_pc = warp.ipdom_stack.top().PC;
           }
+          reconverged = warp.ipdom_stack.top().fallthrough;
           warp.ipdom_stack.pop();
         }
+        core_->simt_join(wid, warp.PC, reconverged);
       } break;
       case 4: {
         // BAR
@@ -1476,6 +1511,8 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
         auto trace_data = std::make_shared<OMUnit::TraceData>();
         trace->data = trace_data;
         trace_data->om_idx = this->om_idx();
+        trace_data->cid    = core_->id();
+        trace_data->uuid   = trace->uuid;
         for (uint32_t t = thread_start; t < num_threads; ++t) {
           if (!warp.tmask.test(t))
             continue;
@@ -1503,6 +1540,11 @@ void Emulator::execute(const Instr &instr, uint32_t wid, instr_trace_t *trace) {
 
   if (rd_write) {
     trace->wb = true;
+    if (uniform) {
+      for (uint32_t t = thread_start + 1; t < num_threads; ++t) {
+        rddata[t] = rddata[thread_start];
+      }
+    }
     auto type = instr.getRDType();
     switch (type) {
     case RegType::Integer:
@@ -24,7 +24,7 @@
 
 using namespace vortex;
 
-AluUnit::AluUnit(const SimContext& ctx, Core* core) : FuncUnit(ctx, core, "alu-unit") {}
+AluUnit::AluUnit(const SimContext& ctx, Core* core, const char* name) : FuncUnit(ctx, core, name) {}
 
 void AluUnit::tick() {
   for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
@@ -41,7 +41,7 @@ void AluUnit::tick() {
 			output.push(trace, 2+delay);
 			break;
 		case AluType::IMUL:
-			output.push(trace, LATENCY_IMUL+delay);
+			output.push(trace, core_->arch().latency_imul()+delay);
 			break;
 		case AluType::IDIV:
 			output.push(trace, XLEN+delay);
@@ -74,16 +74,16 @@ void FpuUnit::tick() {
 			output.push(trace, 2+delay);
 			break;
 		case FpuType::FMA:
-			output.push(trace, LATENCY_FMA+delay);
+			output.push(trace, core_->arch().latency_fma()+delay);
 			break;
 		case FpuType::FDIV:
-			output.push(trace, LATENCY_FDIV+delay);
+			output.push(trace, core_->arch().latency_fdiv()+delay);
 			break;
 		case FpuType::FSQRT:
-			output.push(trace, LATENCY_FSQRT+delay);
+			output.push(trace, core_->arch().latency_fsqrt()+delay);
 			break;
 		case FpuType::FCVT:
-			output.push(trace, LATENCY_FCVT+delay);
+			output.push(trace, core_->arch().latency_fcvt()+delay);
 			break;
 		default:
 			std::abort();
@@ -126,6 +126,9 @@ void LsuUnit::tick() {
 		assert(!entry.mask.none());
 		entry.mask &= ~lsu_rsp.mask; // track remaining
 		if (entry.mask.none()) {
+			if (core_->profiler_) {
+				core_->profiler_->load(trace->PC, SimPlatform::instance().cycles() - entry.cycle);
+			}
 			// whole response received, release trace
 			int iw = trace->wid % ISSUE_WIDTH;
 			Outputs.at(iw).push(trace, 1);
@@ -180,6 +183,7 @@ void LsuUnit::tick() {
 		// build memory request
 		LsuReq lsu_req(NUM_LSU_LANES);
 		lsu_req.write = is_write;
+		lsu_req.atomic = (trace->lsu_type == LsuType::AMO);
 		{
 			auto trace_data = std::dynamic_pointer_cast<LsuTraceData>(trace->data);
 			auto t0 = trace->pid * NUM_LSU_LANES;
@@ -192,7 +196,7 @@ void LsuUnit::tick() {
 		}
 		uint32_t tag = 0;
 		if (!is_write) {
-			tag = state.pending_rd_reqs.allocate({trace, lsu_req.mask});
+			tag = state.pending_rd_reqs.allocate({trace, lsu_req.mask, SimPlatform::instance().cycles()});
 		}
 		lsu_req.tag  = tag;
 		lsu_req.cid  = trace->cid;
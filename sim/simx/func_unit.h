@@ -50,7 +50,7 @@ protected:
 
 class AluUnit : public FuncUnit {
 public:
-  AluUnit(const SimContext& ctx, Core*);
+  AluUnit(const SimContext& ctx, Core*, const char* name = "alu-unit");
 
   void tick();
 };
@@ -79,6 +79,7 @@ private:
  	struct pending_req_t {
 		instr_trace_t* trace;
 		BitVector<> mask;
+		uint64_t cycle;
 	};
 
 	struct lsu_state_t {
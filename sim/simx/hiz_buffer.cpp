@@ -0,0 +1,155 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hiz_buffer.h"
+#include "mem.h"
+#include <VX_types.h>
+#include <algorithm>
+#include <assert.h>
+
+using namespace vortex;
+
+HiZBuffer::HiZBuffer(bool enabled, uint32_t block_logsize)
+  : enabled_(enabled)
+  , block_logsize_(block_logsize)
+  , mem_(nullptr)
+  , active_(false)
+{}
+
+HiZBuffer::~HiZBuffer() {}
+
+void HiZBuffer::attach_ram(RAM* mem) {
+  mem_ = mem;
+}
+
+void HiZBuffer::configure(const graphics::RasterDCRS& raster_dcrs, const graphics::OMDCRS& om_dcrs) {
+  graphics::DepthTencil depthStencil;
+  depthStencil.configure(om_dcrs);
+
+  auto depth_func = om_dcrs.read(VX_DCR_OM_DEPTH_FUNC);
+  // the driver vouches that fragments keep the primitive's interpolated depth
+  bool hiz_safe = (om_dcrs.read(VX_DCR_OM_DEPTH_WRITEMASK) & VX_OM_DEPTH_HIZ_SAFE) != 0;
+  inclusive_ = (depth_func == VX_OM_DEPTH_FUNC_LEQUAL);
+
+  zbuf_baseaddr_ = uint64_t(om_dcrs.read(VX_DCR_OM_ZBUF_ADDR)) << 6;
+  zbuf_pitch_    = om_dcrs.read(VX_DCR_OM_ZBUF_PITCH);
+
+  scissor_left_  = raster_dcrs.read(VX_DCR_RASTER_SCISSOR_X) & 0xffff;
+  scissor_right_ = raster_dcrs.read(VX_DCR_RASTER_SCISSOR_X) >> 16;
+  scissor_top_   = raster_dcrs.read(VX_DCR_RASTER_SCISSOR_Y) & 0xffff;
+  scissor_bottom_= raster_dcrs.read(VX_DCR_RASTER_SCISSOR_Y) >> 16;
+
+  // the depth buffer may have been rewritten since the last launch
+  entries_.clear();
+
+  active_ = enabled_
+         && hiz_safe
+         && (mem_ != nullptr)
+         && (depth_func == VX_OM_DEPTH_FUNC_LESS || depth_func == VX_OM_DEPTH_FUNC_LEQUAL)
+         && !depthStencil.stencil_enabled(false)
+         && !depthStencil.stencil_enabled(true)
+         && (scissor_right_ > scissor_left_)
+         && (scissor_bottom_ > scissor_top_);
+  if (!active_)
+    return;
+
+  // the raster units only emit pixels inside the scissor rectangle
+  auto block_size = 1u << block_logsize_;
+  width_  = (scissor_right_ + block_size - 1) >> block_logsize_;
+  height_ = (scissor_bottom_ + block_size - 1) >> block_logsize_;
+  entries_.resize(width_ * height_, entry_t{0, 0, false});
+}
+
+HiZBuffer::entry_t& HiZBuffer::fetch(uint32_t bx, uint32_t by) {
+  auto& entry = entries_.at(by * width_ + bx);
+  if (entry.valid)
+    return entry;
+
+  // rebuild the entry from the depth buffer
+  auto x0 = std::max(bx << block_logsize_, scissor_left_);
+  auto y0 = std::max(by << block_logsize_, scissor_top_);
+  auto x1 = std::min((bx + 1) << block_logsize_, scissor_right_);
+  auto y1 = std::min((by + 1) << block_logsize_, scissor_bottom_);
+  entry.zmax  = 0;
+  entry.count = 0;
+  for (uint32_t y = y0; y < y1; ++y) {
+    for (uint32_t x = x0; x < x1; ++x) {
+      uint32_t depthstencil;
+      mem_->read(&depthstencil, zbuf_baseaddr_ + y * zbuf_pitch_ + x * 4, 4);
+      auto depth = depthstencil & VX_OM_DEPTH_MASK;
+      if (depth > entry.zmax) {
+        entry.zmax  = depth;
+        entry.count = 0;
+      }
+      entry.count += (depth == entry.zmax);
+    }
+  }
+  entry.valid = true;
+  return entry;
+}
+
+bool HiZBuffer::occluded(uint32_t x, uint32_t y, uint32_t logsize, uint32_t zmin) {
+  if (!active_)
+    return false;
+
+  uint32_t zmax = 0;
+  if (logsize <= block_logsize_) {
+    auto bx = x >> block_logsize_;
+    auto by = y >> block_logsize_;
+    if (bx >= width_ || by >= height_)
+      return false;
+    zmax = this->fetch(bx, by).zmax;
+  } else {
+    auto bx0 = x >> block_logsize_;
+    auto by0 = y >> block_logsize_;
+    auto bx1 = std::min(bx0 + (1u << (logsize - block_logsize_)), width_);
+    auto by1 = std::min(by0 + (1u << (logsize - block_logsize_)), height_);
+    for (uint32_t by = by0; by < by1; ++by) {
+      for (uint32_t bx = bx0; bx < bx1; ++bx) {
+        zmax = std::max(zmax, this->fetch(bx, by).zmax);
+        if (inclusive_ ? (zmin <= zmax) : (zmin < zmax))
+          return false;
+      }
+    }
+  }
+
+  return inclusive_ ? (zmin > zmax) : (zmin >= zmax);
+}
+
+void HiZBuffer::update(uint32_t x, uint32_t y, uint32_t old_depth, uint32_t new_depth) {
+  if (!active_ || old_depth == new_depth)
+    return;
+
+  // entries only cover the scissor rectangle
+  if (x < scissor_left_ || x >= scissor_right_
+   || y < scissor_top_  || y >= scissor_bottom_)
+    return;
+
+  auto& entry = entries_.at((y >> block_logsize_) * width_ + (x >> block_logsize_));
+  if (!entry.valid)
+    return;
+
+  if (old_depth == entry.zmax) {
+    assert(entry.count != 0);
+    --entry.count;
+  }
+  if (new_depth > entry.zmax) {
+    entry.zmax  = new_depth;
+    entry.count = 1;
+  } else if (new_depth == entry.zmax) {
+    ++entry.count;
+  } else if (0 == entry.count) {
+    // the farthest pixel moved closer
+    entry.valid = false;
+  }
+}
@@ -0,0 +1,81 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "graphics.h"
+
+namespace vortex {
+
+class RAM;
+
+// Hierarchical depth buffer.
+// Holds the farthest depth of each block of the depth buffer, so the raster
+// units can drop the stamps and tiles of a primitive lying behind everything
+// already drawn there before they get shaded. The OM units report each depth
+// write. An entry also counts its pixels at the farthest depth; when they all
+// move closer, the entry is rebuilt from memory on its next lookup. Culling is
+// only enabled for LESS and LEQUAL depth tests without stencil, where a failing
+// fragment has no side effect.
+class HiZBuffer {
+public:
+  using Ptr = std::shared_ptr<HiZBuffer>;
+
+  HiZBuffer(bool enabled, uint32_t block_logsize);
+  ~HiZBuffer();
+
+  void attach_ram(RAM* mem);
+
+  // start of a kernel launch: drops all the entries
+  void configure(const graphics::RasterDCRS& raster_dcrs, const graphics::OMDCRS& om_dcrs);
+
+  bool enabled() const {
+    return active_;
+  }
+
+  // true when fragments at depth zmin or farther fail the depth test at every
+  // pixel of the (1 << logsize) square at (x, y)
+  bool occluded(uint32_t x, uint32_t y, uint32_t logsize, uint32_t zmin);
+
+  // the depth of pixel (x, y) changed in memory
+  void update(uint32_t x, uint32_t y, uint32_t old_depth, uint32_t new_depth);
+
+private:
+
+  struct entry_t {
+    uint32_t zmax;
+    uint32_t count;
+    bool     valid;
+  };
+
+  entry_t& fetch(uint32_t bx, uint32_t by);
+
+  bool     enabled_;
+  uint32_t block_logsize_;
+  RAM*     mem_;
+  bool     active_;
+  bool     inclusive_;
+  uint64_t zbuf_baseaddr_;
+  uint32_t zbuf_pitch_;
+  uint32_t scissor_left_;
+  uint32_t scissor_top_;
+  uint32_t scissor_right_;
+  uint32_t scissor_bottom_;
+  uint32_t width_;
+  uint32_t height_;
+  std::vector<entry_t> entries_;
+};
+
+}
@@ -87,6 +87,14 @@ public:
 
   bool fetch_stall;
 
+  bool uniform;
+
+  // pipeline timestamps, recorded for the timeline trace
+  uint64_t sched_cycle;
+  uint64_t decode_cycle;
+  uint64_t issue_cycle;
+  uint64_t dispatch_cycle;
+
   instr_trace_t(uint64_t uuid, const Arch& arch)
     : uuid(uuid)
     , arch(arch)
@@ -104,6 +112,11 @@ public:
     , sop(true)
     , eop(true)
     , fetch_stall(false)
+    , uniform(false)
+    , sched_cycle(0)
+    , decode_cycle(0)
+    , issue_cycle(0)
+    , dispatch_cycle(0)
     , log_once_(false)
   {}
 
@@ -124,6 +137,11 @@ public:
     , sop(rhs.sop)
     , eop(rhs.eop)
     , fetch_stall(rhs.fetch_stall)
+    , uniform(rhs.uniform)
+    , sched_cycle(rhs.sched_cycle)
+    , decode_cycle(rhs.decode_cycle)
+    , issue_cycle(rhs.issue_cycle)
+    , dispatch_cycle(rhs.dispatch_cycle)
     , log_once_(false)
   {}
 
@@ -140,6 +158,7 @@ private:
 };
 
 inline std::ostream &operator<<(std::ostream &os, const instr_trace_t& trace) {
+  Tracer::tag(os, trace.cid, trace.wid, trace.PC);
   os << "cid=" << trace.cid;
   os << ", wid=" << trace.wid;
   os << ", tmask=";
@@ -157,6 +176,9 @@ inline std::ostream &operator<<(std::ostream &os, const instr_trace_t& trace) {
     }
   }
   os << ", ex=" << trace.fu_type;
+  if (trace.uniform) {
+    os << ", uniform";
+  }
   if (trace.pid != -1) {
     os << ", pid=" << trace.pid;
     os << ", sop=" << trace.sop;
@@ -26,6 +26,8 @@ protected:
 	RAM       ram_;
 	int32_t   bank_sel_addr_start_;
   int32_t   bank_sel_addr_end_;
+	int32_t   addr_end_;
+	uint32_t  bank_prime_;
 	PerfStats perf_stats_;
 
 	uint64_t to_local_addr(uint64_t addr) {
@@ -40,8 +42,10 @@ public:
 		: simobject_(simobject)
 		, config_(config)
 		, ram_(config.capacity)
-		, bank_sel_addr_start_(0)
-		, bank_sel_addr_end_(config.B-1)
+		, bank_sel_addr_start_(log2ceil(config.line_size))
+		, bank_sel_addr_end_(bank_sel_addr_start_+config.B-1)
+		, addr_end_(log2ceil(config.capacity)-1)
+		, bank_prime_(prime_floor(1 << config.B))
 	{}
 
 	virtual ~Impl() {}
@@ -71,10 +75,7 @@ public:
 
 			auto& core_req = core_req_port.front();
 
-			uint32_t bank_id = 0;
-			if (bank_sel_addr_end_ >= bank_sel_addr_start_) {
-				bank_id = (uint32_t)bit_getw(core_req.addr, bank_sel_addr_start_, bank_sel_addr_end_);
-			}
+			auto bank_id = this->addr_bank_id(core_req.addr);
 
 			// bank conflict check
 			if (in_used_banks.at(bank_id)) {
@@ -104,6 +105,34 @@ public:
 	const PerfStats& perf_stats() const {
 		return perf_stats_;
 	}
+
+	uint32_t idle_banks() const {
+		if (config_.bank_hash != AddrHash::Prime)
+			return 0;
+		return (1 << config_.B) - bank_prime_;
+	}
+
+private:
+
+	uint32_t addr_bank_id(uint64_t addr) const {
+		if (bank_sel_addr_end_ < bank_sel_addr_start_)
+			return 0;
+		uint32_t bank_id = (uint32_t)bit_getw(addr, bank_sel_addr_start_, bank_sel_addr_end_);
+		switch (config_.bank_hash) {
+		case AddrHash::Xor:
+			// fold the upper word address bits into the bank index
+			if (addr_end_ > bank_sel_addr_end_) {
+				bank_id ^= (uint32_t)bit_xorw(bit_getw(addr, bank_sel_addr_end_+1, addr_end_), config_.B);
+			}
+			break;
+		case AddrHash::Prime:
+			bank_id = (uint32_t)(bit_getw(addr, bank_sel_addr_start_, addr_end_) % bank_prime_);
+			break;
+		default:
+			break;
+		}
+		return bank_id;
+	}
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -137,4 +166,8 @@ void LocalMem::tick() {
 
 const LocalMem::PerfStats& LocalMem::perf_stats() const {
   return impl_->perf_stats();
+}
+
+uint32_t LocalMem::idle_banks() const {
+  return impl_->idle_banks();
 }
\ No newline at end of file
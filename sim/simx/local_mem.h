@@ -26,6 +26,7 @@ public:
     uint32_t num_reqs;
     uint32_t B; // log2 number of banks
     bool write_reponse;
+    AddrHash bank_hash; // bank index hashing
   };
 
   struct PerfStats {
@@ -63,6 +64,9 @@ public:
 
   const PerfStats& perf_stats() const;
 
+  // banks never selected by the prime bank hashing
+  uint32_t idle_banks() const;
+
 protected:
 
   class Impl;
@@ -29,18 +29,19 @@
 using namespace vortex;
 
 static void show_usage() {
-   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-s: stats] [-h: help] <program>" << std::endl;
+   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-C <config file>] [-s: stats] [-h: help] <program>" << std::endl;
 }
 
 uint32_t num_threads = NUM_THREADS;
 uint32_t num_warps = NUM_WARPS;
 uint32_t num_cores = NUM_CORES;
+const char* config_file = nullptr;
 bool showStats = false;
 const char* program = nullptr;
 
 static void parse_args(int argc, char **argv) {
   	int c;
-  	while ((c = getopt(argc, argv, "t:w:c:rsh?")) != -1) {
+  	while ((c = getopt(argc, argv, "t:w:c:C:rsh?")) != -1) {
     	switch (c) {
       case 't':
         num_threads = atoi(optarg);
@@ -51,6 +52,9 @@ static void parse_args(int argc, char **argv) {
 		  case 'c':
         num_cores = atoi(optarg);
         break;
+      case 'C':
+        config_file = optarg;
+        break;
       case 's':
         showStats = true;
         break;
@@ -82,6 +86,9 @@ int main(int argc, char **argv) {
   {
     // create processor configuation
     Arch arch(num_threads, num_warps, num_cores);
+    if (config_file) {
+      arch.load_config(config_file);
+    }
 
     // create memory module
     RAM ram(0, RAM_PAGE_SIZE);
@@ -109,8 +109,8 @@ void MemCoalescer::tick() {
       uint64_t seed_addr = in_req.addrs.at(i) & addr_mask;
       cur_mask.set(i);
 
-      // coalesce matching requests
-      for (uint32_t s = r + 1; s < output_ratio_; ++s) {
+      // coalesce matching requests, atomics are serialized per lane
+      for (uint32_t s = r + 1; !in_req.atomic && s < output_ratio_; ++s) {
         uint32_t j = o * output_ratio_ + s;
         if (sent_mask_.test(j) || !in_req.mask.test(j))
           continue;
@@ -139,6 +139,7 @@ void MemCoalescer::tick() {
   out_req.mask = out_mask;
   out_req.tag = tag;
   out_req.write = in_req.write;
+  out_req.atomic = in_req.atomic;
   out_req.addrs = out_addrs;
   out_req.cid = in_req.cid;
   out_req.uuid = in_req.uuid;
@@ -25,77 +25,177 @@ using namespace vortex;
 
 class MemSim::Impl {
 private:
-	MemSim*   simobject_;
-	Config    config_;
-	DramSim   dram_sim_;
-	PerfStats perf_stats_;
+	struct dram_req_t {
+		MemReq   request;
+		uint32_t port_id;
+		uint64_t cycle;
+	};
+
+	struct channel_t {
+		std::queue<dram_req_t> queue;
+		uint64_t  open_row;
+		int       last_write; // -1: no request issued yet
+		PerfStats perf_stats;
+	};
 
 	struct DramCallbackArgs {
-		MemSim* simobject;
-		MemReq  request;
+		Impl*    impl;
+		MemReq   request;
+		uint32_t port_id;
+		uint32_t channel_id;
+		uint64_t cycle;
 	};
 
+	MemSim*   simobject_;
+	Config    config_;
+	DramSim   dram_sim_;
+	std::vector<channel_t> channels_;
+	uint32_t  log2_interleave_;
+	uint32_t  log2_row_size_;
+	uint32_t  port_cursor_;
+
 public:
 	Impl(MemSim* simobject, const Config& config)
 		: simobject_(simobject)
 		, config_(config)
 		, dram_sim_(MEM_CLOCK_RATIO)
-	{}
+		, channels_(config.channels)
+		, log2_interleave_(log2ceil(config.interleave))
+		, log2_row_size_(log2ceil(config.row_size))
+	{
+		assert(config.channels != 0);
+		assert(ispow2(config.interleave));
+		assert(config.queue_size != 0);
+	}
 
 	~Impl() {
 		//--
 	}
 
-	const PerfStats& perf_stats() const {
-		return perf_stats_;
+	const PerfStats& perf_stats(uint32_t channel) const {
+		return channels_.at(channel).perf_stats;
+	}
+
+	PerfStats perf_stats() const {
+		PerfStats perf;
+		for (auto& channel : channels_) {
+			perf += channel.perf_stats;
+		}
+		return perf;
 	}
 
 	void reset() {
 		dram_sim_.reset();
+		for (auto& channel : channels_) {
+			channel.queue = {};
+			channel.open_row = uint64_t(-1);
+			channel.last_write = -1;
+			channel.perf_stats = PerfStats();
+		}
+		port_cursor_ = 0;
 	}
 
 	void tick() {
 		dram_sim_.tick();
 
-		if (simobject_->MemReqPort.empty())
-			return;
-
-		auto& mem_req = simobject_->MemReqPort.front();
-
-		// try to enqueue the request to the memory system
-		auto req_args = new DramCallbackArgs{simobject_, mem_req};
-		auto enqueue_success = dram_sim_.send_request(
-			mem_req.write,
-			mem_req.addr,
-			0,
-			[](void* arg) {
-				auto rsp_args = reinterpret_cast<const DramCallbackArgs*>(arg);
-				// only send a response for read requests
-				if (!rsp_args->request.write) {
-					MemRsp mem_rsp{rsp_args->request.tag, rsp_args->request.cid, rsp_args->request.uuid};
-					rsp_args->simobject->MemRspPort.push(mem_rsp, 1);
-					DT(3, rsp_args->simobject->name() << " mem-rsp: " << mem_rsp);
-				}
-				delete rsp_args;
-			},
-			req_args
-		);
-
-		// check if the request was enqueued successfully
-		if (!enqueue_success) {
-			delete req_args;
-			return;
+		// route incoming requests to their channel queue
+		uint32_t num_ports = simobject_->MemReqPorts.size();
+		for (uint32_t p = 0; p < num_ports; ++p) {
+			uint32_t port_id = (port_cursor_ + p) % num_ports;
+			auto& mem_req_port = simobject_->MemReqPorts.at(port_id);
+			if (mem_req_port.empty())
+				continue;
+			auto& mem_req = mem_req_port.front();
+			auto& channel = channels_.at(this->channel_id(mem_req.addr));
+			if (channel.queue.size() >= config_.queue_size) {
+				++channel.perf_stats.queue_stalls;
+				continue;
+			}
+			channel.queue.push({mem_req, port_id, SimPlatform::instance().cycles()});
+			mem_req_port.pop();
 		}
-
-		if (mem_req.write) {
-			++perf_stats_.writes;
-		} else {
-			++perf_stats_.reads;
+		port_cursor_ = (port_cursor_ + 1) % num_ports;
+
+		// issue one request per channel
+		for (uint32_t channel_id = 0; channel_id < config_.channels; ++channel_id) {
+			auto& channel = channels_.at(channel_id);
+
+			// sample queue occupancy
+			auto occupancy = channel.queue.size();
+			uint32_t queue_bin = (occupancy == 0) ? 0 :
+			                     (occupancy * 2 < config_.queue_size) ? 1 :
+			                     (occupancy < config_.queue_size) ? 2 : 3;
+			++channel.perf_stats.queue_hist[queue_bin];
+
+			if (channel.queue.empty())
+				continue;
+
+			auto& entry = channel.queue.front();
+			auto& mem_req = entry.request;
+
+			// try to enqueue the request to the memory system
+			auto req_args = new DramCallbackArgs{this, mem_req, entry.port_id, channel_id, entry.cycle};
+			auto enqueue_success = dram_sim_.send_request(
+				mem_req.write,
+				mem_req.addr,
+				channel_id,
+				[](void* arg) {
+					auto rsp_args = reinterpret_cast<const DramCallbackArgs*>(arg);
+					// only send a response for read requests
+					if (!rsp_args->request.write) {
+						rsp_args->impl->processResponse(*rsp_args);
+					}
+					delete rsp_args;
+				},
+				req_args
+			);
+
+			// check if the request was enqueued successfully
+			if (!enqueue_success) {
+				delete req_args;
+				continue;
+			}
+
+			auto& perf_stats = channel.perf_stats;
+			if (mem_req.write) {
+				++perf_stats.writes;
+			} else {
+				++perf_stats.reads;
+			}
+			perf_stats.queue_latency += SimPlatform::instance().cycles() - entry.cycle;
+
+			if (channel.last_write != -1 && channel.last_write != int(mem_req.write)) {
+				++perf_stats.turnarounds;
+			}
+			channel.last_write = mem_req.write;
+
+			uint64_t row = mem_req.addr >> log2_row_size_;
+			if (row == channel.open_row) {
+				++perf_stats.row_hits;
+			}
+			channel.open_row = row;
+
+			DT(3, simobject_->name() << "-ch" << channel_id << " mem-req: " << mem_req);
+
+			channel.queue.pop();
 		}
+	}
 
-		DT(3, simobject_->name() << " mem-req: " << mem_req);
+private:
+
+	void processResponse(const DramCallbackArgs& args) {
+		// update the channel read latency histogram
+		auto latency = SimPlatform::instance().cycles() - args.cycle;
+		uint32_t latency_bin = (latency < 32) ? 0 : std::min<uint32_t>(log2floor(std::min<uint64_t>(latency, 4096)) - 4, PerfStats::LATENCY_BINS - 1);
+		++channels_.at(args.channel_id).perf_stats.latency_hist[latency_bin];
 
-		simobject_->MemReqPort.pop();
+		MemRsp mem_rsp{args.request.tag, args.request.cid, args.request.uuid};
+		simobject_->MemRspPorts.at(args.port_id).push(mem_rsp, 1);
+		DT(3, simobject_->name() << " mem-rsp: " << mem_rsp);
+	}
+
+	uint32_t channel_id(uint64_t addr) const {
+		return (addr >> log2_interleave_) % config_.channels;
 	}
 };
 
@@ -103,8 +203,8 @@ public:
 
 MemSim::MemSim(const SimContext& ctx, const char* name, const Config& config)
 	: SimObject<MemSim>(ctx, name)
-	, MemReqPort(this)
-	, MemRspPort(this)
+	, MemReqPorts(config.channels, this)
+	, MemRspPorts(config.channels, this)
 	, impl_(new Impl(this, config))
 {}
 
@@ -118,4 +218,12 @@ void MemSim::reset() {
 
 void MemSim::tick() {
   impl_->tick();
-}
\ No newline at end of file
+}
+
+const MemSim::PerfStats& MemSim::perf_stats(uint32_t channel) const {
+  return impl_->perf_stats(channel);
+}
+
+MemSim::PerfStats MemSim::perf_stats() const {
+  return impl_->perf_stats();
+}
@@ -21,22 +21,56 @@ namespace vortex {
 class MemSim : public SimObject<MemSim>{
 public:
 	struct Config {
-		uint32_t channels;
+		uint32_t channels;   // number of channels (one memory port each)
 		uint32_t num_cores;
+		uint32_t interleave; // channel interleave granularity (bytes)
+		uint32_t queue_size; // channel request queue size
+		uint32_t row_size;   // DRAM row size (bytes)
 	};
 
 	struct PerfStats {
+		static constexpr uint32_t LATENCY_BINS = 8; // <32, <64, ..., >=2048 cycles
+		static constexpr uint32_t QUEUE_BINS = 4;   // empty, <half, >=half, full
+
 		uint64_t reads;
 		uint64_t writes;
+		uint64_t queue_latency; // total cycles spent in channel queues
+		uint64_t queue_stalls;  // cycles a port was blocked by a full channel queue
+		uint64_t row_hits;      // requests to the channel's last open row
+		uint64_t turnarounds;   // switches between reads and writes
+		uint64_t latency_hist[LATENCY_BINS]; // read latency distribution
+		uint64_t queue_hist[QUEUE_BINS];     // queue occupancy distribution (cycles)
 
-		PerfStats() 
+		PerfStats()
 			: reads(0)
 			, writes(0)
+			, queue_latency(0)
+			, queue_stalls(0)
+			, row_hits(0)
+			, turnarounds(0)
+			, latency_hist{}
+			, queue_hist{}
 		{}
+
+		PerfStats& operator+=(const PerfStats& rhs) {
+			this->reads += rhs.reads;
+			this->writes += rhs.writes;
+			this->queue_latency += rhs.queue_latency;
+			this->queue_stalls += rhs.queue_stalls;
+			this->row_hits += rhs.row_hits;
+			this->turnarounds += rhs.turnarounds;
+			for (uint32_t i = 0; i < LATENCY_BINS; ++i) {
+				this->latency_hist[i] += rhs.latency_hist[i];
+			}
+			for (uint32_t i = 0; i < QUEUE_BINS; ++i) {
+				this->queue_hist[i] += rhs.queue_hist[i];
+			}
+			return *this;
+		}
 	};
 
-	SimPort<MemReq> MemReqPort;
-	SimPort<MemRsp> MemRspPort;
+	std::vector<SimPort<MemReq>> MemReqPorts;
+	std::vector<SimPort<MemRsp>> MemRspPorts;
 
 	MemSim(const SimContext& ctx, const char* name, const Config& config);
 	~MemSim();
@@ -45,7 +79,11 @@ public:
 
 	void tick();
 
-	const PerfStats& perf_stats() const;
+	// per-channel statistics
+	const PerfStats& perf_stats(uint32_t channel) const;
+
+	// all channels statistics
+	PerfStats perf_stats() const;
 	
 private:
 	class Impl;
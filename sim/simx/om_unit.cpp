@@ -18,12 +18,144 @@
 #include <cocogfx/include/math.hpp>
 #include <cocogfx/include/color.hpp>
 #include <algorithm>
+#include <deque>
+#include <map>
+
+// cycles for a memory request to reach the ocache
+#define OM_MEM_REQ_DELAY 2
 
 using namespace vortex;
 
+// On-chip color and depth storage for the most recently used screen tiles.
+// A memory line is fetched on its first read and writes only mark it dirty,
+// so overdrawn pixels reach memory once: the dirty lines of a tile are
+// written back when it gets evicted or at the end of the launch. Lines
+// written before being read, as when clearing a surface, are never fetched.
+class TileBuffer {
+public:
+  TileBuffer(uint32_t num_tiles, uint32_t tile_logsize)
+    : slots_(num_tiles)
+    , tile_logsize_(tile_logsize)
+    , lru_clock_(0)
+  {}
+
+  bool enabled() const {
+    return !slots_.empty();
+  }
+
+  void reset() {
+    for (auto& slot : slots_) {
+      slot = slot_t();
+    }
+    lru_clock_ = 0;
+  }
+
+  void read(uint32_t x, uint32_t y, uint64_t addr, OMUnit::TraceData::Ptr& trace_data) {
+    auto& state = this->fetch(x, y, trace_data).lines[addr & ~uint64_t(MEM_BLOCK_SIZE-1)];
+    if (0 == (state & line_loaded)) {
+      trace_data->mem_rd_addrs.push_back(addr);
+      state |= line_loaded;
+    }
+  }
+
+  void write(uint32_t x, uint32_t y, uint64_t addr, OMUnit::TraceData::Ptr& trace_data) {
+    auto& slot = this->fetch(x, y, trace_data);
+    slot.lines[addr & ~uint64_t(MEM_BLOCK_SIZE-1)] |= line_dirty;
+    slot.dirty = true;
+    // the tile write-back is accounted to its last writer
+    slot.cid   = trace_data->cid;
+    slot.uuid  = trace_data->uuid;
+  }
+
+  bool dirty() const {
+    for (auto& slot : slots_) {
+      if (slot.valid && slot.dirty)
+        return true;
+    }
+    return false;
+  }
+
+  // write back the next dirty tile, returns false when none is left
+  bool flush(std::vector<uint64_t>* addrs, uint32_t* cid, uint64_t* uuid) {
+    for (auto& slot : slots_) {
+      if (slot.valid && slot.dirty) {
+        *cid  = slot.cid;
+        *uuid = slot.uuid;
+        this->evict(slot, addrs);
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+
+  enum {
+    line_loaded = 0x1,
+    line_dirty  = 0x2,
+  };
+
+  struct slot_t {
+    bool     valid;
+    bool     dirty;
+    uint32_t tile_x;
+    uint32_t tile_y;
+    uint64_t lru;
+    uint32_t cid;
+    uint64_t uuid;
+    std::map<uint64_t, uint8_t> lines;
+
+    slot_t() : valid(false), dirty(false), tile_x(0), tile_y(0), lru(0), cid(0), uuid(0) {}
+  };
+
+  slot_t& fetch(uint32_t x, uint32_t y, OMUnit::TraceData::Ptr& trace_data) {
+    auto tile_x = x >> tile_logsize_;
+    auto tile_y = y >> tile_logsize_;
+    slot_t* victim = &slots_.front();
+    for (auto& slot : slots_) {
+      if (slot.valid && slot.tile_x == tile_x && slot.tile_y == tile_y) {
+        slot.lru = ++lru_clock_;
+        return slot;
+      }
+      if (victim->valid && (!slot.valid || slot.lru < victim->lru)) {
+        victim = &slot;
+      }
+    }
+    if (victim->valid) {
+      this->evict(*victim, &trace_data->mem_wr_addrs);
+    }
+    victim->valid  = true;
+    victim->tile_x = tile_x;
+    victim->tile_y = tile_y;
+    victim->lru    = ++lru_clock_;
+    return *victim;
+  }
+
+  void evict(slot_t& slot, std::vector<uint64_t>* addrs) {
+    for (auto& line : slot.lines) {
+      if (line.second & line_dirty) {
+        addrs->push_back(line.first);
+      }
+    }
+    slot.valid = false;
+    slot.dirty = false;
+    slot.lines.clear();
+  }
+
+  std::vector<slot_t> slots_;
+  uint32_t tile_logsize_;
+  uint64_t lru_clock_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class OutputMerger {
 public:
-  OutputMerger() {}
+  OutputMerger(HiZBuffer* hiz_buffer, uint32_t tile_buffers, OMUnit::PerfStats& perf_stats)
+    : hiz_buffer_(hiz_buffer)
+    , tile_buffer_(tile_buffers, RASTER_TILE_LOGSIZE)
+    , perf_stats_(perf_stats)
+  {}
 
   void configure(const graphics::OMDCRS& dcrs) {
     // get device configuration
@@ -52,6 +184,18 @@ public:
     mem_ = mem;
   }
 
+  void reset() {
+    tile_buffer_.reset();
+  }
+
+  bool dirty() const {
+    return tile_buffer_.dirty();
+  }
+
+  bool flush(std::vector<uint64_t>* addrs, uint32_t* cid, uint64_t* uuid) {
+    return tile_buffer_.flush(addrs, cid, uuid);
+  }
+
   void write(uint32_t x,
              uint32_t y,
              bool is_backface,
@@ -82,6 +226,26 @@ public:
 
 private:
 
+  // the memory traffic of each access is recorded in the trace: immediate
+  // mode issues all of it, the tile buffer only its line fills
+  void trace_read(uint32_t x, uint32_t y, uint64_t addr, OMUnit::TraceData::Ptr& trace_data) {
+    ++perf_stats_.imm_reads;
+    if (tile_buffer_.enabled()) {
+      tile_buffer_.read(x, y, addr, trace_data);
+    } else {
+      trace_data->mem_rd_addrs.push_back(addr);
+    }
+  }
+
+  void trace_write(uint32_t x, uint32_t y, uint64_t addr, OMUnit::TraceData::Ptr& trace_data) {
+    ++perf_stats_.imm_writes;
+    if (tile_buffer_.enabled()) {
+      tile_buffer_.write(x, y, addr, trace_data);
+    } else {
+      trace_data->mem_wr_addrs.push_back(addr);
+    }
+  }
+
   void read(bool depth_enable,
             bool stencil_enable,
             bool blend_enable,
@@ -93,13 +257,13 @@ private:
     if (depth_enable || stencil_enable) {
       uint64_t zbuf_addr = zbuf_baseaddr_ + y * zbuf_pitch_ + x * 4;
       mem_->read(depthstencil, zbuf_addr, 4);
-      trace_data->mem_rd_addrs.push_back(zbuf_addr);
+      this->trace_read(x, y, zbuf_addr, trace_data);
       DT(3, "om-depthstencil-read: x=" << std::dec << x << ", y=" << y << ", addr=0x" << std::hex << zbuf_addr << ", depthstencil=0x" << *depthstencil);
     }
     if (color_write_ && (color_read_ || blend_enable)) {
       uint64_t cbuf_addr = cbuf_baseaddr_ + y * cbuf_pitch_ + x * 4;
       mem_->read(color, cbuf_addr, 4);
-      trace_data->mem_rd_addrs.push_back(cbuf_addr);
+      this->trace_read(x, y, cbuf_addr, trace_data);
       DT(3, "om-color-read: x=" << std::dec << x << ", y=" << y << ", addr=0x" << std::hex << cbuf_addr << ", color=0x" << *color);
     }
   }
@@ -122,7 +286,8 @@ private:
       uint32_t write_value = (dst_depthstencil & ~ds_writeMask) | (depthstencil & ds_writeMask);
       uint64_t zbuf_addr = zbuf_baseaddr_ + y * zbuf_pitch_ + x * 4;
       mem_->write(&write_value, zbuf_addr, 4);
-      trace_data->mem_wr_addrs.push_back(zbuf_addr);
+      this->trace_write(x, y, zbuf_addr, trace_data);
+      hiz_buffer_->update(x, y, dst_depthstencil & VX_OM_DEPTH_MASK, write_value & VX_OM_DEPTH_MASK);
       DT(3, "om-depthstencil-write: x=" << std::dec << x << ", y=" << y << ", addr=0x" << std::hex << zbuf_addr << ", depthstencil=0x" << write_value);
     }
 
@@ -130,13 +295,16 @@ private:
       uint32_t write_value = (dst_color & ~cbuf_writemask_) | (color & cbuf_writemask_);
       uint64_t cbuf_addr = cbuf_baseaddr_ + y * cbuf_pitch_ + x * 4;
       mem_->write(&write_value, cbuf_addr, 4);
-      trace_data->mem_wr_addrs.push_back(cbuf_addr);
+      this->trace_write(x, y, cbuf_addr, trace_data);
       DT(3, "om-color-write: x=" << std::dec << x << ", y=" << y << ", addr=0x" << std::hex << cbuf_addr << ", color=0x" << write_value);
     }
   }
 
   graphics::DepthTencil depthStencil_;
   graphics::Blender blender_;
+  HiZBuffer* hiz_buffer_;
+  TileBuffer tile_buffer_;
+  OMUnit::PerfStats& perf_stats_;
   RAM* mem_;
 
   uint32_t zbuf_baseaddr_;
@@ -160,10 +328,12 @@ public:
 
   Impl(OMUnit* simobject,
        const Arch &arch,
-       const DCRS& dcrs)
+       const DCRS& dcrs,
+       HiZBuffer* hiz_buffer)
     : simobject_(simobject)
     , arch_(arch)
     , dcrs_(dcrs)
+    , render_output_(hiz_buffer, arch.om_tile_buffers(), perf_stats_)
     , pending_reqs_(OM_MEM_QUEUE_SIZE)
   {
     this->reset();
@@ -173,6 +343,10 @@ public:
 
   void reset() {
     render_output_.configure(dcrs_);
+    render_output_.reset();
+    flushing_ = false;
+    flush_end_time_ = 0;
+    flush_reqs_.clear();
     last_pop_time_= 0;
     pending_reqs_.clear();
     perf_stats_ = PerfStats();
@@ -196,7 +370,7 @@ public:
           mem_req.cid   = mem_rsp.cid;
           mem_req.uuid  = mem_rsp.uuid;
           uint32_t port = i % simobject_->MemReqs.size();
-          simobject_->MemReqs.at(port).push(mem_req, 2);
+          simobject_->MemReqs.at(port).push(mem_req, OM_MEM_REQ_DELAY);
           ++perf_stats_.writes;
         }
         pending_reqs_.release(mem_rsp.tag);
@@ -210,8 +384,12 @@ public:
     }
 
     // check input trace
-    if (simobject_->Input.empty())
+    if (simobject_->Input.empty()) {
+      if (flushing_) {
+        this->flush_tile();
+      }
       return;
+    }
 
     auto trace = simobject_->Input.front();
 
@@ -238,7 +416,7 @@ public:
       mem_req.cid   = trace->cid;
       mem_req.uuid  = trace->uuid;
       uint32_t port = i % simobject_->MemReqs.size();
-      simobject_->MemReqs.at(port).push(mem_req, 2);
+      simobject_->MemReqs.at(port).push(mem_req, OM_MEM_REQ_DELAY);
       ++perf_stats_.reads;
     }
 
@@ -252,7 +430,7 @@ public:
         mem_req.cid   = trace->cid;
         mem_req.uuid  = trace->uuid;
         uint32_t port = i % simobject_->MemReqs.size();
-        simobject_->MemReqs.at(port).push(mem_req, 2);
+        simobject_->MemReqs.at(port).push(mem_req, OM_MEM_REQ_DELAY);
         ++perf_stats_.writes;
       }
       pending_reqs_.release(tag);
@@ -271,6 +449,17 @@ public:
     render_output_.attach_ram(mem);
   }
 
+  void flush() {
+    flushing_ = true;
+  }
+
+  bool busy() const {
+    // stay busy until the last write-backs have reached the ocache
+    return render_output_.dirty()
+        || !flush_reqs_.empty()
+        || SimPlatform::instance().cycles() < flush_end_time_;
+  }
+
   const PerfStats& perf_stats() const {
     return perf_stats_;
   }
@@ -282,12 +471,43 @@ private:
     uint32_t count;
   };
 
+  // drain the dirty tiles of the tile buffer, one line per port per cycle
+  void flush_tile() {
+    if (flush_reqs_.empty()) {
+      std::vector<uint64_t> addrs;
+      uint32_t cid;
+      uint64_t uuid;
+      if (!render_output_.flush(&addrs, &cid, &uuid))
+        return;
+      for (auto addr : addrs) {
+        MemReq mem_req;
+        mem_req.addr  = addr;
+        mem_req.write = true;
+        mem_req.tag   = 0;
+        mem_req.cid   = cid;
+        mem_req.uuid  = uuid;
+        flush_reqs_.push_back(mem_req);
+      }
+    }
+    for (auto& port : simobject_->MemReqs) {
+      if (flush_reqs_.empty())
+        break;
+      port.push(flush_reqs_.front(), OM_MEM_REQ_DELAY);
+      flush_reqs_.pop_front();
+      ++perf_stats_.writes;
+    }
+    flush_end_time_ = SimPlatform::instance().cycles() + OM_MEM_REQ_DELAY + 1;
+  }
+
   OMUnit*      simobject_;
   const Arch&   arch_;
   const DCRS&   dcrs_;
   std::unordered_map<uint32_t, uint32_t> csrs_;
   PerfStats     perf_stats_;
   OutputMerger  render_output_;
+  bool          flushing_;
+  uint64_t      flush_end_time_;
+  std::deque<MemReq> flush_reqs_;
   uint64_t      last_pop_time_;
   HashTable<pending_req_t> pending_reqs_;
 };
@@ -297,13 +517,14 @@ private:
 OMUnit::OMUnit(const SimContext& ctx,
                  const char* name,
                  const Arch &arch,
-                 const DCRS& dcrs)
+                 const DCRS& dcrs,
+                 HiZBuffer* hiz_buffer)
   : SimObject<OMUnit>(ctx, name)
   , MemReqs(NUM_SFU_LANES, this)
   , MemRsps(NUM_SFU_LANES, this)
   , Input(this)
   , Output(this)
-  , impl_(new Impl(this, arch, dcrs))
+  , impl_(new Impl(this, arch, dcrs, hiz_buffer))
 {}
 
 OMUnit::~OMUnit() {
@@ -322,6 +543,14 @@ void OMUnit::attach_ram(RAM* mem) {
   impl_->attach_ram(mem);
 }
 
+void OMUnit::flush() {
+  impl_->flush();
+}
+
+bool OMUnit::busy() const {
+  return impl_->busy();
+}
+
 void OMUnit::write(uint32_t x, uint32_t y, bool is_backface, uint32_t color, uint32_t depth,
                    OMUnit::TraceData::Ptr trace_data) {
   impl_->write(x, y, is_backface, color, depth, trace_data);
@@ -18,6 +18,7 @@
 #include "pipeline.h"
 #include "graphics.h"
 #include "types.h"
+#include "hiz_buffer.h"
 
 namespace vortex {
 
@@ -30,12 +31,16 @@ public:
     uint64_t writes;
     uint64_t latency;
     uint64_t stalls;
+    uint64_t imm_reads;
+    uint64_t imm_writes;
 
     PerfStats()
       : reads(0)
       , writes(0)
       , latency(0)
       , stalls(0)
+      , imm_reads(0)
+      , imm_writes(0)
     {}
 
     PerfStats& operator+=(const PerfStats& rhs) {
@@ -43,6 +48,8 @@ public:
       this->writes  += rhs.writes;
       this->latency += rhs.latency;
       this->stalls  += rhs.stalls;
+      this->imm_reads  += rhs.imm_reads;
+      this->imm_writes += rhs.imm_writes;
       return *this;
     }
   };
@@ -52,6 +59,8 @@ public:
     std::vector<uint64_t> mem_rd_addrs;
     std::vector<uint64_t> mem_wr_addrs;
     uint32_t om_idx;
+    uint32_t cid;
+    uint64_t uuid;
   };
 
   using DCRS = graphics::OMDCRS;
@@ -65,7 +74,8 @@ public:
   OMUnit(const SimContext& ctx,
           const char* name,
           const Arch &arch,
-          const DCRS& dcrs);
+          const DCRS& dcrs,
+          HiZBuffer* hiz_buffer);
 
   ~OMUnit();
 
@@ -75,6 +85,12 @@ public:
 
   void attach_ram(RAM* mem);
 
+  // end of the launch: write back the tile buffer
+  void flush();
+
+  // the tile buffer still holds dirty lines or is writing them back
+  bool busy() const;
+
   void write(uint32_t x, uint32_t y, bool is_backface, uint32_t color, uint32_t depth,
              OMUnit::TraceData::Ptr trace_data);
 
@@ -14,65 +14,176 @@
 #pragma once
 
 #include "instr_trace.h"
+#include <vector>
 
 namespace vortex {
 
+// Operand collector stage of an issue slot.
+// The slot's register file is split into banks, each with a fixed number of read
+// and write ports. Instructions wait in a collector unit until all their source
+// registers have been granted a read port; writebacks from the commit stage take
+// the bank write ports first and spill over onto the read ports.
 class Operand : public SimObject<Operand> {
 private:
-		static constexpr uint32_t NUM_BANKS = 4;
-		uint32_t total_stalls_ = 0;
+		struct opc_t {
+			instr_trace_t* trace;
+			uint32_t       pending; // source operands not yet read
+			uint64_t       order;   // allocation order
+		};
+
+		const Arch& arch_;
+		std::vector<opc_t> opcs_;
+		std::vector<uint32_t> read_ports_;
+		std::vector<uint32_t> pending_writes_;
+		uint32_t opc_idx_;
+		uint64_t opc_order_;
+		uint64_t total_stalls_;
+
+		// register file index: integer registers first, then floating-point
+		static uint32_t reg_index(const instr_trace_t::reg_t& reg) {
+			return (reg.type == RegType::Float) ? (reg.idx + MAX_NUM_REGS) : reg.idx;
+		}
+
+		uint32_t bank_index(const instr_trace_t::reg_t& reg) const {
+			return reg_index(reg) % arch_.gpr_num_banks();
+		}
 
 public:
     SimPort<instr_trace_t*> Input;
     SimPort<instr_trace_t*> Output;
 
-    Operand(const SimContext& ctx)
+    Operand(const SimContext& ctx, const Arch& arch)
 			: SimObject<Operand>(ctx, "Operand")
+			, arch_(arch)
+			, opcs_(arch.num_opcs())
+			, read_ports_(arch.gpr_num_banks())
+			, pending_writes_(arch.gpr_num_banks())
 			, Input(this)
 			, Output(this)
     {
-			total_stalls_ = 0;
+			this->reset();
 		}
 
     virtual ~Operand() {}
 
     virtual void reset() {
+			for (auto& opc : opcs_) {
+				opc.trace = nullptr;
+				opc.pending = 0;
+				opc.order = 0;
+			}
+			for (auto& writes : pending_writes_) {
+				writes = 0;
+			}
+			opc_idx_ = 0;
+			opc_order_ = 0;
 			total_stalls_ = 0;
 		}
 
     virtual void tick() {
-			if (Input.empty())
-				return;
-			auto trace = Input.front();
-
-			uint32_t stalls = 0;
-
-			for (int i = 0; i < NUM_SRC_REGS; ++i) {
-				for (int j = i + 1; j < NUM_SRC_REGS; ++j) {
-					int bank_i = trace->src_regs[i].idx % NUM_BANKS;
-					int bank_j = trace->src_regs[j].idx % NUM_BANKS;
-					if ((trace->src_regs[i].type != RegType::None)
-					 && (trace->src_regs[j].type != RegType::None)
-					 && (trace->src_regs[i].idx != 0)
-					 && (trace->src_regs[j].idx != 0)
-					 && bank_i == bank_j) {
-						++stalls;
-					}
+			// writebacks have priority over reads on the bank ports
+			for (uint32_t b = 0, n = read_ports_.size(); b < n; ++b) {
+				uint32_t spill = 0;
+				if (pending_writes_.at(b) > arch_.gpr_write_ports()) {
+					spill = pending_writes_.at(b) - arch_.gpr_write_ports();
 				}
+				uint32_t stolen = std::min<uint32_t>(spill, arch_.gpr_read_ports());
+				read_ports_.at(b) = arch_.gpr_read_ports() - stolen;
+				pending_writes_.at(b) = spill - stolen;
 			}
 
-			total_stalls_ += stalls;
-
-			Output.push(trace, 2 + stalls);
+			// allocate a collector unit
+			bool opc_full = false;
+			if (!Input.empty() && Output.empty()) {
+				auto trace = Input.front();
+				opc_full = true;
+				for (auto& opc : opcs_) {
+					if (opc.trace != nullptr)
+						continue;
+					opc.trace = trace;
+					opc.pending = 0;
+					opc.order = opc_order_++;
+					// the scalar unit reads its operands from the scalar register file
+					for (uint32_t i = 0; i < NUM_SRC_REGS && trace->fu_type != FUType::SALU; ++i) {
+						auto& reg = trace->src_regs.at(i);
+						if (reg.type == RegType::None)
+							continue;
+						if (reg.type == RegType::Integer && reg.idx == 0)
+							continue; // hardwired zero
+						// a register repeated in the same instruction is read once
+						bool duplicate = false;
+						for (uint32_t j = 0; j < i; ++j) {
+							auto& prev = trace->src_regs.at(j);
+							if ((opc.pending & (1 << j)) && reg_index(prev) == reg_index(reg)) {
+								duplicate = true;
+							}
+						}
+						if (!duplicate) {
+							opc.pending |= (1 << i);
+						}
+					}
+					DT(3, "pipeline-operands: " << *trace);
+					Input.pop();
+					opc_full = false;
+					break;
+				}
+			}
 
-			DT(3, "pipeline-operands: " << *trace);
+			// arbitrate the bank read ports across collector units
+			bool bank_stall = false;
+			for (uint32_t k = 0, n = opcs_.size(); k < n; ++k) {
+				auto& opc = opcs_.at((opc_idx_ + k) % n);
+				if (opc.trace == nullptr)
+					continue;
+				for (uint32_t i = 0; i < NUM_SRC_REGS; ++i) {
+					if (!(opc.pending & (1 << i)))
+						continue;
+					auto& ports = read_ports_.at(bank_index(opc.trace->src_regs.at(i)));
+					if (ports == 0) {
+						bank_stall = true;
+						continue;
+					}
+					--ports;
+					opc.pending &= ~(1 << i);
+				}
+			}
+			opc_idx_ = (opc_idx_ + 1) % opcs_.size();
+
+			// release completed collectors in allocation order, a pending older
+			// collector holds back the younger ones
+			for (;;) {
+				opc_t* next = nullptr;
+				for (auto& opc : opcs_) {
+					if (opc.trace == nullptr)
+						continue;
+					if (next == nullptr || opc.order < next->order) {
+						next = &opc;
+					}
+				}
+				if (next == nullptr || next->pending != 0)
+					break;
+				Output.push(next->trace, 2);
+				next->trace = nullptr;
+			}
 
-			Input.pop();
+			if (bank_stall || opc_full) {
+				++total_stalls_;
+			}
     };
 
-		uint32_t total_stalls() const {
+		// register a writeback from the commit stage
+		void writeback(const instr_trace_t* trace) {
+			if (!trace->wb)
+				return;
+			// the scalar unit writes back to the scalar register file
+			if (trace->fu_type == FUType::SALU)
+				return;
+			++pending_writes_.at(bank_index(trace->dst_reg));
+		}
+
+		uint64_t total_stalls() const {
 			return total_stalls_;
 		}
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,130 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "perf_regions.h"
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <assert.h>
+
+using namespace vortex;
+
+PerfRegions::PerfRegions()
+  : launch_(0)
+  , header_(false)
+{
+  auto file_s = getenv("VORTEX_PERF_REGIONS");
+  if (file_s && *file_s) {
+    ofs_.open(file_s);
+    if (!ofs_) {
+      std::cout << "Error: cannot open regions file '" << file_s << "'" << std::endl;
+      std::abort();
+    }
+  }
+}
+
+PerfRegions::~PerfRegions() {
+  ofs_.flush();
+}
+
+void PerfRegions::start() {
+  regions_.clear();
+  ++launch_;
+}
+
+bool PerfRegions::enter(uint32_t id) {
+  auto& region = regions_[id];
+  ++region.entries;
+  return (region.active++ == 0);
+}
+
+bool PerfRegions::leave(uint32_t id) {
+  auto it = regions_.find(id);
+  if (it == regions_.end() || it->second.active == 0) {
+    std::cout << "Warning: perf region " << id << " ended without a matching begin" << std::endl;
+    return false;
+  }
+  return (--it->second.active == 0);
+}
+
+void PerfRegions::open(uint32_t id, uint64_t cycle, const std::vector<uint64_t>& values) {
+  auto& region = regions_.at(id);
+  region.start_cycle = cycle;
+  region.start = values;
+  region.totals.resize(values.size(), 0);
+}
+
+void PerfRegions::close(uint32_t id, uint64_t cycle, const std::vector<uint64_t>& values) {
+  auto& region = regions_.at(id);
+  assert(values.size() == region.start.size());
+  region.cycles += cycle - region.start_cycle;
+  for (size_t i = 0, n = values.size(); i < n; ++i) {
+    region.totals.at(i) += values.at(i) - region.start.at(i);
+  }
+}
+
+uint64_t PerfRegions::total(const region_t& region, const char* counter) const {
+  // sums a counter over all its instances, e.g. ".instrs" over all cores
+  std::string suffix(counter);
+  uint64_t sum = 0;
+  for (size_t i = 0, n = region.totals.size(); i < n; ++i) {
+    auto& name = names_.at(i);
+    if (name.size() >= suffix.size()
+     && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      sum += region.totals.at(i);
+    }
+  }
+  return sum;
+}
+
+void PerfRegions::report() {
+  for (auto& it : regions_) {
+    auto id = it.first;
+    auto& region = it.second;
+    if (region.active != 0) {
+      std::cout << "Warning: perf region " << id << " still open at the end of the kernel" << std::endl;
+    }
+    if (region.totals.empty())
+      continue;
+    auto instrs = this->total(region, ".instrs");
+    auto warp_instrs = this->total(region, ".warp_instrs");
+    double ipc = region.cycles ? (double(instrs) / region.cycles) : 0;
+    std::cout << "PERF: region " << id
+              << ": entries=" << region.entries
+              << ", cycles=" << region.cycles
+              << ", instrs=" << instrs
+              << ", warp instrs=" << warp_instrs
+              << ", IPC=" << std::fixed << std::setprecision(3) << ipc << std::defaultfloat
+              << ", loads=" << this->total(region, ".loads")
+              << ", stores=" << this->total(region, ".stores")
+              << ", dcache read misses=" << this->total(region, "dcache.read_misses")
+              << ", dram reads=" << this->total(region, "dram.reads")
+              << std::endl;
+
+    if (!ofs_.is_open())
+      continue;
+    if (!header_) {
+      ofs_ << "launch,region,entries,cycles";
+      for (auto& name : names_) {
+        ofs_ << "," << name;
+      }
+      ofs_ << "\n";
+      header_ = true;
+    }
+    ofs_ << launch_ << "," << id << "," << region.entries << "," << region.cycles;
+    for (auto value : region.totals) {
+      ofs_ << "," << value;
+    }
+    ofs_ << "\n";
+  }
+}
@@ -0,0 +1,74 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+
+namespace vortex {
+
+// Kernel-annotated performance regions.
+// Kernels delimit regions with vx_perf_region_begin/end(id). A region is open
+// while at least one warp is inside it; the processor snapshots its counters
+// when the first warp enters and the last one leaves, and the increments are
+// accumulated per region id. Each launch prints a summary of its regions, and
+// VORTEX_PERF_REGIONS=<file> also writes all the counter increments as CSV.
+class PerfRegions {
+public:
+  PerfRegions();
+  ~PerfRegions();
+
+  // start of a kernel launch
+  void start();
+
+  // a warp enters the region, returns true when it opens
+  bool enter(uint32_t id);
+
+  // a warp leaves the region, returns true when it closes
+  bool leave(uint32_t id);
+
+  // the counter names, to be filled on the first snapshot only
+  std::vector<std::string>* names() {
+    return names_.empty() ? &names_ : nullptr;
+  }
+
+  void open(uint32_t id, uint64_t cycle, const std::vector<uint64_t>& values);
+
+  void close(uint32_t id, uint64_t cycle, const std::vector<uint64_t>& values);
+
+  // end of a kernel launch
+  void report();
+
+private:
+  struct region_t {
+    uint32_t active;
+    uint64_t entries;
+    uint64_t start_cycle;
+    uint64_t cycles;
+    std::vector<uint64_t> start;
+    std::vector<uint64_t> totals;
+  };
+
+  uint64_t total(const region_t& region, const char* counter) const;
+
+  std::map<uint32_t, region_t> regions_;
+  std::vector<std::string> names_;
+  std::ofstream ofs_;
+  uint32_t launch_;
+  bool header_;
+};
+
+}
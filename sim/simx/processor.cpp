@@ -16,39 +16,75 @@
 
 using namespace vortex;
 
+// cache levels walked by a maintenance operation: L1, L2 and L3
+#define CACHE_FLUSH_LEVELS 3
+
 ProcessorImpl::ProcessorImpl(const Arch& arch)
   : arch_(arch)
   , clusters_(arch.num_clusters())
+  , perf_stats_cycle_(uint64_t(-1))
+  , perf_flush_cycles_(0)
+  , perf_flush_writebacks_(0)
+  , flush_invalidate_(false)
+  , flush_writebacks_(0)
+  , flush_arrivals_(0)
 {
   SimPlatform::instance().initialize();
 
+  // per-PC profiler (VORTEX_PROFILE)
+  profiler_ = Profiler::Create(arch);
+
+  // performance counters interval sampling (VORTEX_PERF_SAMPLES)
+  sampler_ = Sampler::Create();
+
+  // runtime tracing in release builds (VORTEX_TRACE)
+#ifdef NDEBUG
+  tracer_ = Tracer::init();
+#else
+  tracer_ = nullptr;
+#endif
+
   // create memory simulator
   memsim_ = MemSim::Create("dram", MemSim::Config{
-    MEMORY_BANKS,
-    uint32_t(arch.num_cores()) * arch.num_clusters()
+    arch.memory_banks(),
+    uint32_t(arch.num_cores()) * arch.num_clusters(),
+    MEMORY_INTERLEAVE,
+    MEMORY_QUEUE_SIZE,
+    MEMORY_ROW_SIZE
   });
 
   // create L3 cache
   l3cache_ = CacheSim::Create("l3cache", CacheSim::Config{
-    !L3_ENABLED,
-    log2ceil(L3_CACHE_SIZE),  // C
+    !arch.l3cache().enabled,
+    uint8_t(log2ceil(arch.l3cache().size)), // C
     log2ceil(MEM_BLOCK_SIZE), // L
     log2ceil(L2_LINE_SIZE),   // W
-    log2ceil(L3_NUM_WAYS),    // A
-    log2ceil(L3_NUM_BANKS),   // B
+    uint8_t(log2ceil(arch.l3cache().num_ways)), // A
+    uint8_t(log2ceil(arch.l3cache().num_banks)), // B
     XLEN,                     // address bits
     1,                        // number of ports
     uint8_t(arch.num_clusters()), // request size
+    uint8_t(arch.memory_banks()), // memory ports
     L3_WRITEBACK,             // write-back
     false,                    // write response
-    L3_MSHR_SIZE,             // mshr size
+    arch.l3cache().mshr_size, // mshr size
     2,                        // pipeline latency
+    AddrHash(L3_INDEX_HASH),  // index hashing
+    0,                        // victim cache size
+    InclusionPolicy(L3_INCLUSION), // inclusion policy
+    false,                    // evict clean lines
+    uint8_t((AMO_LEVEL == 3 || !arch.l2cache().enabled) ? AMO_LATENCY : 0), // atomic latency
     }
   );
 
   // connect L3 memory ports
-  l3cache_->MemReqPort.bind(&memsim_->MemReqPort);
-  memsim_->MemRspPort.bind(&l3cache_->MemRspPort);
+  for (uint32_t i = 0; i < arch.memory_banks(); ++i) {
+    l3cache_->MemReqPorts.at(i).bind(&memsim_->MemReqPorts.at(i));
+    memsim_->MemRspPorts.at(i).bind(&l3cache_->MemRspPorts.at(i));
+  }
+
+  // hierarchical-Z buffer shared by the raster and om units
+  hiz_buffer_ = std::make_shared<HiZBuffer>(arch.hiz_enabled(), RASTER_BLOCK_LOGSIZE);
 
   // create clusters
   for (uint32_t i = 0; i < arch.num_clusters(); ++i) {
@@ -59,16 +95,23 @@ ProcessorImpl::ProcessorImpl(const Arch& arch)
   }
 
   // set up memory profiling
-  memsim_->MemReqPort.tx_callback([&](const MemReq& req, uint64_t cycle){
-    __unused (cycle);
-    perf_mem_reads_   += !req.write;
-    perf_mem_writes_  += req.write;
-    perf_mem_pending_reads_ += !req.write;
-  });
-  memsim_->MemRspPort.tx_callback([&](const MemRsp&, uint64_t cycle){
-    __unused (cycle);
-    --perf_mem_pending_reads_;
-  });
+  mem_timeline_ = MemTimeline::Create("dram");
+  for (uint32_t i = 0; i < arch.memory_banks(); ++i) {
+    memsim_->MemReqPorts.at(i).tx_callback([&, i](const MemReq& req, uint64_t cycle){
+      perf_mem_reads_   += !req.write;
+      perf_mem_writes_  += req.write;
+      perf_mem_pending_reads_ += !req.write;
+      if (mem_timeline_) {
+        mem_timeline_->request(i, req, cycle);
+      }
+    });
+    memsim_->MemRspPorts.at(i).tx_callback([&, i](const MemRsp& rsp, uint64_t cycle){
+      --perf_mem_pending_reads_;
+      if (mem_timeline_) {
+        mem_timeline_->response(i, rsp, cycle);
+      }
+    });
+  }
 
 #ifndef NDEBUG
   // dump device configuration
@@ -80,17 +123,46 @@ ProcessorImpl::ProcessorImpl(const Arch& arch)
             << ", socket_size=" << arch.socket_size()
             << ", local_mem_base=0x" << std::hex << arch.local_mem_base() << std::dec
             << ", num_barriers=" << arch.num_barriers()
+            << ", dcache_size=" << (arch.dcache().enabled ? arch.dcache().size : 0)
+            << ", l2cache_size=" << (arch.l2cache().enabled ? arch.l2cache().size : 0)
+            << ", l3cache_size=" << (arch.l3cache().enabled ? arch.l3cache().size : 0)
+            << ", memory_banks=" << arch.memory_banks()
             << std::endl;
 #endif
   // reset the device
+  SimPlatform::instance().reset();
   this->reset();
 }
 
 ProcessorImpl::~ProcessorImpl() {
+#ifdef PERF_ENABLE
+  // dump memory channels utilization
+  for (uint32_t i = 0; i < arch_.memory_banks(); ++i) {
+    auto& perf = memsim_->perf_stats(i);
+    auto requests = perf.reads + perf.writes;
+    auto cycles = SimPlatform::instance().cycles();
+    std::cout << std::dec << "PERF: dram-ch" << i
+              << ": reads=" << perf.reads
+              << ", writes=" << perf.writes
+              << ", bandwidth=" << (cycles ? (double(requests * MEM_BLOCK_SIZE) / cycles) : 0) << " B/cycle"
+              << ", queue latency=" << (requests ? (perf.queue_latency / requests) : 0) << " cycles"
+              << ", queue stalls=" << perf.queue_stalls
+              << ", row hit rate=" << (requests ? (perf.row_hits * 100 / requests) : 0) << "%"
+              << std::endl;
+  }
+  // cache maintenance runs outside the launches, it is not in their cycles
+  if (perf_flush_cycles_ != 0) {
+    std::cout << std::dec << "PERF: cache maintenance"
+              << ": cycles=" << perf_flush_cycles_
+              << ", writebacks=" << perf_flush_writebacks_
+              << std::endl;
+  }
+#endif
   SimPlatform::instance().finalize();
 }
 
 void ProcessorImpl::attach_ram(RAM* ram) {
+  hiz_buffer_->attach_ram(ram);
   for (auto cluster : clusters_) {
     cluster->attach_ram(ram);
   }
@@ -100,8 +172,21 @@ void ProcessorImpl::run() {
   SimPlatform::instance().reset();
   this->reset();
 
+  if (profiler_) {
+    profiler_->start();
+  }
+
+  if (sampler_) {
+    sampler_->start();
+  }
+
+  perf_regions_.start();
+
   bool done;
   do {
+    if (tracer_) {
+      tracer_->tick(SimPlatform::instance().cycles());
+    }
     SimPlatform::instance().tick();
     done = true;
     for (auto cluster : clusters_) {
@@ -111,27 +196,254 @@ void ProcessorImpl::run() {
       }
     }
     perf_mem_latency_ += perf_mem_pending_reads_;
+    if (sampler_ && (SimPlatform::instance().cycles() % sampler_->interval()) == 0) {
+      this->sample();
+    }
   } while (!done);
+
+  // the final counters are read after the last cycle
+  perf_stats_cycle_ = uint64_t(-1);
+
+  // flush the last partial interval
+  if (sampler_ && (SimPlatform::instance().cycles() % sampler_->interval()) != 0) {
+    this->sample();
+  }
+
+  perf_regions_.report();
+
+  if (tracer_) {
+    tracer_->stop();
+  }
+
+  // the next launch continues the timeline
+  if (auto timeline = Timeline::instance()) {
+    timeline->stop(SimPlatform::instance().cycles());
+  }
 }
 
 void ProcessorImpl::reset() {
+  hiz_buffer_->configure(dcrs_.raster_dcrs, dcrs_.om_dcrs);
   perf_mem_reads_ = 0;
   perf_mem_writes_ = 0;
   perf_mem_latency_ = 0;
   perf_mem_pending_reads_ = 0;
+  perf_stats_cycle_ = uint64_t(-1);
+}
+
+void ProcessorImpl::maintain_caches(bool invalidate) {
+  auto start_cycles = SimPlatform::instance().cycles();
+  auto start_mem_writes = perf_mem_writes_;
+  uint64_t start_writebacks, start_arrivals;
+  this->flush_counts(&start_writebacks, &start_arrivals);
+
+  // one level at a time from the top, the next level starts once the upper
+  // write-backs have reached it
+  flush_invalidate_ = invalidate;
+  for (uint32_t level = 0; level < CACHE_FLUSH_LEVELS; ++level) {
+    this->flush_caches(level);
+    while (!this->caches_flushed(level)) {
+      SimPlatform::instance().tick();
+    }
+  }
+
+  // the write-backs that left the last level must reach memory
+  uint64_t writebacks, arrivals;
+  this->flush_counts(&writebacks, &arrivals);
+  writebacks -= start_writebacks;
+  auto mem_writes = writebacks - (arrivals - start_arrivals);
+  while ((perf_mem_writes_ - start_mem_writes) < mem_writes) {
+    SimPlatform::instance().tick();
+  }
+
+  auto cycles = SimPlatform::instance().cycles() - start_cycles;
+  perf_flush_cycles_ += cycles;
+  perf_flush_writebacks_ += writebacks;
+#ifdef PERF_ENABLE
+  std::cout << std::dec << "PERF: cache " << (invalidate ? "invalidate" : "flush")
+            << ": cycles=" << cycles
+            << ", writebacks=" << writebacks
+            << std::endl;
+#endif
+}
+
+void ProcessorImpl::flush_caches(uint32_t level) {
+  this->flush_counts(&flush_writebacks_, &flush_arrivals_);
+  if (level < 2) {
+    for (auto cluster : clusters_) {
+      cluster->flush_caches(level, flush_invalidate_);
+    }
+  } else {
+    l3cache_->flush(flush_invalidate_);
+  }
+}
+
+bool ProcessorImpl::caches_flushed(uint32_t level) const {
+  if (level < 2) {
+    for (auto cluster : clusters_) {
+      if (cluster->flushing_caches(level))
+        return false;
+    }
+  } else if (l3cache_->flushing()) {
+    return false;
+  }
+  // write-backs to memory need no ordering
+  bool cached_below = (level < 1 && arch_.l2cache().enabled)
+                   || (level < 2 && arch_.l3cache().enabled);
+  if (!cached_below)
+    return true;
+  // only this level has been walking since its flush started
+  uint64_t writebacks = 0;
+  uint64_t arrivals = 0;
+  this->flush_counts(&writebacks, &arrivals);
+  return (writebacks - flush_writebacks_) == (arrivals - flush_arrivals_);
+}
+
+void ProcessorImpl::flush_counts(uint64_t* writebacks, uint64_t* arrivals) const {
+  *writebacks = l3cache_->flush_writebacks();
+  *arrivals = l3cache_->flush_arrivals();
+  for (auto cluster : clusters_) {
+    cluster->flush_counts(writebacks, arrivals);
+  }
+}
+
+void ProcessorImpl::sample() {
+  auto snapshot = sampler_->snapshot();
+  this->read_counters([&](const std::string& name, uint64_t value) {
+    snapshot.add(name, value);
+  });
+  sampler_->write(SimPlatform::instance().cycles(), snapshot);
+}
+
+void ProcessorImpl::perf_region(uint32_t id, bool begin) {
+  // counters are only read when the first warp enters or the last one leaves
+  if (begin ? !perf_regions_.enter(id) : !perf_regions_.leave(id))
+    return;
+  std::vector<uint64_t> values;
+  auto names = perf_regions_.names();
+  this->read_counters([&](const std::string& name, uint64_t value) {
+    if (names) {
+      names->push_back(name);
+    }
+    values.push_back(value);
+  });
+  auto cycle = SimPlatform::instance().cycles();
+  if (begin) {
+    perf_regions_.open(id, cycle, values);
+  } else {
+    perf_regions_.close(id, cycle, values);
+  }
+}
+
+void ProcessorImpl::read_counters(const std::function<void(const std::string&, uint64_t)>& add) const {
+  auto add_cache = [&](const char* name, const CacheSim::PerfStats& perf) {
+    std::string prefix(name);
+    add(prefix + ".reads", perf.reads);
+    add(prefix + ".writes", perf.writes);
+    add(prefix + ".read_misses", perf.read_misses);
+    add(prefix + ".write_misses", perf.write_misses);
+    add(prefix + ".bank_stalls", perf.bank_stalls);
+    add(prefix + ".mshr_stalls", perf.mshr_stalls);
+    add(prefix + ".mem_latency", perf.mem_latency);
+  };
+
+  Socket::PerfStats socket_perf;
+  Cluster::PerfStats cluster_perf;
+  LocalMem::PerfStats lmem_perf;
+  uint64_t lmem_idle_banks = 0;
+
+  // per-core counters
+  for (auto& cluster : clusters_) {
+    for (auto& socket : cluster->sockets()) {
+      for (auto& core : socket->cores()) {
+        auto& perf = core->perf_stats();
+        auto prefix = "core" + std::to_string(core->id());
+        add(prefix + ".instrs", perf.instrs);
+        add(prefix + ".warp_instrs", perf.warp_instrs);
+        add(prefix + ".sched_idle", perf.sched_idle);
+        add(prefix + ".ibuf_stalls", perf.ibuf_stalls);
+        add(prefix + ".scrb_stalls", perf.scrb_stalls);
+        add(prefix + ".loads", perf.loads);
+        add(prefix + ".stores", perf.stores);
+        add(prefix + ".load_latency", perf.load_latency);
+        add(prefix + ".ifetch_latency", perf.ifetch_latency);
+        lmem_perf += core->local_mem()->perf_stats();
+        lmem_idle_banks += core->local_mem()->idle_banks();
+      }
+      auto perf = socket->perf_stats();
+      socket_perf.icache += perf.icache;
+      socket_perf.dcache += perf.dcache;
+    }
+    auto perf = cluster->perf_stats();
+    cluster_perf.l2cache += perf.l2cache;
+    cluster_perf.raster += perf.raster;
+    cluster_perf.tex += perf.tex;
+    cluster_perf.om += perf.om;
+  }
+
+  // memory hierarchy counters, summed over all instances
+  add_cache("icache", socket_perf.icache);
+  add_cache("dcache", socket_perf.dcache);
+  add("lmem.reads", lmem_perf.reads);
+  add("lmem.writes", lmem_perf.writes);
+  add("lmem.bank_stalls", lmem_perf.bank_stalls);
+  add("lmem.idle_banks", lmem_idle_banks);
+  add_cache("l2cache", cluster_perf.l2cache);
+  add_cache("l3cache", l3cache_->perf_stats());
+  auto mem_perf = memsim_->perf_stats();
+  add("dram.reads", mem_perf.reads);
+  add("dram.writes", mem_perf.writes);
+  add("dram.queue_latency", mem_perf.queue_latency);
+  add("dram.queue_stalls", mem_perf.queue_stalls);
+  add("dram.row_hits", mem_perf.row_hits);
+
+  // graphics units
+  add("tex.reads", cluster_perf.tex.reads);
+  add("tex.latency", cluster_perf.tex.latency);
+  add("tex.stalls", cluster_perf.tex.stalls);
+  add("raster.reads", cluster_perf.raster.reads);
+  add("raster.latency", cluster_perf.raster.latency);
+  add("raster.stalls", cluster_perf.raster.stalls);
+  add("raster.stamps", cluster_perf.raster.stamps);
+  add("raster.hiz_tiles", cluster_perf.raster.hiz_tiles);
+  add("raster.hiz_stamps", cluster_perf.raster.hiz_stamps);
+  add("om.reads", cluster_perf.om.reads);
+  add("om.writes", cluster_perf.om.writes);
+  add("om.latency", cluster_perf.om.latency);
+  add("om.stalls", cluster_perf.om.stalls);
+  add("om.imm_reads", cluster_perf.om.imm_reads);
+  add("om.imm_writes", cluster_perf.om.imm_writes);
 }
 
 void ProcessorImpl::dcr_write(uint32_t addr, uint32_t value) {
+  if (addr == VX_DCR_CACHE_CTRL) {
+    // maintenance runs to completion here, between launches
+    if (value != 0) {
+      this->maintain_caches((value & VX_DCR_CACHE_CTRL_INVALIDATE) != 0);
+    }
+    return;
+  }
   dcrs_.write(addr, value);
 }
 
-ProcessorImpl::PerfStats ProcessorImpl::perf_stats() const {
-  ProcessorImpl::PerfStats perf;
+const ProcessorImpl::PerfStats& ProcessorImpl::perf_stats() const {
+  auto cycle = SimPlatform::instance().cycles();
+  if (cycle == perf_stats_cycle_)
+    return perf_stats_;
+  perf_stats_cycle_ = cycle;
+  auto& perf = perf_stats_;
+  perf = PerfStats();
   perf.mem_reads   = perf_mem_reads_;
   perf.mem_writes  = perf_mem_writes_;
   perf.mem_latency = perf_mem_latency_;
   perf.l3cache     = l3cache_->perf_stats();
-  return perf;
+  for (auto cluster : clusters_) {
+    perf.l2cache += cluster->perf_stats().l2cache;
+  }
+  perf.memsim      = memsim_->perf_stats();
+  for (uint32_t i = 0; i < arch_.memory_banks(); ++i) {
+    perf.mem_channels.push_back(memsim_->perf_stats(i));
+  }
+  return perf_stats_;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -18,13 +18,22 @@
 #include "constants.h"
 #include "dcrs.h"
 #include "cluster.h"
+#include "profiler.h"
+#include "sampler.h"
+#include "timeline.h"
+#include "perf_regions.h"
+#include "hiz_buffer.h"
+#include <functional>
 
 namespace vortex {
 
 class ProcessorImpl {
 public:
   struct PerfStats {
+    CacheSim::PerfStats l2cache; // all clusters
     CacheSim::PerfStats l3cache;
+    MemSim::PerfStats memsim;
+    std::vector<MemSim::PerfStats> mem_channels;
     uint64_t mem_reads;
     uint64_t mem_writes;
     uint64_t mem_latency;
@@ -39,21 +48,62 @@ public:
 
   void dcr_write(uint32_t addr, uint32_t value);
 
-  PerfStats perf_stats() const;
+  // aggregated at most once per cycle, CSR reads in the same cycle share it
+  const PerfStats& perf_stats() const;
+
+  Profiler* profiler() const {
+    return profiler_.get();
+  }
+
+  HiZBuffer* hiz_buffer() const {
+    return hiz_buffer_.get();
+  }
+
+  // kernel region marker (vx_perf_region_begin/end)
+  void perf_region(uint32_t id, bool begin);
 
 private:
 
   void reset();
 
+  void sample();
+
+  // flushes (and optionally invalidates) all cache levels, down to memory
+  void maintain_caches(bool invalidate);
+
+  // start the maintenance walk of a cache level (0: L1, 1: L2, 2: L3)
+  void flush_caches(uint32_t level);
+
+  // the level's walks are done and their write-backs reached the next level
+  bool caches_flushed(uint32_t level) const;
+
+  void flush_counts(uint64_t* writebacks, uint64_t* arrivals) const;
+
+  // reads all the named performance counters
+  void read_counters(const std::function<void(const std::string&, uint64_t)>& add) const;
+
   const Arch& arch_;
   std::vector<std::shared_ptr<Cluster>> clusters_;
   DCRS dcrs_;
   MemSim::Ptr memsim_;
   CacheSim::Ptr l3cache_;
+  Profiler::Ptr profiler_;
+  HiZBuffer::Ptr hiz_buffer_;
+  Sampler::Ptr sampler_;
+  MemTimeline::Ptr mem_timeline_;
+  Tracer* tracer_;
+  PerfRegions perf_regions_;
   uint64_t perf_mem_reads_;
   uint64_t perf_mem_writes_;
   uint64_t perf_mem_latency_;
   uint64_t perf_mem_pending_reads_;
+  mutable PerfStats perf_stats_;
+  mutable uint64_t perf_stats_cycle_;
+  uint64_t perf_flush_cycles_;
+  uint64_t perf_flush_writebacks_;
+  bool     flush_invalidate_;
+  uint64_t flush_writebacks_;
+  uint64_t flush_arrivals_;
 };
 
 }
@@ -0,0 +1,387 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "profiler.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <elf.h>
+
+using namespace vortex;
+
+namespace {
+
+using symbol_cb_t = std::function<void(uint64_t addr, uint64_t size, bool func, const char* name)>;
+
+// walk the .symtab section of an ELF image
+template <typename Ehdr, typename Shdr, typename Sym, uint32_t (*SymType)(unsigned char)>
+bool read_symtab(const std::vector<char>& image, const symbol_cb_t& callback) {
+  if (image.size() < sizeof(Ehdr))
+    return false;
+  auto ehdr = reinterpret_cast<const Ehdr*>(image.data());
+  if (ehdr->e_shoff == 0
+   || ehdr->e_shentsize != sizeof(Shdr)
+   || ehdr->e_shoff + uint64_t(ehdr->e_shnum) * sizeof(Shdr) > image.size())
+    return false;
+  auto shdrs = reinterpret_cast<const Shdr*>(image.data() + ehdr->e_shoff);
+  for (uint32_t i = 0; i < ehdr->e_shnum; ++i) {
+    auto& symtab = shdrs[i];
+    if (symtab.sh_type != SHT_SYMTAB || symtab.sh_link >= ehdr->e_shnum)
+      continue;
+    auto& strtab = shdrs[symtab.sh_link];
+    if (symtab.sh_offset + symtab.sh_size > image.size()
+     || strtab.sh_offset + strtab.sh_size > image.size())
+      return false;
+    auto syms = reinterpret_cast<const Sym*>(image.data() + symtab.sh_offset);
+    auto strs = image.data() + strtab.sh_offset;
+    for (uint64_t j = 0, n = symtab.sh_size / sizeof(Sym); j < n; ++j) {
+      auto& sym = syms[j];
+      auto type = SymType(sym.st_info);
+      if (type != STT_FUNC && type != STT_NOTYPE)
+        continue;
+      if (sym.st_shndx == SHN_UNDEF || sym.st_shndx >= SHN_LORESERVE)
+        continue;
+      if (sym.st_name >= strtab.sh_size)
+        continue;
+      auto name = strs + sym.st_name;
+      // skip unnamed and RISC-V mapping symbols
+      if (name[0] == '\0' || name[0] == '$' || name[0] == '.')
+        continue;
+      callback(sym.st_value, sym.st_size, (type == STT_FUNC), name);
+    }
+    return true;
+  }
+  return false;
+}
+
+uint32_t elf32_st_type(unsigned char info) { return ELF32_ST_TYPE(info); }
+uint32_t elf64_st_type(unsigned char info) { return ELF64_ST_TYPE(info); }
+
+std::string csv_quote(const std::string& s) {
+  std::string out("\"");
+  for (auto c : s) {
+    if (c == '"') out += '"';
+    out += c;
+  }
+  out += '"';
+  return out;
+}
+
+}
+
+Profiler::Ptr Profiler::Create(const Arch& arch) {
+  auto prefix_s = getenv("VORTEX_PROFILE");
+  if (prefix_s == nullptr || *prefix_s == '\0')
+    return nullptr;
+  return std::make_shared<Profiler>(arch, prefix_s);
+}
+
+Profiler::Profiler(const Arch& arch, const std::string& prefix)
+  : arch_(arch)
+  , prefix_(prefix)
+{
+  auto elf_s = getenv("VORTEX_PROFILE_ELF");
+  if (elf_s && *elf_s) {
+    elf_file_ = elf_s;
+    this->load_symbols(elf_file_);
+  }
+}
+
+Profiler::~Profiler() {
+  this->dump();
+}
+
+void Profiler::start() {
+  // close the frames left open by the previous launch
+  for (auto& warp : warps_) {
+    this->unwind(warp.second, 0);
+  }
+  warps_.clear();
+}
+
+void Profiler::issue(const instr_trace_t* trace) {
+  auto& stats = pc_stats_[trace->PC];
+  ++stats.instrs;
+  stats.threads += trace->tmask.count();
+
+  auto& warp = warps_[(uint64_t(trace->cid) << 32) | trace->wid];
+  if (warp.pending_call) {
+    // first instruction of the callee
+    auto& frame = warp.stack.back();
+    frame.callee_PC = trace->PC;
+    ++call_stats_[{frame.call_PC, frame.callee_PC}].calls;
+    warp.pending_call = false;
+  }
+  ++warp.instrs;
+
+  if (trace->fu_type != FUType::ALU || trace->alu_type != AluType::BRANCH)
+    return;
+
+  // calling convention: jal/jalr linking ra or t0 is a call,
+  // jalr x0 through ra or t0 is a return.
+  auto is_link = [](const instr_trace_t::reg_t& reg) {
+    return reg.type == RegType::Integer && (reg.idx == 1 || reg.idx == 5);
+  };
+  if (trace->wb && is_link(trace->dst_reg)) {
+    warp.stack.push_back({trace->PC, 0, warp.instrs});
+    warp.pending_call = true;
+  } else if (!trace->wb
+          && is_link(trace->src_regs.at(0))
+          && trace->src_regs.at(1).type == RegType::None
+          && !warp.stack.empty()) {
+    this->unwind(warp, warp.stack.size() - 1);
+  }
+}
+
+void Profiler::scrb_stall(Word PC, FUType fu_type) {
+  auto& stats = pc_stats_[PC];
+  switch (fu_type) {
+  case FUType::ALU:
+  case FUType::SALU: ++stats.scrb_alu; break;
+  case FUType::FPU: ++stats.scrb_fpu; break;
+  case FUType::LSU: ++stats.scrb_lsu; break;
+  case FUType::SFU: ++stats.scrb_sfu; break;
+  default: assert(false);
+  }
+}
+
+void Profiler::unwind(warp_state_t& warp, size_t depth) {
+  while (warp.stack.size() > depth) {
+    auto& frame = warp.stack.back();
+    if (warp.pending_call) {
+      // the callee never issued
+      warp.pending_call = false;
+    } else {
+      call_stats_[{frame.call_PC, frame.callee_PC}].instrs += warp.instrs - frame.instrs;
+    }
+    warp.stack.pop_back();
+  }
+}
+
+void Profiler::load_symbols(const std::string& filename) {
+  std::ifstream ifs(filename, std::ios::binary);
+  if (!ifs) {
+    std::cout << "Error: cannot open profile ELF '" << filename << "'" << std::endl;
+    return;
+  }
+  std::vector<char> image((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+  std::vector<std::pair<symbol_t, bool>> symbols;
+  auto callback = [&](uint64_t addr, uint64_t size, bool func, const char* name) {
+    symbols.push_back({{Word(addr), Word(size), name}, func});
+  };
+
+  bool found = false;
+  if (image.size() >= EI_NIDENT && memcmp(image.data(), ELFMAG, SELFMAG) == 0) {
+    if (image[EI_CLASS] == ELFCLASS32) {
+      found = read_symtab<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym, elf32_st_type>(image, callback);
+    } else if (image[EI_CLASS] == ELFCLASS64) {
+      found = read_symtab<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym, elf64_st_type>(image, callback);
+    }
+  }
+  if (!found) {
+    std::cout << "Warning: no symbol table in profile ELF '" << filename << "'" << std::endl;
+    return;
+  }
+
+  // sort by address, preferring function symbols over plain labels at the same address
+  std::stable_sort(symbols.begin(), symbols.end(), [](const std::pair<symbol_t, bool>& a, const std::pair<symbol_t, bool>& b) {
+    if (a.first.addr != b.first.addr)
+      return a.first.addr < b.first.addr;
+    return a.second && !b.second;
+  });
+  for (auto& symbol : symbols) {
+    if (!symbols_.empty() && symbols_.back().addr == symbol.first.addr)
+      continue;
+    symbols_.push_back(symbol.first);
+  }
+}
+
+const Profiler::symbol_t* Profiler::find_symbol(Word PC) const {
+  auto it = std::upper_bound(symbols_.begin(), symbols_.end(), PC, [](Word addr, const symbol_t& symbol) {
+    return addr < symbol.addr;
+  });
+  if (it == symbols_.begin())
+    return nullptr;
+  --it;
+  if (it->size != 0 && PC >= it->addr + it->size)
+    return nullptr;
+  return &(*it);
+}
+
+std::string Profiler::symbolize(Word PC) const {
+  auto symbol = this->find_symbol(PC);
+  if (symbol == nullptr)
+    return "";
+  if (PC == symbol->addr)
+    return symbol->name;
+  std::stringstream ss;
+  ss << symbol->name << "+0x" << std::hex << (PC - symbol->addr);
+  return ss.str();
+}
+
+std::unordered_map<Word, std::string> Profiler::source_lines(const std::vector<Word>& PCs) const {
+  // DWARF line information is resolved by an external addr2line tool
+  std::unordered_map<Word, std::string> lines;
+  auto tool_s = getenv("VORTEX_PROFILE_ADDR2LINE");
+  if (tool_s == nullptr || *tool_s == '\0' || elf_file_.empty())
+    return lines;
+  static constexpr size_t BATCH_SIZE = 256;
+  for (size_t i = 0, n = PCs.size(); i < n; i += BATCH_SIZE) {
+    std::stringstream cmd;
+    cmd << tool_s << " -e '" << elf_file_ << "'" << std::hex;
+    size_t count = std::min(BATCH_SIZE, n - i);
+    for (size_t j = 0; j < count; ++j) {
+      cmd << " 0x" << PCs.at(i + j);
+    }
+    auto pipe = popen(cmd.str().c_str(), "r");
+    if (pipe == nullptr)
+      break;
+    char buffer[1024];
+    for (size_t j = 0; j < count && fgets(buffer, sizeof(buffer), pipe); ++j) {
+      std::string line(buffer);
+      while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+        line.pop_back();
+      }
+      if (line.compare(0, 2, "??") != 0) {
+        lines[PCs.at(i + j)] = line;
+      }
+    }
+    if (pclose(pipe) != 0) {
+      std::cout << "Warning: profile source lookup failed: " << cmd.str() << std::endl;
+      break;
+    }
+  }
+  return lines;
+}
+
+void Profiler::dump() {
+  // close frames left open at exit
+  for (auto& warp : warps_) {
+    this->unwind(warp.second, 0);
+  }
+
+  // flat profile, hottest PCs first
+  std::vector<std::pair<Word, const pc_stats_t*>> pcs;
+  for (auto& it : pc_stats_) {
+    pcs.push_back({it.first, &it.second});
+  }
+  auto cost = [](const pc_stats_t& stats) {
+    return stats.instrs + stats.ibuf_stalls + stats.scrb_stalls();
+  };
+  std::sort(pcs.begin(), pcs.end(), [&](const std::pair<Word, const pc_stats_t*>& a, const std::pair<Word, const pc_stats_t*>& b) {
+    auto ca = cost(*a.second), cb = cost(*b.second);
+    if (ca != cb)
+      return ca > cb;
+    return a.first < b.first;
+  });
+
+  std::vector<Word> PCs;
+  for (auto& pc : pcs) {
+    PCs.push_back(pc.first);
+  }
+  auto lines = this->source_lines(PCs);
+
+  auto flat_file = prefix_ + ".flat.csv";
+  std::ofstream flat(flat_file);
+  if (!flat) {
+    std::cout << "Error: cannot write profile '" << flat_file << "'" << std::endl;
+    return;
+  }
+  flat << "pc,symbol,source,instrs,threads,simt_efficiency,ibuf_stalls,scrb_alu,scrb_fpu,scrb_lsu,scrb_sfu,loads,load_latency,splits,divergent" << std::endl;
+  for (auto& pc : pcs) {
+    auto& stats = *pc.second;
+    auto line = lines.find(pc.first);
+    flat << "0x" << std::hex << pc.first << std::dec
+         << "," << csv_quote(this->symbolize(pc.first))
+         << "," << csv_quote((line != lines.end()) ? line->second : "")
+         << "," << stats.instrs
+         << "," << stats.threads
+         << "," << std::fixed << std::setprecision(3) << (stats.instrs ? (double(stats.threads) / (stats.instrs * arch_.num_threads())) : 0.0)
+         << "," << stats.ibuf_stalls
+         << "," << stats.scrb_alu
+         << "," << stats.scrb_fpu
+         << "," << stats.scrb_lsu
+         << "," << stats.scrb_sfu
+         << "," << stats.loads
+         << "," << (stats.loads ? (stats.load_latency / stats.loads) : 0)
+         << "," << stats.splits
+         << "," << stats.divergent
+         << std::endl;
+  }
+
+  // call-site profile, most expensive edges first
+  std::vector<std::pair<std::pair<Word, Word>, const call_stats_t*>> calls;
+  for (auto& it : call_stats_) {
+    calls.push_back({it.first, &it.second});
+  }
+  std::stable_sort(calls.begin(), calls.end(), [](const std::pair<std::pair<Word, Word>, const call_stats_t*>& a, const std::pair<std::pair<Word, Word>, const call_stats_t*>& b) {
+    return a.second->instrs > b.second->instrs;
+  });
+
+  auto calls_file = prefix_ + ".calls.csv";
+  std::ofstream callsite(calls_file);
+  if (!callsite) {
+    std::cout << "Error: cannot write profile '" << calls_file << "'" << std::endl;
+    return;
+  }
+  callsite << "call_pc,caller,callee_pc,callee,calls,inclusive_instrs" << std::endl;
+  for (auto& call : calls) {
+    callsite << "0x" << std::hex << call.first.first << std::dec
+             << "," << csv_quote(this->symbolize(call.first.first))
+             << ",0x" << std::hex << call.first.second << std::dec
+             << "," << csv_quote(this->symbolize(call.first.second))
+             << "," << call.second->calls
+             << "," << call.second->instrs
+             << std::endl;
+  }
+
+  // summarize the hottest functions
+  if (!symbols_.empty()) {
+    std::unordered_map<const symbol_t*, pc_stats_t> funcs;
+    for (auto& pc : pcs) {
+      auto& func = funcs[this->find_symbol(pc.first)];
+      func.instrs += pc.second->instrs;
+      func.ibuf_stalls += pc.second->ibuf_stalls;
+      func.scrb_alu += pc.second->scrb_alu;
+      func.scrb_fpu += pc.second->scrb_fpu;
+      func.scrb_lsu += pc.second->scrb_lsu;
+      func.scrb_sfu += pc.second->scrb_sfu;
+    }
+    std::vector<std::pair<const symbol_t*, pc_stats_t>> hot(funcs.begin(), funcs.end());
+    std::stable_sort(hot.begin(), hot.end(), [&](const std::pair<const symbol_t*, pc_stats_t>& a, const std::pair<const symbol_t*, pc_stats_t>& b) {
+      return cost(a.second) > cost(b.second);
+    });
+    static constexpr size_t MAX_FUNCS = 8;
+    for (size_t i = 0, n = std::min(MAX_FUNCS, hot.size()); i < n; ++i) {
+      auto& func = hot.at(i);
+      std::cout << "PROFILE: " << (func.first ? func.first->name : "??")
+                << ": instrs=" << func.second.instrs
+                << ", ibuffer stalls=" << func.second.ibuf_stalls
+                << ", scoreboard stalls=" << func.second.scrb_stalls()
+                << " (alu=" << func.second.scrb_alu
+                << ", fpu=" << func.second.scrb_fpu
+                << ", lsu=" << func.second.scrb_lsu
+                << ", sfu=" << func.second.scrb_sfu << ")"
+                << std::endl;
+    }
+  }
+  std::cout << "PROFILE: wrote " << flat_file << " and " << calls_file << std::endl;
+}
@@ -0,0 +1,145 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "types.h"
+#include "instr_trace.h"
+
+namespace vortex {
+
+// Per-PC hotspot and stall-attribution profiler.
+// Enabled by setting VORTEX_PROFILE=<prefix>; at exit it writes a flat
+// profile (<prefix>.flat.csv) and a call-site profile (<prefix>.calls.csv),
+// symbolized against VORTEX_PROFILE_ELF=<kernel.elf> when provided.
+class Profiler {
+public:
+  using Ptr = std::shared_ptr<Profiler>;
+
+  struct pc_stats_t {
+    uint64_t instrs;       // issued warp instructions
+    uint64_t threads;      // active threads of issued instructions
+    uint64_t ibuf_stalls;  // cycles blocked on a full instruction buffer
+    uint64_t scrb_alu;     // scoreboard stalls waiting on an ALU producer
+    uint64_t scrb_fpu;     // scoreboard stalls waiting on an FPU producer
+    uint64_t scrb_lsu;     // scoreboard stalls waiting on an LSU producer
+    uint64_t scrb_sfu;     // scoreboard stalls waiting on an SFU producer
+    uint64_t loads;        // completed warp loads
+    uint64_t load_latency; // total warp load latency in cycles
+    uint64_t splits;       // executed SPLITs
+    uint64_t divergent;    // divergent SPLITs
+
+    pc_stats_t()
+      : instrs(0)
+      , threads(0)
+      , ibuf_stalls(0)
+      , scrb_alu(0)
+      , scrb_fpu(0)
+      , scrb_lsu(0)
+      , scrb_sfu(0)
+      , loads(0)
+      , load_latency(0)
+      , splits(0)
+      , divergent(0)
+    {}
+
+    uint64_t scrb_stalls() const {
+      return scrb_alu + scrb_fpu + scrb_lsu + scrb_sfu;
+    }
+  };
+
+  struct call_stats_t {
+    uint64_t calls;  // dynamic warp-level calls
+    uint64_t instrs; // inclusive issued warp instructions
+
+    call_stats_t() : calls(0), instrs(0) {}
+  };
+
+  // returns nullptr when profiling is disabled
+  static Ptr Create(const Arch& arch);
+
+  Profiler(const Arch& arch, const std::string& prefix);
+  ~Profiler();
+
+  // restart call-stack tracking at kernel launch
+  void start();
+
+  void issue(const instr_trace_t* trace);
+
+  void ibuf_stall(Word PC) {
+    ++pc_stats_[PC].ibuf_stalls;
+  }
+
+  void scrb_stall(Word PC, FUType fu_type);
+
+  void load(Word PC, uint64_t latency) {
+    auto& stats = pc_stats_[PC];
+    ++stats.loads;
+    stats.load_latency += latency;
+  }
+
+  void split(Word PC, bool divergent) {
+    auto& stats = pc_stats_[PC];
+    ++stats.splits;
+    stats.divergent += divergent;
+  }
+
+private:
+
+  struct frame_t {
+    Word     call_PC;
+    Word     callee_PC;
+    uint64_t instrs;
+  };
+
+  struct warp_state_t {
+    std::vector<frame_t> stack;
+    uint64_t instrs;
+    bool     pending_call;
+
+    warp_state_t() : instrs(0), pending_call(false) {}
+  };
+
+  struct symbol_t {
+    Word        addr;
+    Word        size;
+    std::string name;
+  };
+
+  void unwind(warp_state_t& warp, size_t depth);
+
+  void load_symbols(const std::string& filename);
+
+  const symbol_t* find_symbol(Word PC) const;
+
+  std::string symbolize(Word PC) const;
+
+  std::unordered_map<Word, std::string> source_lines(const std::vector<Word>& PCs) const;
+
+  void dump();
+
+  const Arch& arch_;
+  std::string prefix_;
+  std::string elf_file_;
+  std::unordered_map<Word, pc_stats_t> pc_stats_;
+  std::map<std::pair<Word, Word>, call_stats_t> call_stats_;
+  std::unordered_map<uint64_t, warp_state_t> warps_;
+  std::vector<symbol_t> symbols_;
+};
+
+}
@@ -23,6 +23,19 @@ using namespace vortex;
 
 #define STAMP_POOL_MAX_SIZE   1024
 
+// Depth margin, in depth buffer LSBs, covering the interpolation rounding of
+// the fragment depth. Depth attributes use the depth buffer format (FloatA has
+// VX_OM_DEPTH_BITS fraction bits, so 1 LSB is 2^-24 of the depth range). The
+// shaders compute z2 + (z0 - z2) * w0 + (z1 - z2) * w1 with float weights
+// converted to fixed point: each weight is off by at most 4 LSBs (three float
+// roundings and the truncating conversion) and each product truncates once,
+// so a fragment can leave the vertex depth range by at most 10 LSBs (2 LSBs
+// measured on random weights). 64 LSBs keep a 6x margin and give up about
+// 4e-6 of the depth range in culling.
+#define HIZ_DEPTH_BIAS        64
+
+static_assert(graphics::FloatA::FRAC == VX_OM_DEPTH_BITS, "depth attributes must use the depth buffer format");
+
 struct prim_mem_trace_t {
   uint64_t              prim_addr;
   std::vector<uint64_t> edge_addrs;
@@ -80,10 +93,16 @@ public:
   Rasterizer(uint32_t raster_index,
              uint32_t raster_count,
              uint32_t tile_logsize,
-             uint32_t block_logsize)
+             uint32_t block_logsize,
+             HiZBuffer* hiz_buffer,
+             RasterUnit::PerfStats& perf_stats)
     : graphics::Rasterizer(shaderFunctionCB, this, tile_logsize, block_logsize)
     , raster_index_(raster_index)
     , raster_count_(raster_count)
+    , hiz_buffer_(hiz_buffer)
+    , perf_stats_(perf_stats)
+    , hiz_enabled_(false)
+    , hiz_zmin_(0)
     , stamps_head_(nullptr)
     , stamps_tail_(nullptr)
     , stamps_size_(0)
@@ -203,14 +222,40 @@ private:
       pbuf_addr += 4;
     }
 
+    // get the primitive depth range for the hierarchical-Z test
+    hiz_enabled_ = false;
+    if (hiz_buffer_->enabled()) {
+      graphics::rast_attrib_t z;
+      auto attr_addr = pbuf_baseaddr_ + pid_ * pbuf_stride_ + offsetof(graphics::rast_prim_t, attribs.z);
+      mem_->read(&z, attr_addr, sizeof(z));
+      for (int i = 0; i < 3; ++i) {
+        prim_trace.edge_addrs.push_back(attr_addr + i * 4);
+      }
+      // fragments interpolate the vertex depths z2 + (z0 - z2) * b0 + (z1 - z2) * b1
+      int64_t z0 = int64_t(z.x.data()) + z.z.data();
+      int64_t z1 = int64_t(z.y.data()) + z.z.data();
+      int64_t z2 = z.z.data();
+      int64_t zmin = std::min({z0, z1, z2}) - HIZ_DEPTH_BIAS;
+      int64_t zmax = std::max({z0, z1, z2}) + HIZ_DEPTH_BIAS;
+      // the OM unit truncates the depth, so skip primitives that could wrap
+      if (zmin >= 0 && zmax <= VX_OM_DEPTH_MASK) {
+        hiz_zmin_ = uint32_t(zmin);
+        hiz_enabled_ = true;
+      }
+    }
+
     /*printf("*** raster%d-edges={{0x%x, 0x%x, 0x%x}, {0x%x, 0x%x, 0x%x}, {0x%x, 0x%x, 0x%x}}\n",
       raster_index_,
       edges[0].x.data(), edges[0].y.data(), edges[0].z.data(),
       edges[1].x.data(), edges[1].y.data(), edges[1].z.data(),
       edges[2].x.data(), edges[2].y.data(), edges[2].z.data());*/
 
-    // Render the primitive
-    this->renderPrimitive(x, y, pid_, edges);
+    // Render the primitive, unless it is behind the whole tile
+    if (hiz_enabled_ && hiz_buffer_->occluded(x, y, tile_logsize_, hiz_zmin_)) {
+      ++perf_stats_.hiz_tiles;
+    } else {
+      this->renderPrimitive(x, y, pid_, edges);
+    }
 
     // printf("*** raster%d: generated %d stamps\n", raster_index_, stamps_size_);
     prim_trace.stamps = stamps_size_;
@@ -229,6 +274,15 @@ private:
   }
 
   void enqueue_stamp(uint32_t pos_mask, graphics::vec3e_t bcoords[4], uint32_t pid) {
+    if (hiz_enabled_) {
+      uint32_t x = ((pos_mask >> 4) & ((1 << (VX_RASTER_DIM_BITS-1))-1)) << 1;
+      uint32_t y = (pos_mask >> (4 + VX_RASTER_DIM_BITS-1)) << 1;
+      if (hiz_buffer_->occluded(x, y, 1, hiz_zmin_)) {
+        ++perf_stats_.hiz_stamps;
+        return;
+      }
+    }
+    ++perf_stats_.stamps;
     auto stamp = new Stamp(pos_mask, bcoords, pid);
     stamp->next_ = stamps_tail_;
     stamp->prev_ = nullptr;
@@ -263,6 +317,10 @@ private:
 
   uint32_t raster_index_;
   uint32_t raster_count_;
+  HiZBuffer* hiz_buffer_;
+  RasterUnit::PerfStats& perf_stats_;
+  bool     hiz_enabled_;
+  uint32_t hiz_zmin_;
   RAM*     mem_;
   uint32_t num_tiles_;
   uint64_t tbuf_baseaddr_;
@@ -293,11 +351,12 @@ public:
        uint32_t raster_count,
        const Arch &arch,
        const DCRS& dcrs,
-       const Config& config)
+       const Config& config,
+       HiZBuffer* hiz_buffer)
     : simobject_(simobject)
     , arch_(arch)
     , dcrs_(dcrs)
-    , rasterizer_(raster_index, raster_count, config.tile_logsize, config.block_logsize)
+    , rasterizer_(raster_index, raster_count, config.tile_logsize, config.block_logsize, hiz_buffer, perf_stats_)
     , pending_reqs_(RASTER_MEM_QUEUE_SIZE)
     , mem_trace_state_(e_mem_trace_state::header)
   {}
@@ -509,13 +568,14 @@ RasterUnit::RasterUnit(const SimContext& ctx,
                        uint32_t cores_per_unit,
                        const Arch &arch,
                        const DCRS& dcrs,
-                       const Config& config)
+                       const Config& config,
+                       HiZBuffer* hiz_buffer)
   : SimObject<RasterUnit>(ctx, name)
   , MemReqs(this)
   , MemRsps(this)
   , Input(this)
   , Output(this)
-  , impl_(new Impl(this, index, cores_per_unit, arch, dcrs, config))
+  , impl_(new Impl(this, index, cores_per_unit, arch, dcrs, config, hiz_buffer))
 {}
 
 RasterUnit::~RasterUnit() {
@@ -20,6 +20,7 @@
 #include "types.h"
 #include "graphics.h"
 #include "pipeline.h"
+#include "hiz_buffer.h"
 
 #define FIXEDPOINT_RASTERIZER
 
@@ -39,17 +40,26 @@ public:
     uint64_t reads;
     uint64_t latency;
     uint64_t stalls;
+    uint64_t stamps;
+    uint64_t hiz_tiles;
+    uint64_t hiz_stamps;
 
     PerfStats()
       : reads(0)
       , latency(0)
       , stalls(0)
+      , stamps(0)
+      , hiz_tiles(0)
+      , hiz_stamps(0)
     {}
 
     PerfStats& operator+=(const PerfStats& rhs) {
-      this->reads   += rhs.reads;
-      this->latency += rhs.latency;
-      this->stalls  += rhs.stalls;
+      this->reads      += rhs.reads;
+      this->latency    += rhs.latency;
+      this->stalls     += rhs.stalls;
+      this->stamps     += rhs.stamps;
+      this->hiz_tiles  += rhs.hiz_tiles;
+      this->hiz_stamps += rhs.hiz_stamps;
       return *this;
     }
   };
@@ -73,7 +83,8 @@ public:
             uint32_t raster_count,
             const Arch &arch,
             const DCRS& dcrs,
-            const Config& config);
+            const Config& config,
+            HiZBuffer* hiz_buffer);
 
   ~RasterUnit();
 
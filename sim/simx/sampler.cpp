@@ -0,0 +1,106 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sampler.h"
+#include <iostream>
+#include <stdlib.h>
+#include <assert.h>
+
+using namespace vortex;
+
+Sampler::Ptr Sampler::Create() {
+  auto file_s = getenv("VORTEX_PERF_SAMPLES");
+  if (file_s == nullptr || *file_s == '\0')
+    return nullptr;
+  uint64_t interval = 1000;
+  auto interval_s = getenv("VORTEX_PERF_INTERVAL");
+  if (interval_s && *interval_s) {
+    interval = strtoull(interval_s, nullptr, 0);
+    if (interval == 0) {
+      std::cout << "Error: invalid VORTEX_PERF_INTERVAL=" << interval_s << std::endl;
+      std::abort();
+    }
+  }
+  return std::make_shared<Sampler>(file_s, interval);
+}
+
+Sampler::Sampler(const std::string& filename, uint64_t interval)
+  : filename_(filename)
+  , interval_(interval)
+  , binary_(filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".bin") == 0)
+  , ofs_(filename, binary_ ? (std::ios::out | std::ios::binary) : std::ios::out)
+  , launch_(0)
+  , header_(false)
+{
+  if (!ofs_) {
+    std::cout << "Error: cannot open samples file '" << filename << "'" << std::endl;
+    std::abort();
+  }
+}
+
+Sampler::~Sampler() {
+  ofs_.flush();
+}
+
+void Sampler::start() {
+  prev_.assign(names_.size(), 0);
+  ++launch_;
+}
+
+void Sampler::write_header() {
+  if (binary_) {
+    // magic, column count, then the null-terminated column names
+    uint32_t num_columns = 2 + names_.size();
+    ofs_.write("VXSAMPLE", 8);
+    ofs_.write(reinterpret_cast<const char*>(&num_columns), sizeof(num_columns));
+    ofs_.write("launch", 7);
+    ofs_.write("cycle", 6);
+    for (auto& name : names_) {
+      ofs_.write(name.c_str(), name.size() + 1);
+    }
+  } else {
+    ofs_ << "launch,cycle";
+    for (auto& name : names_) {
+      ofs_ << "," << name;
+    }
+    ofs_ << std::endl;
+  }
+  header_ = true;
+}
+
+void Sampler::write(uint64_t cycle, const Snapshot& snapshot) {
+  auto& values = snapshot.values_;
+  assert(values.size() == names_.size());
+  if (!header_) {
+    this->write_header();
+  }
+  prev_.resize(values.size(), 0);
+
+  // write the increments since the previous sample
+  if (binary_) {
+    uint64_t launch = launch_;
+    ofs_.write(reinterpret_cast<const char*>(&launch), sizeof(uint64_t));
+    ofs_.write(reinterpret_cast<const char*>(&cycle), sizeof(uint64_t));
+    for (size_t i = 0, n = values.size(); i < n; ++i) {
+      uint64_t delta = values[i] - prev_[i];
+      ofs_.write(reinterpret_cast<const char*>(&delta), sizeof(uint64_t));
+    }
+  } else {
+    ofs_ << launch_ << "," << cycle;
+    for (size_t i = 0, n = values.size(); i < n; ++i) {
+      ofs_ << "," << (values[i] - prev_[i]);
+    }
+    ofs_ << "\n";
+  }
+  prev_ = values;
+}
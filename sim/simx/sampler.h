@@ -0,0 +1,83 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace vortex {
+
+// Interval sampling of performance counters.
+// Enabled by setting VORTEX_PERF_SAMPLES=<file>; every VORTEX_PERF_INTERVAL
+// cycles (default 1000) the processor snapshots its counters and the sampler
+// streams their per-interval increments as CSV, or as packed 64-bit records
+// when the file name ends in ".bin".
+class Sampler {
+public:
+  using Ptr = std::shared_ptr<Sampler>;
+
+  // collects the current cumulative counter values
+  class Snapshot {
+  public:
+    void add(const std::string& name, uint64_t value) {
+      if (names_)
+        names_->push_back(name);
+      values_.push_back(value);
+    }
+
+  private:
+    Snapshot(std::vector<std::string>* names) : names_(names) {}
+
+    std::vector<std::string>* names_;
+    std::vector<uint64_t> values_;
+
+    friend class Sampler;
+  };
+
+  // returns nullptr when sampling is disabled
+  static Ptr Create();
+
+  Sampler(const std::string& filename, uint64_t interval);
+  ~Sampler();
+
+  uint64_t interval() const {
+    return interval_;
+  }
+
+  // start of a kernel launch, counters restart from zero
+  void start();
+
+  Snapshot snapshot() {
+    return Snapshot(names_.empty() ? &names_ : nullptr);
+  }
+
+  void write(uint64_t cycle, const Snapshot& snapshot);
+
+private:
+
+  void write_header();
+
+  std::string filename_;
+  uint64_t interval_;
+  bool binary_;
+  std::ofstream ofs_;
+  std::vector<std::string> names_;
+  std::vector<uint64_t> prev_;
+  uint32_t launch_;
+  bool header_;
+};
+
+}
@@ -38,19 +38,25 @@ Socket::Socket(const SimContext& ctx,
   char sname[100];
   snprintf(sname, 100, "socket%d-icaches", socket_id);
   icaches_ = CacheCluster::Create(sname, cores_per_socket, NUM_ICACHES, 1, CacheSim::Config{
-    !ICACHE_ENABLED,
-    log2ceil(ICACHE_SIZE),  // C
+    !arch.icache().enabled,
+    uint8_t(log2ceil(arch.icache().size)), // C
     log2ceil(L1_LINE_SIZE), // L
     log2ceil(sizeof(uint32_t)), // W
-    log2ceil(ICACHE_NUM_WAYS),// A
-    1,                      // B
+    uint8_t(log2ceil(arch.icache().num_ways)), // A
+    uint8_t(log2ceil(arch.icache().num_banks)), // B
     XLEN,                   // address bits
     1,                      // number of ports
     1,                      // number of inputs
+    1,                      // memory ports
     false,                  // write-back
     false,                  // write response
-    (uint8_t)arch.num_warps(), // mshr size
+    arch.icache().mshr_size, // mshr size
     2,                      // pipeline latency
+    AddrHash(L1_INDEX_HASH), // index hashing
+    L1_VICTIM_SIZE,         // victim cache size
+    InclusionPolicy::Inclusive, // inclusion policy
+    false,                  // evict clean lines
+    0,                      // atomic latency
   });
 
   icaches_->MemReqPort.bind(&icache_mem_req_port);
@@ -58,19 +64,25 @@ Socket::Socket(const SimContext& ctx,
 
   snprintf(sname, 100, "socket%d-dcaches", socket_id);
   dcaches_ = CacheCluster::Create(sname, cores_per_socket, NUM_DCACHES, DCACHE_NUM_REQS, CacheSim::Config{
-    !DCACHE_ENABLED,
-    log2ceil(DCACHE_SIZE),  // C
+    !arch.dcache().enabled,
+    uint8_t(log2ceil(arch.dcache().size)), // C
     log2ceil(L1_LINE_SIZE), // L
     log2ceil(DCACHE_WORD_SIZE), // W
-    log2ceil(DCACHE_NUM_WAYS),// A
-    log2ceil(DCACHE_NUM_BANKS), // B
+    uint8_t(log2ceil(arch.dcache().num_ways)), // A
+    uint8_t(log2ceil(arch.dcache().num_banks)), // B
     XLEN,                   // address bits
     1,                      // number of ports
     DCACHE_NUM_REQS,        // number of inputs
+    1,                      // memory ports
     DCACHE_WRITEBACK,       // write-back
     false,                  // write response
-    DCACHE_MSHR_SIZE,       // mshr size
+    arch.dcache().mshr_size, // mshr size
     2,                      // pipeline latency
+    AddrHash(L1_INDEX_HASH), // index hashing
+    L1_VICTIM_SIZE,         // victim cache size
+    InclusionPolicy::Inclusive, // inclusion policy
+    false,                  // evict clean lines
+    0,                      // atomic latency
   });
 
   dcaches_->MemReqPort.bind(&dcache_mem_req_port);
@@ -124,6 +136,20 @@ bool Socket::running() const {
   return false;
 }
 
+void Socket::flush_caches(bool invalidate) {
+  icaches_->flush(invalidate);
+  dcaches_->flush(invalidate);
+}
+
+bool Socket::flushing_caches() const {
+  return icaches_->flushing() || dcaches_->flushing();
+}
+
+void Socket::flush_counts(uint64_t* writebacks, uint64_t* arrivals) const {
+  *writebacks += icaches_->flush_writebacks() + dcaches_->flush_writebacks();
+  *arrivals += icaches_->flush_arrivals() + dcaches_->flush_arrivals();
+}
+
 int Socket::get_exitcode() const {
   int exitcode = 0;
   for (auto& core : cores_) {
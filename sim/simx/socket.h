@@ -71,7 +71,18 @@ public:
 
   void resume(uint32_t core_id);
 
+  void flush_caches(bool invalidate);
+
+  bool flushing_caches() const;
+
+  // adds the flush write-backs issued and received by the socket caches
+  void flush_counts(uint64_t* writebacks, uint64_t* arrivals) const;
+
   PerfStats perf_stats() const;
+
+  const std::vector<Core::Ptr>& cores() const {
+    return cores_;
+  }
   
 private:
   uint32_t                socket_id_;
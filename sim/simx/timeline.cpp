@@ -0,0 +1,177 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "timeline.h"
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <util.h>
+
+using namespace vortex;
+
+Timeline* Timeline::instance() {
+  static std::unique_ptr<Timeline> s_inst([]()->Timeline* {
+    auto file_s = getenv("VORTEX_TIMELINE");
+    if (file_s == nullptr || *file_s == '\0')
+      return nullptr;
+    return new Timeline(file_s);
+  }());
+  return s_inst.get();
+}
+
+Timeline::Timeline(const std::string& filename)
+  : ofs_(filename)
+  , start_cycle_(0)
+  , end_cycle_(-1)
+  , offset_(0)
+  , next_pid_(0x10000)
+  , next_id_(0)
+{
+  if (!ofs_) {
+    std::cout << "Error: cannot open timeline file '" << filename << "'" << std::endl;
+    std::abort();
+  }
+
+  auto cycles_s = getenv("VORTEX_TIMELINE_CYCLES");
+  if (cycles_s && *cycles_s) {
+    std::string cycles(cycles_s);
+    auto colon = cycles.find(':');
+    if (colon != 0) {
+      start_cycle_ = std::stoull(cycles.substr(0, colon));
+    }
+    if (colon != std::string::npos && colon + 1 < cycles.size()) {
+      end_cycle_ = std::stoull(cycles.substr(colon + 1));
+    }
+  }
+
+  auto cores_s = getenv("VORTEX_TIMELINE_CORES");
+  if (cores_s && *cores_s) {
+    cores_ = parseIdList(cores_s);
+  }
+
+  ofs_ << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+  ofs_ << "{\"ph\": \"M\", \"pid\": 0, \"name\": \"process_name\", \"args\": {\"name\": \"vortex\"}}";
+}
+
+Timeline::~Timeline() {
+  ofs_ << "\n]}\n";
+}
+
+void Timeline::stop(uint64_t cycles) {
+  offset_ += cycles;
+}
+
+uint32_t Timeline::add_process(const std::string& name) {
+  auto pid = next_pid_++;
+  ofs_ << ",\n{\"ph\": \"M\", \"pid\": " << pid << ", \"name\": \"process_name\", \"args\": {\"name\": \"" << name << "\"}}";
+  return pid;
+}
+
+void Timeline::event(const char* ph,
+                     uint32_t pid,
+                     uint32_t tid,
+                     const char* cat,
+                     uint64_t id,
+                     const std::string& name,
+                     uint64_t ts,
+                     const std::string& args) {
+  ofs_ << ",\n{\"ph\": \"" << ph << "\", \"cat\": \"" << cat << "\", \"id\": \"0x" << std::hex << id << std::dec
+       << "\", \"name\": \"" << name << "\", \"pid\": " << pid << ", \"tid\": " << tid << ", \"ts\": " << (ts + offset_);
+  if (!args.empty()) {
+    ofs_ << ", \"args\": {" << args << "}";
+  }
+  ofs_ << "}";
+}
+
+void Timeline::instr(const instr_trace_t& trace, uint64_t cycle) {
+  if (!this->enabled(trace.cid, trace.sched_cycle))
+    return;
+
+  // cores are named processes and warps their threads
+  if (core_pids_.insert(trace.cid).second) {
+    ofs_ << ",\n{\"ph\": \"M\", \"pid\": " << (trace.cid + 1) << ", \"name\": \"process_name\", \"args\": {\"name\": \"core" << trace.cid << "\"}}";
+  }
+  uint32_t pid = trace.cid + 1;
+
+  std::stringstream name;
+  name << "0x" << std::hex << trace.PC;
+  std::stringstream args;
+  args << "\"uuid\": " << trace.uuid << ", \"ex\": \"" << trace.fu_type << "\", \"threads\": " << trace.tmask.count();
+
+  // the instruction span, with its pipeline stages nested
+  struct stage_t {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+  };
+  stage_t stages[] = {
+    {"fetch", trace.sched_cycle, trace.decode_cycle},
+    {"ibuffer", trace.decode_cycle, trace.issue_cycle},
+    {"operands", trace.issue_cycle, trace.dispatch_cycle},
+    {"execute", trace.dispatch_cycle, cycle},
+  };
+  this->event("b", pid, trace.wid, "instr", trace.uuid, name.str(), trace.sched_cycle, args.str());
+  for (auto& stage : stages) {
+    this->event("b", pid, trace.wid, "instr", trace.uuid, stage.name, stage.start, "");
+    this->event("e", pid, trace.wid, "instr", trace.uuid, stage.name, stage.end, "");
+  }
+  this->event("e", pid, trace.wid, "instr", trace.uuid, name.str(), cycle, "");
+}
+
+void Timeline::span(uint32_t pid,
+                    uint32_t tid,
+                    const char* cat,
+                    const std::string& name,
+                    uint64_t start,
+                    uint64_t end,
+                    const std::string& args) {
+  // memory span ids are disjoint from instruction uuids
+  uint64_t id = (uint64_t(1) << 63) | next_id_++;
+  this->event("b", pid, tid, cat, id, name, start, args);
+  this->event("e", pid, tid, cat, id, name, end, "");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemTimeline::Ptr MemTimeline::Create(const std::string& name) {
+  auto timeline = Timeline::instance();
+  if (timeline == nullptr)
+    return nullptr;
+  return std::make_shared<MemTimeline>(timeline, name);
+}
+
+MemTimeline::MemTimeline(Timeline* timeline, const std::string& name)
+  : timeline_(timeline)
+  , pid_(timeline->add_process(name))
+{}
+
+void MemTimeline::request(uint32_t port, const MemReq& req, uint64_t cycle) {
+  // only requests expecting a response are traced
+  if ((req.write && !req.atomic) || req.evict)
+    return;
+  if (!timeline_->enabled(req.cid, cycle))
+    return;
+  pending_[(uint64_t(port) << 32) | req.tag] = {req, cycle};
+}
+
+void MemTimeline::response(uint32_t port, const MemRsp& rsp, uint64_t cycle) {
+  auto it = pending_.find((uint64_t(port) << 32) | rsp.tag);
+  if (it == pending_.end())
+    return;
+  auto& req = it->second.req;
+  std::stringstream args;
+  args << "\"addr\": \"0x" << std::hex << req.addr << std::dec << "\", \"cid\": " << req.cid
+       << ", \"uuid\": " << req.uuid << ", \"type\": \"" << req.type << "\"";
+  timeline_->span(pid_, port, "mem", (req.atomic ? "atomic" : "read"), it->second.cycle, cycle, args.str());
+  pending_.erase(it);
+}
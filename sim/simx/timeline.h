@@ -0,0 +1,110 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include "types.h"
+#include "instr_trace.h"
+
+namespace vortex {
+
+// Timeline trace writer, in the Chrome Trace Event JSON format
+// (chrome://tracing, ui.perfetto.dev). Enabled by setting VORTEX_TIMELINE=<file>,
+// with optional VORTEX_TIMELINE_CYCLES=<start>:<end> and
+// VORTEX_TIMELINE_CORES=<list> (e.g. "0,2-3") filters. One cycle maps to 1us.
+class Timeline {
+public:
+  // returns nullptr when tracing is disabled
+  static Timeline* instance();
+
+  ~Timeline();
+
+  // end of a kernel launch, the next one continues the timeline
+  void stop(uint64_t cycles);
+
+  bool enabled(uint32_t cid, uint64_t cycle) const {
+    return (cores_.empty() || cores_.count(cid))
+        && (cycle + offset_) >= start_cycle_
+        && (cycle + offset_) < end_cycle_;
+  }
+
+  // registers a named timeline process, returns its id
+  uint32_t add_process(const std::string& name);
+
+  // instruction lifetime, from schedule to commit
+  void instr(const instr_trace_t& trace, uint64_t cycle);
+
+  // asynchronous span on a process track
+  void span(uint32_t pid,
+            uint32_t tid,
+            const char* cat,
+            const std::string& name,
+            uint64_t start,
+            uint64_t end,
+            const std::string& args);
+
+private:
+
+  Timeline(const std::string& filename);
+
+  void event(const char* ph,
+             uint32_t pid,
+             uint32_t tid,
+             const char* cat,
+             uint64_t id,
+             const std::string& name,
+             uint64_t ts,
+             const std::string& args);
+
+  std::ofstream ofs_;
+  std::unordered_set<uint32_t> cores_;
+  std::unordered_set<uint32_t> core_pids_;
+  uint64_t start_cycle_;
+  uint64_t end_cycle_;
+  uint64_t offset_;
+  uint32_t next_pid_;
+  uint64_t next_id_;
+};
+
+// pairs memory requests with their responses to emit timeline spans
+class MemTimeline {
+public:
+  using Ptr = std::shared_ptr<MemTimeline>;
+
+  // returns nullptr when tracing is disabled
+  static Ptr Create(const std::string& name);
+
+  MemTimeline(Timeline* timeline, const std::string& name);
+
+  void request(uint32_t port, const MemReq& req, uint64_t cycle);
+
+  void response(uint32_t port, const MemRsp& rsp, uint64_t cycle);
+
+private:
+  struct pending_t {
+    MemReq   req;
+    uint64_t cycle;
+  };
+
+  Timeline* timeline_;
+  uint32_t pid_;
+  std::unordered_map<uint64_t, pending_t> pending_;
+};
+
+}
@@ -0,0 +1,223 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tracer.h"
+#include <iostream>
+#include <memory>
+#include <string.h>
+#include <stdlib.h>
+#include <util.h>
+
+using namespace vortex;
+
+#define TRACE_BUFFER_SIZE (1 << 20)
+
+int Tracer::level = -1;
+
+Tracer* Tracer::s_instance = nullptr;
+
+Tracer* Tracer::init() {
+  static std::unique_ptr<Tracer> s_inst([]()->Tracer* {
+    auto file_s = getenv("VORTEX_TRACE");
+    if (file_s == nullptr || *file_s == '\0')
+      return nullptr;
+    return new Tracer(file_s);
+  }());
+  s_instance = s_inst.get();
+  return s_instance;
+}
+
+Tracer::Tracer(const std::string& filename)
+  : file_(fopen(filename.c_str(), "wb"))
+  , buffer_(TRACE_BUFFER_SIZE)
+  , buffer_size_(0)
+  , os_(&record_)
+  , open_(false)
+  , kind_(Raw)
+  , context_({NO_ID, NO_ID, 0})
+  , context_rank_(0)
+  , scope_({NO_ID, NO_ID, 0})
+  , verbosity_(3)
+  , cycle_(0)
+  , start_cycle_(0)
+  , end_cycle_(-1)
+  , start_PC_(0)
+  , end_PC_(-1)
+{
+  if (file_ == nullptr) {
+    std::cout << "Error: cannot open trace file '" << filename << "'" << std::endl;
+    std::abort();
+  }
+
+  auto level_s = getenv("VORTEX_TRACE_LEVEL");
+  if (level_s && *level_s) {
+    verbosity_ = atoi(level_s);
+  }
+
+  auto cycles_s = getenv("VORTEX_TRACE_CYCLES");
+  if (cycles_s && *cycles_s) {
+    std::string cycles(cycles_s);
+    auto colon = cycles.find(':');
+    if (colon != 0) {
+      start_cycle_ = std::stoull(cycles.substr(0, colon));
+    }
+    if (colon != std::string::npos && colon + 1 < cycles.size()) {
+      end_cycle_ = std::stoull(cycles.substr(colon + 1));
+    }
+  }
+
+  auto pcs_s = getenv("VORTEX_TRACE_PCS");
+  if (pcs_s && *pcs_s) {
+    std::string pcs(pcs_s);
+    auto colon = pcs.find(':');
+    if (colon != 0) {
+      start_PC_ = std::stoull(pcs.substr(0, colon), nullptr, 0);
+    }
+    if (colon != std::string::npos && colon + 1 < pcs.size()) {
+      end_PC_ = std::stoull(pcs.substr(colon + 1), nullptr, 0);
+    }
+  }
+
+  auto cores_s = getenv("VORTEX_TRACE_CORES");
+  if (cores_s && *cores_s) {
+    cores_ = parseIdList(cores_s);
+  }
+
+  auto warps_s = getenv("VORTEX_TRACE_WARPS");
+  if (warps_s && *warps_s) {
+    warps_ = parseIdList(warps_s);
+  }
+
+  this->write("VXTRACE", 8);
+}
+
+Tracer::~Tracer() {
+  if (open_) {
+    this->commit();
+  }
+  fwrite(buffer_.data(), 1, buffer_size_, file_);
+  fclose(file_);
+  level = -1;
+  s_instance = nullptr;
+}
+
+std::ostream& Tracer::begin(Kind kind) {
+  auto tracer = s_instance;
+  if (tracer->open_) {
+    tracer->commit();
+  }
+  tracer->open_ = true;
+  tracer->kind_ = kind;
+  tracer->context_ = tracer->scope_;
+  tracer->context_rank_ = 0;
+  return tracer->os_;
+}
+
+std::ostream& Tracer::append() {
+  auto tracer = s_instance;
+  if (!tracer->open_)
+    return begin(Raw);
+  return tracer->os_;
+}
+
+void Tracer::end() {
+  auto tracer = s_instance;
+  if (tracer->open_) {
+    tracer->commit();
+  }
+}
+
+void Tracer::end_line() {
+  auto tracer = s_instance;
+  auto& data = tracer->record_.data;
+  if (tracer->open_ && !data.empty() && data.back() == '\n') {
+    data.pop_back();
+    tracer->commit();
+  }
+}
+
+void Tracer::tag(std::ostream& os, uint32_t cid, uint32_t wid, uint64_t PC) {
+  auto tracer = s_instance;
+  if (tracer == nullptr || &os != &tracer->os_)
+    return;
+  tracer->context_ = {cid, wid, PC};
+  tracer->context_rank_ = 2;
+}
+
+void Tracer::tag(std::ostream& os, uint32_t cid) {
+  auto tracer = s_instance;
+  if (tracer == nullptr || &os != &tracer->os_ || tracer->context_rank_ > 1)
+    return;
+  tracer->context_ = {cid, NO_ID, 0};
+  tracer->context_rank_ = 1;
+}
+
+bool Tracer::match(const context_t& ctx) const {
+  // a filter only passes records that carry its field
+  if (!cores_.empty() && !cores_.count(ctx.cid))
+    return false;
+  if (!warps_.empty() && !warps_.count(ctx.wid))
+    return false;
+  if (start_PC_ != 0 || end_PC_ != uint64_t(-1)) {
+    if (ctx.wid == NO_ID || ctx.PC < start_PC_ || ctx.PC >= end_PC_)
+      return false;
+  }
+  return true;
+}
+
+void Tracer::commit() {
+  auto& data = record_.data;
+  if (this->match(context_)) {
+    // frame header: length, kind, padding, core, warp, cycle, PC
+    uint8_t header[32] = {};
+    uint32_t length = data.size();
+    memcpy(header + 0, &length, 4);
+    header[4] = kind_;
+    memcpy(header + 8, &context_.cid, 4);
+    memcpy(header + 12, &context_.wid, 4);
+    memcpy(header + 16, &cycle_, 8);
+    memcpy(header + 24, &context_.PC, 8);
+    this->write(header, sizeof(header));
+    this->write(data.data(), data.size());
+  }
+  data.clear();
+  open_ = false;
+}
+
+void Tracer::write(const void* data, size_t size) {
+  if (buffer_size_ + size > buffer_.size()) {
+    fwrite(buffer_.data(), 1, buffer_size_, file_);
+    buffer_size_ = 0;
+    if (size > buffer_.size()) {
+      fwrite(data, 1, size, file_);
+      return;
+    }
+  }
+  memcpy(buffer_.data() + buffer_size_, data, size);
+  buffer_size_ += size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Tracer::Scope::Scope(uint32_t cid, uint32_t wid, uint64_t PC)
+  : active_(level >= 0) {
+  if (active_) {
+    s_instance->scope_ = {cid, wid, PC};
+  }
+}
+
+Tracer::Scope::~Scope() {
+  if (active_) {
+    s_instance->scope_ = {NO_ID, NO_ID, 0};
+  }
+}
@@ -0,0 +1,146 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_set>
+
+namespace vortex {
+
+// Runtime-filtered trace sink, backing the debug.h macros in release builds.
+// Enabled by setting VORTEX_TRACE=<file>, with optional filters:
+// VORTEX_TRACE_LEVEL=<verbosity> (default 3), VORTEX_TRACE_CYCLES=<start>:<end>,
+// VORTEX_TRACE_CORES=<list>, VORTEX_TRACE_WARPS=<list> and
+// VORTEX_TRACE_PCS=<low>:<high>.
+// Records are buffered and written as binary frames, ci/trace_decode.py
+// converts them back to the debug build text log.
+class Tracer {
+public:
+  enum Kind : uint8_t {
+    Raw   = 0,
+    Debug = 1,
+    Trace = 2,
+  };
+
+  // current verbosity, -1 when disabled or outside of the cycle window
+  static int level;
+
+  static Tracer* instance() {
+    return s_instance;
+  }
+
+  // sets up the tracer from the environment, returns nullptr when disabled
+  static Tracer* init();
+
+  ~Tracer();
+
+  // start of a cycle, updates the level
+  void tick(uint64_t cycle) {
+    level = (cycle >= start_cycle_ && cycle < end_cycle_) ? verbosity_ : -1;
+    cycle_ = cycle;
+  }
+
+  // end of a kernel launch
+  void stop() {
+    level = -1;
+  }
+
+  // opens a new record
+  static std::ostream& begin(Kind kind);
+
+  // continues the open record, or opens a raw one
+  static std::ostream& append();
+
+  // closes the open record
+  static void end();
+
+  // closes the open record if it is newline-terminated
+  static void end_line();
+
+  // attaches the instruction context to the record being written to os
+  static void tag(std::ostream& os, uint32_t cid, uint32_t wid, uint64_t PC);
+
+  // attaches the core context to the record being written to os
+  static void tag(std::ostream& os, uint32_t cid);
+
+  // instruction context of untagged records, set while an instruction executes
+  class Scope {
+  public:
+    Scope(uint32_t cid, uint32_t wid, uint64_t PC);
+    ~Scope();
+  private:
+    bool active_;
+  };
+
+private:
+
+  static constexpr uint32_t NO_ID = 0xffffffff;
+
+  struct context_t {
+    uint32_t cid;
+    uint32_t wid;
+    uint64_t PC;
+  };
+
+  class Buffer : public std::streambuf {
+  public:
+    std::string data;
+  protected:
+    int_type overflow(int_type c) override {
+      if (c != traits_type::eof()) {
+        data.push_back(traits_type::to_char_type(c));
+      }
+      return c;
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+      data.append(s, n);
+      return n;
+    }
+  };
+
+  Tracer(const std::string& filename);
+
+  bool match(const context_t& ctx) const;
+
+  void commit();
+
+  void write(const void* data, size_t size);
+
+  static Tracer* s_instance;
+
+  FILE* file_;
+  std::vector<char> buffer_;
+  size_t buffer_size_;
+  Buffer record_;
+  std::ostream os_;
+  bool open_;
+  Kind kind_;
+  context_t context_;
+  uint32_t context_rank_;
+  context_t scope_;
+  int verbosity_;
+  uint64_t cycle_;
+  uint64_t start_cycle_;
+  uint64_t end_cycle_;
+  uint64_t start_PC_;
+  uint64_t end_PC_;
+  std::unordered_set<uint32_t> cores_;
+  std::unordered_set<uint32_t> warps_;
+};
+
+}
@@ -25,6 +25,7 @@
 #include <simobject.h>
 #include <bitvector.h>
 #include "debug.h"
+#include "tracer.h"
 
 namespace vortex {
 
@@ -84,6 +85,7 @@ enum class FUType {
   LSU,
   FPU,
   SFU,
+  SALU,
   Count
 };
 
@@ -93,6 +95,7 @@ inline std::ostream &operator<<(std::ostream &os, const FUType& type) {
   case FUType::LSU: os << "LSU"; break;
   case FUType::FPU: os << "FPU"; break;
   case FUType::SFU: os << "SFU"; break;
+  case FUType::SALU: os << "SALU"; break;
   default: assert(false);
   }
   return os;
@@ -125,6 +128,7 @@ inline std::ostream &operator<<(std::ostream &os, const AluType& type) {
 enum class LsuType {
   LOAD,
   STORE,
+  AMO,
   FENCE
 };
 
@@ -132,6 +136,7 @@ inline std::ostream &operator<<(std::ostream &os, const LsuType& type) {
   switch (type) {
   case LsuType::LOAD:  os << "LOAD"; break;
   case LsuType::STORE: os << "STORE"; break;
+  case LsuType::AMO:   os << "AMO"; break;
   case LsuType::FENCE: os << "FENCE"; break;
   default: assert(false);
   }
@@ -248,12 +253,33 @@ inline std::ostream &operator<<(std::ostream &os, const ArbiterType& type) {
   default: assert(false);
   }
   return os;
-}///////////////////////////////////////////////////////////////////////////////
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class AddrHash {
+  None,  // plain bit slices
+  Xor,   // xor-fold upper address bits into the index
+  Prime  // modulo the largest prime not above the index range (set index only in caches)
+};
+
+inline std::ostream &operator<<(std::ostream &os, const AddrHash& type) {
+  switch (type) {
+  case AddrHash::None:  os << "None"; break;
+  case AddrHash::Xor:   os << "Xor"; break;
+  case AddrHash::Prime: os << "Prime"; break;
+  default: assert(false);
+  }
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////
 
 struct LsuReq {
   BitVector<> mask;
   std::vector<uint64_t> addrs;
   bool     write;
+  bool     atomic;
   uint32_t tag;
   uint32_t cid;
   uint64_t uuid;
@@ -262,6 +288,7 @@ struct LsuReq {
     : mask(size)
     , addrs(size, 0)
     , write(false)
+    , atomic(false)
     , tag(0)
     , cid(0)
     , uuid(0)
@@ -269,7 +296,9 @@ struct LsuReq {
 };
 
 inline std::ostream &operator<<(std::ostream &os, const LsuReq& req) {
-  os << "rw=" << req.write << ", mask=" << req.mask << ", ";
+  os << "rw=" << req.write << ", ";
+  if (req.atomic) os << "amo, ";
+  os << "mask=" << req.mask << ", ";
   for (size_t i = 0; i < req.mask.size(); ++i) {
     os << "addr" << i << "=";
     if (req.mask.test(i)) {
@@ -315,24 +344,36 @@ struct MemReq {
   uint32_t tag;
   uint32_t cid;
   uint64_t uuid;
+  bool     evict; // cache line eviction from an upper level
+  bool     atomic; // read-modify-write executed near memory
+  bool     flush; // write-back from a cache maintenance walk
 
   MemReq(uint64_t _addr = 0,
           bool _write = false,
           AddrType _type = AddrType::Global,
           uint64_t _tag = 0,
           uint32_t _cid = 0,
-          uint64_t _uuid = 0
+          uint64_t _uuid = 0,
+          bool _evict = false,
+          bool _atomic = false
   ) : addr(_addr)
     , write(_write)
     , type(_type)
     , tag(_tag)
     , cid(_cid)
     , uuid(_uuid)
+    , evict(_evict)
+    , atomic(_atomic)
+    , flush(false)
   {}
 };
 
 inline std::ostream &operator<<(std::ostream &os, const MemReq& req) {
+  Tracer::tag(os, req.cid);
   os << "rw=" << req.write << ", ";
+  if (req.evict) os << "evict, ";
+  if (req.atomic) os << "amo, ";
+  if (req.flush) os << "flush, ";
   os << "addr=0x" << std::hex << req.addr << std::dec << ", type=" << req.type;
   os << ", tag=0x" << std::hex << req.tag << std::dec << ", cid=" << req.cid;
   os << " (#" << req.uuid << ")";
@@ -354,6 +395,7 @@ struct MemRsp {
 };
 
 inline std::ostream &operator<<(std::ostream &os, const MemRsp& rsp) {
+  Tracer::tag(os, rsp.cid);
   os << "tag=0x" << std::hex << rsp.tag << std::dec << ", cid=" << rsp.cid;
   os << " (#" << rsp.uuid << ")";
   return os;
@@ -0,0 +1,16 @@
+#ifndef _COMMON_H_
+#define _COMMON_H_
+
+#define LINE_WORDS 16
+
+typedef struct {
+  uint32_t grid_dim;
+  uint32_t block_dim;
+  uint32_t num_steps;
+  uint32_t num_lines;
+  uint32_t chase;
+  uint64_t src_addr;
+  uint64_t dst_addr;
+} kernel_arg_t;
+
+#endif
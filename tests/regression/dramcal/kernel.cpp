@@ -0,0 +1,34 @@
+#include <vx_spawn.h>
+#include "common.h"
+
+void kernel_body(kernel_arg_t* __UNIFORM__ arg) {
+	auto src_ptr = reinterpret_cast<uint32_t*>(arg->src_addr);
+	auto dst_ptr = reinterpret_cast<uint32_t*>(arg->dst_addr);
+
+	uint32_t gid = blockIdx.x * blockDim.x + threadIdx.x;
+
+	uint32_t value = 0;
+
+	if (arg->chase) {
+		// dependent loads: each line holds the index of the next one
+		uint32_t index = 0;
+		for (uint32_t i = 0; i < arg->num_steps; ++i) {
+			index = src_ptr[index];
+		}
+		value = index;
+	} else {
+		// independent loads: each thread touches a distinct line per step
+		uint32_t num_threads = gridDim.x * blockDim.x;
+		for (uint32_t i = 0; i < arg->num_steps; ++i) {
+			uint32_t line = (gid + i * num_threads) % arg->num_lines;
+			value += src_ptr[line * LINE_WORDS];
+		}
+	}
+
+	dst_ptr[gid] = value;
+}
+
+int main() {
+	kernel_arg_t* arg = (kernel_arg_t*)csr_read(VX_CSR_MSCRATCH);
+	return vx_spawn_threads(1, &arg->grid_dim, &arg->block_dim, (vx_kernel_func_cb)kernel_body, arg);
+}
@@ -0,0 +1,225 @@
+#include <iostream>
+#include <unistd.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <vortex.h>
+#include <VX_types.h>
+#include "common.h"
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+	 cleanup();			                                              \
+     exit(-1);                                                  \
+   } while (false)
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* kernel_file = "kernel.vxbin";
+uint32_t num_steps = 1024;
+uint32_t num_lines = 4096;
+uint32_t num_threads = 256;
+uint32_t group_size = 16;
+
+vx_device_h device = nullptr;
+vx_buffer_h src_buffer = nullptr;
+vx_buffer_h dst_buffer = nullptr;
+vx_buffer_h krnl_buffer = nullptr;
+vx_buffer_h args_buffer = nullptr;
+kernel_arg_t kernel_arg = {};
+
+static void show_usage() {
+   std::cout << "Vortex DRAM Calibration Test." << std::endl;
+   std::cout << "Usage: [-k: kernel] [-n chase steps] [-s buffer lines] [-t stream threads] [-h: help]" << std::endl;
+   std::cout << "Compare DRAM backends, e.g. VORTEX_DRAM_MODEL=analytic vs. the default Ramulator HBM2 preset." << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:s:t:k:h?")) != -1) {
+    switch (c) {
+    case 'n':
+      num_steps = atoi(optarg);
+      break;
+    case 's':
+      num_lines = atoi(optarg);
+      break;
+    case 't':
+      num_threads = atoi(optarg);
+      break;
+    case 'k':
+      kernel_file = optarg;
+      break;
+    case 'h':
+    case '?': {
+      show_usage();
+      exit(0);
+    } break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+void cleanup() {
+  if (device) {
+    vx_mem_free(src_buffer);
+    vx_mem_free(dst_buffer);
+    vx_mem_free(krnl_buffer);
+    vx_mem_free(args_buffer);
+    vx_dev_close(device);
+  }
+}
+
+int run_test(bool chase, const std::vector<uint32_t>& h_src, std::vector<uint32_t>& h_dst) {
+  kernel_arg.chase     = chase;
+  kernel_arg.grid_dim  = chase ? 1 : (num_threads / group_size);
+  kernel_arg.block_dim = chase ? 1 : group_size;
+  kernel_arg.num_steps = chase ? num_steps : std::max<uint32_t>(num_lines / num_threads, 1);
+
+  uint32_t total_threads = kernel_arg.grid_dim * kernel_arg.block_dim;
+
+  // upload kernel argument
+  vx_mem_free(args_buffer);
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg, sizeof(kernel_arg_t), &args_buffer));
+
+  // start device
+  RT_CHECK(vx_start(device, krnl_buffer, args_buffer));
+
+  // wait for completion
+  RT_CHECK(vx_ready_wait(device, VX_MAX_TIMEOUT));
+
+  // query perf counters
+  uint64_t num_cores, max_cycles = 0, mem_reads, mem_latency;
+  RT_CHECK(vx_dev_caps(device, VX_CAPS_NUM_CORES, &num_cores));
+  for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+    uint64_t cycles;
+    RT_CHECK(vx_mpm_query(device, VX_CSR_MCYCLE, core_id, &cycles));
+    max_cycles = std::max<uint64_t>(cycles, max_cycles);
+  }
+  RT_CHECK(vx_mpm_query(device, VX_CSR_MPM_MEM_READS, 0, &mem_reads));
+  RT_CHECK(vx_mpm_query(device, VX_CSR_MPM_MEM_LT, 0, &mem_latency));
+
+  double dram_latency = mem_reads ? (double(mem_latency) / mem_reads) : 0;
+  if (chase) {
+    printf("latency: steps=%d, cycles=%ld, cycles/load=%.1f, dram reads=%ld, dram latency=%.1f\n",
+      num_steps, max_cycles, double(max_cycles) / num_steps, mem_reads, dram_latency);
+  } else {
+    uint32_t loads = total_threads * kernel_arg.num_steps;
+    printf("bandwidth: loads=%d, cycles=%ld, bytes/cycle=%.2f, dram reads=%ld, dram latency=%.1f\n",
+      loads, max_cycles, double(loads) * LINE_WORDS * sizeof(uint32_t) / max_cycles, mem_reads, dram_latency);
+  }
+
+  // download destination buffer
+  RT_CHECK(vx_copy_from_dev(h_dst.data(), dst_buffer, 0, total_threads * sizeof(uint32_t)));
+
+  // verify result
+  int errors = 0;
+  for (uint32_t gid = 0; gid < total_threads; ++gid) {
+    uint32_t ref = 0;
+    if (chase) {
+      for (uint32_t i = 0; i < num_steps; ++i) {
+        ref = h_src[ref];
+      }
+    } else {
+      for (uint32_t i = 0; i < kernel_arg.num_steps; ++i) {
+        uint32_t line = (gid + i * total_threads) % num_lines;
+        ref += h_src[line * LINE_WORDS];
+      }
+    }
+    if (h_dst[gid] != ref) {
+      if (errors < 100) {
+        printf("*** error: [%d] expected=%d, actual=%d\n", gid, ref, h_dst[gid]);
+      }
+      ++errors;
+    }
+  }
+
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  // parse command arguments
+  parse_args(argc, argv);
+
+  if (0 == num_lines || 0 == num_threads || (num_threads % group_size) != 0) {
+    std::cout << "Error: threads must be a multiple of " << group_size << "!" << std::endl;
+    return -1;
+  }
+
+  // open device connection
+  std::cout << "open device connection" << std::endl;
+  RT_CHECK(vx_dev_open(&device));
+
+  // profile memory counters
+  RT_CHECK(vx_dcr_write(device, VX_DCR_BASE_MPM_CLASS, VX_DCR_MPM_CLASS_MEM));
+
+  uint32_t src_buf_size = num_lines * LINE_WORDS * sizeof(uint32_t);
+  uint32_t dst_buf_size = num_threads * sizeof(uint32_t);
+
+  kernel_arg.num_lines = num_lines;
+
+  std::cout << "number of lines: " << num_lines << std::endl;
+  std::cout << "buffer size: " << src_buf_size << " bytes" << std::endl;
+
+  // allocate device memory
+  std::cout << "allocate device memory" << std::endl;
+  RT_CHECK(vx_mem_alloc(device, src_buf_size, VX_MEM_READ, &src_buffer));
+  RT_CHECK(vx_mem_address(src_buffer, &kernel_arg.src_addr));
+  RT_CHECK(vx_mem_alloc(device, dst_buf_size, VX_MEM_WRITE, &dst_buffer));
+  RT_CHECK(vx_mem_address(dst_buffer, &kernel_arg.dst_addr));
+
+  std::cout << "src_addr=0x" << std::hex << kernel_arg.src_addr << std::endl;
+  std::cout << "dst_addr=0x" << std::hex << kernel_arg.dst_addr << std::dec << std::endl;
+
+  // generate a random cyclic chain across all lines
+  std::vector<uint32_t> order(num_lines);
+  for (uint32_t i = 0; i < num_lines; ++i) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin() + 1, order.end(), std::mt19937(50));
+  std::vector<uint32_t> h_src(num_lines * LINE_WORDS, 0);
+  std::vector<uint32_t> h_dst(num_threads);
+  for (uint32_t i = 0; i < num_lines; ++i) {
+    uint32_t next = order[(i + 1) % num_lines];
+    h_src[order[i] * LINE_WORDS] = next * LINE_WORDS;
+  }
+
+  // upload source buffer
+  std::cout << "upload source buffer" << std::endl;
+  RT_CHECK(vx_copy_to_dev(src_buffer, h_src.data(), 0, src_buf_size));
+
+  // upload program
+  std::cout << "upload program" << std::endl;
+  RT_CHECK(vx_upload_kernel_file(device, kernel_file, &krnl_buffer));
+
+  int errors = 0;
+
+  // measure loaded latency using a pointer chase
+  std::cout << "run latency test" << std::endl;
+  errors += run_test(true, h_src, h_dst);
+
+  // measure streaming bandwidth using independent loads
+  std::cout << "run bandwidth test" << std::endl;
+  errors += run_test(false, h_src, h_dst);
+
+  // cleanup
+  std::cout << "cleanup" << std::endl;
+  cleanup();
+
+  if (errors != 0) {
+    std::cout << "Found " << std::dec << errors << " errors!" << std::endl;
+    std::cout << "FAILED!" << std::endl;
+    return errors;
+  }
+
+  std::cout << "PASSED!" << std::endl;
+
+  return 0;
+}
@@ -13,6 +13,11 @@
 
 #define KERNEL_ARG_DEV_MEM_ADDR 0x7ffff000
 
+#define KERNEL_PASS_RENDER      0
+#define KERNEL_PASS_BIN_SETUP   1
+#define KERNEL_PASS_BIN_PREFIX  2
+#define KERNEL_PASS_BIN_SCATTER 3
+
 class GpuSW;
 
 typedef struct {
@@ -24,6 +29,9 @@ typedef struct {
   uint32_t log_num_tasks;
   uint64_t prim_addr;
 
+  uint32_t pass;
+  graphics::rast_bin_args_t bin_args;
+
   bool depth_enabled;
   bool color_enabled;
   bool tex_enabled; 
@@ -283,9 +283,34 @@ void shader_function_sw(kernel_arg_t* /*arg*/) {
 }
 #endif
 
+void binning_setup(kernel_arg_t* __UNIFORM__ arg) {
+	BinningSetup(arg->bin_args, blockIdx.x);
+}
+
+void binning_prefix(kernel_arg_t* __UNIFORM__ arg) {
+	BinningPrefix(arg->bin_args);
+}
+
+void binning_scatter(kernel_arg_t* __UNIFORM__ arg) {
+	BinningScatter(arg->bin_args, blockIdx.x);
+}
+
 int main() {
 	auto __UNIFORM__ arg = (kernel_arg_t*)csr_read(VX_CSR_MSCRATCH);
 
+	switch (arg->pass) {
+	case KERNEL_PASS_BIN_SETUP:
+		return vx_spawn_threads(1, &arg->bin_args.num_tasks, nullptr, (vx_kernel_func_cb)binning_setup, arg);
+	case KERNEL_PASS_BIN_PREFIX: {
+		uint32_t num_tasks = 1;
+		return vx_spawn_threads(1, &num_tasks, nullptr, (vx_kernel_func_cb)binning_prefix, arg);
+	}
+	case KERNEL_PASS_BIN_SCATTER:
+		return vx_spawn_threads(1, &arg->bin_args.num_tasks, nullptr, (vx_kernel_func_cb)binning_scatter, arg);
+	default:
+		break;
+	}
+
 	auto callback = (vx_kernel_func_cb)shader_function_hw;
 #ifdef SW_ENABLE
 	g_gpu_sw.configure(arg);
@@ -40,6 +40,7 @@ const char* reference_file = nullptr;
 bool sw_rast = false;
 bool sw_tex = false;
 bool sw_om = false;
+bool dev_binning = false;
 
 uint32_t start_draw = 0;
 uint32_t end_draw = -1;
@@ -72,6 +73,12 @@ vx_buffer_h color_buffer= nullptr;
 vx_buffer_h tex_buffer  = nullptr;
 vx_buffer_h tile_buffer = nullptr;
 vx_buffer_h prim_buffer = nullptr;
+vx_buffer_h vertex_buffer = nullptr;
+vx_buffer_h index_buffer = nullptr;
+vx_buffer_h scratch_buffer = nullptr;
+vx_buffer_h status_buffer = nullptr;
+
+uint32_t tilebuf_capacity = 0;
 
 kernel_arg_t kernel_arg = {};
 
@@ -79,12 +86,12 @@ uint32_t tileLogSize = RASTER_TILE_LOGSIZE;
 
 static void show_usage() {
    std::cout << "Vortex 3D Rendering Test." << std::endl;
-   std::cout << "Usage: [-t trace] [-s startdraw] [-e enddraw] [-o output] [-r reference] [-w width] [-h height] [-e empty] [-x s/w rast] [-y s/w om] [-k tilelogsize]" << std::endl;
+   std::cout << "Usage: [-t trace] [-s startdraw] [-e enddraw] [-o output] [-r reference] [-w width] [-h height] [-e empty] [-x s/w rast] [-y s/w om] [-k tilelogsize] [-b device binning]" << std::endl;
 }
 
 static void parse_args(int argc, char **argv) {
   int c;
-  while ((c = getopt(argc, argv, "t:s:e:i:o:r:w:h:t:k:uxyz?")) != -1) {
+  while ((c = getopt(argc, argv, "t:s:e:i:o:r:w:h:t:k:uxyzb?")) != -1) {
     switch (c) {
     case 't':
       trace_file = optarg;
@@ -119,6 +126,9 @@ static void parse_args(int argc, char **argv) {
     case 'k':
       tileLogSize = std::atoi(optarg);
       break;
+    case 'b':
+      dev_binning = true;
+      break;
     case '?': {
       show_usage();
       exit(0);
@@ -140,6 +150,10 @@ void cleanup() {
   vx_mem_free(tex_buffer);
   vx_mem_free(tile_buffer);
   vx_mem_free(prim_buffer);
+  vx_mem_free(vertex_buffer);
+  vx_mem_free(index_buffer);
+  vx_mem_free(scratch_buffer);
+  vx_mem_free(status_buffer);
   vx_mem_free(krnl_buffer);
   vx_mem_free(args_buffer);
   vx_dev_close(device);
@@ -168,6 +182,144 @@ void cleanup() {
     vx_dcr_write(device, addr, value)
 #endif
 
+static uint32_t host_binning(const std::unordered_map<uint32_t, CGLTrace::vertex_t>& vertices,
+                             const std::vector<CGLTrace::primitive_t>& primitives,
+                             float near,
+                             float far) {
+  std::vector<uint8_t> tilebuf;
+  std::vector<uint8_t> primbuf;
+
+  // Perform tile binning
+  auto num_tiles = graphics::Binning(tilebuf, primbuf, vertices, primitives, dst_width, dst_height, near, far, tileLogSize);
+  std::cout << "Binning allocated " << std::dec << num_tiles << " tiles with " << (primbuf.size() / sizeof(graphics::rast_prim_t)) << " total primitives." << std::endl;
+  if (0 == num_tiles)
+    return 0;
+
+  // allocate tile memory
+  if (tile_buffer != nullptr) vx_mem_free(tile_buffer);
+  if (prim_buffer != nullptr) vx_mem_free(prim_buffer);
+  RT_CHECK(vx_mem_alloc(device, tilebuf.size(), VX_MEM_READ, &tile_buffer));
+  RT_CHECK(vx_mem_address(tile_buffer, &tilebuf_addr));
+  RT_CHECK(vx_mem_alloc(device, primbuf.size(), VX_MEM_READ, &prim_buffer));
+  RT_CHECK(vx_mem_address(prim_buffer, &primbuf_addr));
+  std::cout << "tile_buffer=0x" << std::hex << tilebuf_addr << std::dec << std::endl;
+  std::cout << "prim_buffer=0x" << std::hex << primbuf_addr << std::dec << std::endl;
+
+  // upload tiles buffer
+  std::cout << "upload tile buffer" << std::endl;
+  RT_CHECK(vx_copy_to_dev(tile_buffer, tilebuf.data(), 0, tilebuf.size()));
+
+  // upload primitives buffer
+  std::cout << "upload primitive buffer" << std::endl;
+  RT_CHECK(vx_copy_to_dev(prim_buffer, primbuf.data(), 0, primbuf.size()));
+
+  return num_tiles;
+}
+
+static void run_pass(uint32_t pass) {
+  kernel_arg.pass = pass;
+  if (args_buffer != nullptr) vx_mem_free(args_buffer);
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg, sizeof(kernel_arg_t), &args_buffer));
+  RT_CHECK(vx_start(device, krnl_buffer, args_buffer));
+  RT_CHECK(vx_ready_wait(device, VX_MAX_TIMEOUT));
+}
+
+// bin the primitives on the device: only the vertices and indices are uploaded,
+// and only the binning status is read back
+static uint32_t device_binning(const std::unordered_map<uint32_t, CGLTrace::vertex_t>& vertices,
+                               const std::vector<CGLTrace::primitive_t>& primitives,
+                               float near,
+                               float far) {
+  std::vector<graphics::rast_vertex_t> vbuf;
+  std::vector<uint32_t> ibuf;
+  graphics::PackPrimitives(vbuf, ibuf, vertices, primitives);
+  uint32_t num_prims = primitives.size();
+  if (0 == num_prims)
+    return 0;
+
+  uint32_t tile_size = 1 << tileLogSize;
+  uint32_t num_tiles = ((dst_width + tile_size - 1) >> tileLogSize) * ((dst_height + tile_size - 1) >> tileLogSize);
+  uint32_t num_tasks = 1 << kernel_arg.log_num_tasks;
+  auto scratch_size = graphics::BinningScratchSize(num_prims, num_tiles, num_tasks);
+
+  uint64_t vbuf_addr, ibuf_addr, scratch_addr, status_addr;
+
+  // upload vertex and index buffers
+  std::cout << "upload vertex and index buffers" << std::endl;
+  if (vertex_buffer != nullptr) vx_mem_free(vertex_buffer);
+  if (index_buffer != nullptr) vx_mem_free(index_buffer);
+  RT_CHECK(vx_mem_alloc(device, vbuf.size() * sizeof(graphics::rast_vertex_t), VX_MEM_READ, &vertex_buffer));
+  RT_CHECK(vx_mem_address(vertex_buffer, &vbuf_addr));
+  RT_CHECK(vx_mem_alloc(device, ibuf.size() * sizeof(uint32_t), VX_MEM_READ, &index_buffer));
+  RT_CHECK(vx_mem_address(index_buffer, &ibuf_addr));
+  RT_CHECK(vx_copy_to_dev(vertex_buffer, vbuf.data(), 0, vbuf.size() * sizeof(graphics::rast_vertex_t)));
+  RT_CHECK(vx_copy_to_dev(index_buffer, ibuf.data(), 0, ibuf.size() * sizeof(uint32_t)));
+
+  // allocate binning memory
+  if (scratch_buffer != nullptr) vx_mem_free(scratch_buffer);
+  if (prim_buffer != nullptr) vx_mem_free(prim_buffer);
+  RT_CHECK(vx_mem_alloc(device, scratch_size, VX_MEM_READ_WRITE, &scratch_buffer));
+  RT_CHECK(vx_mem_address(scratch_buffer, &scratch_addr));
+  RT_CHECK(vx_mem_alloc(device, num_prims * sizeof(graphics::rast_prim_t), VX_MEM_READ_WRITE, &prim_buffer));
+  RT_CHECK(vx_mem_address(prim_buffer, &primbuf_addr));
+  if (status_buffer == nullptr) {
+    RT_CHECK(vx_mem_alloc(device, sizeof(graphics::rast_bin_status_t), VX_MEM_READ_WRITE, &status_buffer));
+  }
+  RT_CHECK(vx_mem_address(status_buffer, &status_addr));
+
+  // the tile buffer is kept across draw calls and grown on overflow
+  uint32_t tbuf_size = num_tiles * sizeof(graphics::rast_tile_header_t) + num_prims * sizeof(uint32_t);
+  if (tilebuf_capacity < tbuf_size) {
+    if (tile_buffer != nullptr) vx_mem_free(tile_buffer);
+    RT_CHECK(vx_mem_alloc(device, tbuf_size, VX_MEM_READ_WRITE, &tile_buffer));
+    tilebuf_capacity = tbuf_size;
+  }
+  RT_CHECK(vx_mem_address(tile_buffer, &tilebuf_addr));
+
+  auto& bin_args = kernel_arg.bin_args;
+  bin_args.vbuf_addr    = vbuf_addr;
+  bin_args.ibuf_addr    = ibuf_addr;
+  bin_args.tbuf_addr    = tilebuf_addr;
+  bin_args.pbuf_addr    = primbuf_addr;
+  bin_args.scratch_addr = scratch_addr;
+  bin_args.status_addr  = status_addr;
+  bin_args.tbuf_size    = tilebuf_capacity;
+  bin_args.num_prims    = num_prims;
+  bin_args.num_tasks    = num_tasks;
+  bin_args.width        = dst_width;
+  bin_args.height       = dst_height;
+  bin_args.tile_logsize = tileLogSize;
+  bin_args.near         = near;
+  bin_args.far          = far;
+
+  std::cout << "device binning" << std::endl;
+  run_pass(KERNEL_PASS_BIN_SETUP);
+  run_pass(KERNEL_PASS_BIN_PREFIX);
+  run_pass(KERNEL_PASS_BIN_SCATTER);
+
+  graphics::rast_bin_status_t status;
+  RT_CHECK(vx_copy_from_dev(&status, status_buffer, 0, sizeof(status)));
+  if (status.overflow) {
+    // grow the tile buffer and redo the tile assignment
+    vx_mem_free(tile_buffer);
+    RT_CHECK(vx_mem_alloc(device, status.tbuf_size, VX_MEM_READ_WRITE, &tile_buffer));
+    RT_CHECK(vx_mem_address(tile_buffer, &tilebuf_addr));
+    tilebuf_capacity = status.tbuf_size;
+    bin_args.tbuf_addr = tilebuf_addr;
+    bin_args.tbuf_size = tilebuf_capacity;
+    run_pass(KERNEL_PASS_BIN_PREFIX);
+    run_pass(KERNEL_PASS_BIN_SCATTER);
+    RT_CHECK(vx_copy_from_dev(&status, status_buffer, 0, sizeof(status)));
+    assert(!status.overflow);
+  }
+
+  std::cout << "Binning allocated " << std::dec << status.num_tiles << " tiles with " << status.num_prims << " total primitives." << std::endl;
+  std::cout << "tile_buffer=0x" << std::hex << tilebuf_addr << std::dec << std::endl;
+  std::cout << "prim_buffer=0x" << std::hex << primbuf_addr << std::dec << std::endl;
+
+  return status.num_tiles;
+}
+
 int render(const CGLTrace& trace) {
   std::cout << "render" << std::endl;
   auto time_begin = std::chrono::high_resolution_clock::now();
@@ -183,33 +335,12 @@ int render(const CGLTrace& trace) {
     auto& drawcall = trace.drawcalls.at(d);
     auto& states = drawcall.states;
 
-    std::vector<uint8_t> tilebuf;
-    std::vector<uint8_t> primbuf;
-
     // Perform tile binning
-    auto num_tiles = graphics::Binning(tilebuf, primbuf, drawcall.vertices, drawcall.primitives, dst_width, dst_height, drawcall.viewport.near, drawcall.viewport.far, tileLogSize);
-    std::cout << "Binning allocated " << std::dec << num_tiles << " tiles with " << (primbuf.size() / sizeof(graphics::rast_prim_t)) << " total primitives." << std::endl;
+    auto num_tiles = dev_binning ? device_binning(drawcall.vertices, drawcall.primitives, drawcall.viewport.near, drawcall.viewport.far)
+                                 : host_binning(drawcall.vertices, drawcall.primitives, drawcall.viewport.near, drawcall.viewport.far);
     if (0 == num_tiles)
       continue;
 
-    // allocate tile memory
-    if (tile_buffer != nullptr) vx_mem_free(tile_buffer);
-    if (prim_buffer != nullptr) vx_mem_free(prim_buffer);
-    RT_CHECK(vx_mem_alloc(device, tilebuf.size(), VX_MEM_READ, &tile_buffer));
-    RT_CHECK(vx_mem_address(tile_buffer, &tilebuf_addr));
-    RT_CHECK(vx_mem_alloc(device, primbuf.size(), VX_MEM_READ, &prim_buffer));
-    RT_CHECK(vx_mem_address(prim_buffer, &primbuf_addr));
-    std::cout << "tile_buffer=0x" << std::hex << tilebuf_addr << std::dec << std::endl;
-    std::cout << "prim_buffer=0x" << std::hex << primbuf_addr << std::dec << std::endl;
-
-    // upload tiles buffer
-    std::cout << "upload tile buffer" << std::endl;
-    RT_CHECK(vx_copy_to_dev(tile_buffer, tilebuf.data(), 0, tilebuf.size()));
-
-    // upload primitives buffer
-    std::cout << "upload primitive buffer" << std::endl;
-    RT_CHECK(vx_copy_to_dev(prim_buffer, primbuf.data(), 0, primbuf.size()));
-
     uint32_t primbuf_stride = sizeof(graphics::rast_prim_t);
 
     // configure raster units
@@ -235,7 +366,8 @@ int render(const CGLTrace& trace) {
       // configure om depth states
       auto depth_func = graphics::toVXCompare(states.depth_func);
       OM_DCR_WRITE(VX_DCR_OM_DEPTH_FUNC, depth_func);
-      OM_DCR_WRITE(VX_DCR_OM_DEPTH_WRITEMASK, states.depth_writemask);
+      // the shaders output the interpolated depth and never discard
+      OM_DCR_WRITE(VX_DCR_OM_DEPTH_WRITEMASK, states.depth_writemask | VX_OM_DEPTH_HIZ_SAFE);
     } else {
       OM_DCR_WRITE(VX_DCR_OM_DEPTH_FUNC, VX_OM_DEPTH_FUNC_ALWAYS);
       OM_DCR_WRITE(VX_DCR_OM_DEPTH_WRITEMASK, 0);
@@ -333,6 +465,7 @@ int render(const CGLTrace& trace) {
     // upload kernel argument
     std::cout << "upload kernel argument" << std::endl;
     {
+      kernel_arg.pass          = KERNEL_PASS_RENDER;
       kernel_arg.depth_enabled = states.depth_test;
       kernel_arg.color_enabled = states.color_enabled;
       kernel_arg.tex_enabled   = states.texture_enabled;
@@ -0,0 +1,16 @@
+#ifndef _COMMON_H_
+#define _COMMON_H_
+
+#define NUM_ITERS 8
+
+typedef struct {
+  uint32_t grid_dim;
+  uint32_t block_dim;
+  uint32_t stride;
+  uint32_t mask;
+  uint32_t use_lmem;
+  uint64_t src_addr;
+  uint64_t dst_addr;
+} kernel_arg_t;
+
+#endif
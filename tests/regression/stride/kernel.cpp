@@ -0,0 +1,44 @@
+#include <vx_spawn.h>
+#include "common.h"
+
+void kernel_body(kernel_arg_t* __UNIFORM__ arg) {
+	auto src_ptr = reinterpret_cast<int32_t*>(arg->src_addr);
+	auto dst_ptr = reinterpret_cast<int32_t*>(arg->dst_addr);
+	auto stride  = arg->stride;
+	auto mask    = arg->mask;
+
+	uint32_t gid = blockIdx.x * blockDim.x + threadIdx.x;
+
+	int32_t sum = 0;
+
+	if (arg->use_lmem) {
+		auto local_ptr = reinterpret_cast<int32_t*>(__local_mem((mask + 1) * sizeof(int32_t)));
+
+		// populate local memory using strided stores
+		for (uint32_t i = 0; i < NUM_ITERS; ++i) {
+			uint32_t index = ((threadIdx.x + i * blockDim.x) * stride) & mask;
+			local_ptr[index] = src_ptr[index];
+		}
+
+		__syncthreads();
+
+		// read back using the same strided pattern
+		for (uint32_t i = 0; i < NUM_ITERS; ++i) {
+			uint32_t index = ((threadIdx.x + i * blockDim.x) * stride) & mask;
+			sum += local_ptr[index];
+		}
+	} else {
+		uint32_t num_threads = gridDim.x * blockDim.x;
+		for (uint32_t i = 0; i < NUM_ITERS; ++i) {
+			uint32_t index = ((gid + i * num_threads) * stride) & mask;
+			sum += src_ptr[index];
+		}
+	}
+
+	dst_ptr[gid] = sum;
+}
+
+int main() {
+	kernel_arg_t* arg = (kernel_arg_t*)csr_read(VX_CSR_MSCRATCH);
+	return vx_spawn_threads(1, &arg->grid_dim, &arg->block_dim, (vx_kernel_func_cb)kernel_body, arg);
+}
@@ -0,0 +1,224 @@
+#include <iostream>
+#include <unistd.h>
+#include <string.h>
+#include <vector>
+#include <vortex.h>
+#include <VX_types.h>
+#include "common.h"
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+	 cleanup();			                                              \
+     exit(-1);                                                  \
+   } while (false)
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* kernel_file = "kernel.vxbin";
+uint32_t num_points = 64;
+uint32_t group_size = 16;
+uint32_t max_stride = 64;
+uint32_t buf_words = 1024;
+bool use_lmem = false;
+
+vx_device_h device = nullptr;
+vx_buffer_h src_buffer = nullptr;
+vx_buffer_h dst_buffer = nullptr;
+vx_buffer_h krnl_buffer = nullptr;
+vx_buffer_h args_buffer = nullptr;
+kernel_arg_t kernel_arg = {};
+
+static void show_usage() {
+   std::cout << "Vortex Stride Sweep Test." << std::endl;
+   std::cout << "Usage: [-k: kernel] [-n points] [-g group size] [-s max stride] [-b buffer words] [-l: use local memory] [-h: help]" << std::endl;
+   std::cout << "Compare bank stalls across simx builds, e.g. CONFIGS=\"-DL1_INDEX_HASH=1 -DLMEM_INDEX_HASH=1\"." << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:g:s:b:lk:h?")) != -1) {
+    switch (c) {
+    case 'n':
+      num_points = atoi(optarg);
+      break;
+    case 'g':
+      group_size = atoi(optarg);
+      break;
+    case 's':
+      max_stride = atoi(optarg);
+      break;
+    case 'b':
+      buf_words = atoi(optarg);
+      break;
+    case 'l':
+      use_lmem = true;
+      break;
+    case 'k':
+      kernel_file = optarg;
+      break;
+    case 'h':
+    case '?': {
+      show_usage();
+      exit(0);
+    } break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+void cleanup() {
+  if (device) {
+    vx_mem_free(src_buffer);
+    vx_mem_free(dst_buffer);
+    vx_mem_free(krnl_buffer);
+    vx_mem_free(args_buffer);
+    vx_dev_close(device);
+  }
+}
+
+int run_test(uint32_t stride, const std::vector<int32_t>& h_src, std::vector<int32_t>& h_dst) {
+  uint32_t num_threads = kernel_arg.grid_dim * kernel_arg.block_dim;
+
+  kernel_arg.stride = stride;
+
+  // upload kernel argument
+  vx_mem_free(args_buffer);
+  RT_CHECK(vx_upload_bytes(device, &kernel_arg, sizeof(kernel_arg_t), &args_buffer));
+
+  // start device
+  RT_CHECK(vx_start(device, krnl_buffer, args_buffer));
+
+  // wait for completion
+  RT_CHECK(vx_ready_wait(device, VX_MAX_TIMEOUT));
+
+  // query perf counters
+  uint64_t num_cores, max_cycles = 0, bank_stalls;
+  RT_CHECK(vx_dev_caps(device, VX_CAPS_NUM_CORES, &num_cores));
+  for (uint32_t core_id = 0; core_id < num_cores; ++core_id) {
+    uint64_t cycles;
+    RT_CHECK(vx_mpm_query(device, VX_CSR_MCYCLE, core_id, &cycles));
+    max_cycles = std::max<uint64_t>(cycles, max_cycles);
+  }
+  RT_CHECK(vx_mpm_query(device, use_lmem ? VX_CSR_MPM_LMEM_BANK_ST : VX_CSR_MPM_DCACHE_BANK_ST, -1, &bank_stalls));
+  printf("stride=%d: cycles=%ld, bank stalls=%ld\n", stride, max_cycles, bank_stalls);
+
+  // download destination buffer
+  RT_CHECK(vx_copy_from_dev(h_dst.data(), dst_buffer, 0, num_threads * sizeof(int32_t)));
+
+  // verify result
+  int errors = 0;
+  for (uint32_t gid = 0; gid < num_threads; ++gid) {
+    uint32_t tid = use_lmem ? (gid % kernel_arg.block_dim) : gid;
+    uint32_t n = use_lmem ? kernel_arg.block_dim : num_threads;
+    int32_t ref = 0;
+    for (uint32_t i = 0; i < NUM_ITERS; ++i) {
+      uint32_t index = ((tid + i * n) * stride) & kernel_arg.mask;
+      ref += h_src[index];
+    }
+    if (h_dst[gid] != ref) {
+      if (errors < 100) {
+        printf("*** error: stride=%d, [%d] expected=%d, actual=%d\n", stride, gid, ref, h_dst[gid]);
+      }
+      ++errors;
+    }
+  }
+
+  return errors;
+}
+
+int main(int argc, char *argv[]) {
+  // parse command arguments
+  parse_args(argc, argv);
+
+  if (0 == buf_words || (buf_words & (buf_words - 1)) != 0) {
+    std::cout << "Error: buffer words must be a power of two!" << std::endl;
+    return -1;
+  }
+
+  if (0 == group_size || (num_points % group_size) != 0) {
+    std::cout << "Error: points must be a multiple of the group size!" << std::endl;
+    return -1;
+  }
+
+  std::srand(50);
+
+  // open device connection
+  std::cout << "open device connection" << std::endl;
+  RT_CHECK(vx_dev_open(&device));
+
+  // profile memory counters
+  RT_CHECK(vx_dcr_write(device, VX_DCR_BASE_MPM_CLASS, VX_DCR_MPM_CLASS_MEM));
+
+  uint32_t src_buf_size = buf_words * sizeof(int32_t);
+  uint32_t dst_buf_size = num_points * sizeof(int32_t);
+
+  kernel_arg.grid_dim  = num_points / group_size;
+  kernel_arg.block_dim = group_size;
+  kernel_arg.mask      = buf_words - 1;
+  kernel_arg.use_lmem  = use_lmem;
+
+  std::cout << "number of points: " << num_points << std::endl;
+  std::cout << "group size: " << group_size << std::endl;
+  std::cout << "buffer size: " << src_buf_size << " bytes" << std::endl;
+  std::cout << "local memory: " << (use_lmem ? "enabled" : "disabled") << std::endl;
+
+  if (use_lmem) {
+    // check work group occupancy
+    uint32_t max_localmem;
+    RT_CHECK(vx_check_occupancy(device, group_size, &max_localmem));
+    std::cout << "occupancy: max_localmem=" << max_localmem << " bytes" << std::endl;
+    RT_CHECK(max_localmem < src_buf_size);
+  }
+
+  // allocate device memory
+  std::cout << "allocate device memory" << std::endl;
+  RT_CHECK(vx_mem_alloc(device, src_buf_size, VX_MEM_READ, &src_buffer));
+  RT_CHECK(vx_mem_address(src_buffer, &kernel_arg.src_addr));
+  RT_CHECK(vx_mem_alloc(device, dst_buf_size, VX_MEM_WRITE, &dst_buffer));
+  RT_CHECK(vx_mem_address(dst_buffer, &kernel_arg.dst_addr));
+
+  std::cout << "src_addr=0x" << std::hex << kernel_arg.src_addr << std::endl;
+  std::cout << "dst_addr=0x" << std::hex << kernel_arg.dst_addr << std::dec << std::endl;
+
+  // generate source data
+  std::vector<int32_t> h_src(buf_words);
+  std::vector<int32_t> h_dst(num_points);
+  for (uint32_t i = 0; i < buf_words; ++i) {
+    h_src[i] = std::rand() % 1024;
+  }
+
+  // upload source buffer
+  std::cout << "upload source buffer" << std::endl;
+  RT_CHECK(vx_copy_to_dev(src_buffer, h_src.data(), 0, src_buf_size));
+
+  // upload program
+  std::cout << "upload program" << std::endl;
+  RT_CHECK(vx_upload_kernel_file(device, kernel_file, &krnl_buffer));
+
+  // sweep power-of-two strides
+  std::cout << "run stride sweep" << std::endl;
+  int errors = 0;
+  for (uint32_t stride = 1; stride <= max_stride; stride *= 2) {
+    errors += run_test(stride, h_src, h_dst);
+  }
+
+  // cleanup
+  std::cout << "cleanup" << std::endl;
+  cleanup();
+
+  if (errors != 0) {
+    std::cout << "Found " << std::dec << errors << " errors!" << std::endl;
+    std::cout << "FAILED!" << std::endl;
+    return errors;
+  }
+
+  std::cout << "PASSED!" << std::endl;
+
+  return 0;
+}
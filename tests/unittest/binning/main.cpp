@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <cocogfx/include/cgltrace.hpp>
+#include <graphics.h>
+#include <gfxutil.h>
+
+using namespace cocogfx;
+
+// the draw3d traces, binned at the reference image size
+static const char* traces[] = {
+  "triangle.cgltrace", "box.cgltrace", "carnival.cgltrace", "coverflow.cgltrace",
+  "evilskull.cgltrace", "filmtv.cgltrace", "mouse.cgltrace", "polybump.cgltrace",
+  "scene.cgltrace", "skybox.cgltrace", "tekkaman.cgltrace", "vase.cgltrace"
+};
+
+static const uint32_t tile_logsizes[] = {4, 5, 6};
+static const uint32_t task_counts[] = {1, 3, 64};
+
+static uint32_t dst_width  = 128;
+static uint32_t dst_height = 128;
+
+// bins a draw call with the three device passes run on the host, starting with
+// an empty tile buffer so that the overflow rerun is covered too
+static void device_binning(std::vector<uint8_t>& tilebuf,
+                           std::vector<uint8_t>& primbuf,
+                           const std::unordered_map<uint32_t, CGLTrace::vertex_t>& vertices,
+                           const std::vector<CGLTrace::primitive_t>& primitives,
+                           float near,
+                           float far,
+                           uint32_t tile_logsize,
+                           uint32_t num_tasks) {
+  std::vector<graphics::rast_vertex_t> vbuf;
+  std::vector<uint32_t> ibuf;
+  graphics::PackPrimitives(vbuf, ibuf, vertices, primitives);
+  uint32_t num_prims = primitives.size();
+
+  uint32_t tile_size = 1 << tile_logsize;
+  uint32_t num_tiles = ((dst_width + tile_size - 1) >> tile_logsize) * ((dst_height + tile_size - 1) >> tile_logsize);
+  std::vector<uint8_t> scratch(graphics::BinningScratchSize(num_prims, num_tiles, num_tasks));
+  graphics::rast_bin_status_t status;
+  memset(&status, 0, sizeof(status));
+  primbuf.assign(num_prims * sizeof(graphics::rast_prim_t), 0);
+  tilebuf.clear();
+
+  graphics::rast_bin_args_t args;
+  memset(&args, 0, sizeof(args));
+  args.vbuf_addr    = reinterpret_cast<uintptr_t>(vbuf.data());
+  args.ibuf_addr    = reinterpret_cast<uintptr_t>(ibuf.data());
+  args.tbuf_addr    = reinterpret_cast<uintptr_t>(tilebuf.data());
+  args.pbuf_addr    = reinterpret_cast<uintptr_t>(primbuf.data());
+  args.scratch_addr = reinterpret_cast<uintptr_t>(scratch.data());
+  args.status_addr  = reinterpret_cast<uintptr_t>(&status);
+  args.tbuf_size    = 0;
+  args.num_prims    = num_prims;
+  args.num_tasks    = num_tasks;
+  args.width        = dst_width;
+  args.height       = dst_height;
+  args.tile_logsize = tile_logsize;
+  args.near         = near;
+  args.far          = far;
+
+  for (uint32_t t = 0; t < num_tasks; ++t) {
+    graphics::BinningSetup(args, t);
+  }
+  graphics::BinningPrefix(args);
+  if (status.overflow) {
+    tilebuf.resize(status.tbuf_size);
+    args.tbuf_addr = reinterpret_cast<uintptr_t>(tilebuf.data());
+    args.tbuf_size = tilebuf.size();
+    graphics::BinningPrefix(args);
+  }
+  for (uint32_t t = 0; t < num_tasks; ++t) {
+    graphics::BinningScatter(args, t);
+  }
+
+  tilebuf.resize(status.tbuf_size);
+  primbuf.resize(status.num_prims * sizeof(graphics::rast_prim_t));
+}
+
+static int compare(const char* name, const std::vector<uint8_t>& expected, const std::vector<uint8_t>& actual) {
+  if (expected.size() != actual.size()) {
+    printf("Error: %s size mismatch: expected=%zu, actual=%zu\n", name, expected.size(), actual.size());
+    return 1;
+  }
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (expected[i] != actual[i]) {
+      printf("Error: %s mismatch at byte %zu: expected=0x%x, actual=0x%x\n", name, i, expected[i], actual[i]);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int main() {
+  int errors = 0;
+
+  for (auto trace_file : traces) {
+    CGLTrace trace;
+    auto trace_file_s = graphics::ResolveFilePath(trace_file, ASSETS_PATHS);
+    if (0 != trace.load(trace_file_s.c_str())) {
+      printf("Error: failed to load %s\n", trace_file);
+      return -1;
+    }
+    for (uint32_t d = 0; d < trace.drawcalls.size(); ++d) {
+      auto& drawcall = trace.drawcalls.at(d);
+      for (auto tile_logsize : tile_logsizes) {
+        std::vector<uint8_t> tilebuf, primbuf;
+        graphics::Binning(tilebuf, primbuf, drawcall.vertices, drawcall.primitives,
+                          dst_width, dst_height, drawcall.viewport.near, drawcall.viewport.far, tile_logsize);
+        for (auto num_tasks : task_counts) {
+          std::vector<uint8_t> dev_tilebuf, dev_primbuf;
+          device_binning(dev_tilebuf, dev_primbuf, drawcall.vertices, drawcall.primitives,
+                         drawcall.viewport.near, drawcall.viewport.far, tile_logsize, num_tasks);
+          int err = compare("tile buffer", tilebuf, dev_tilebuf)
+                  + compare("primitive buffer", primbuf, dev_primbuf);
+          if (err) {
+            printf("  in %s, drawcall=%d, tile_logsize=%d, tasks=%d\n", trace_file, d, tile_logsize, num_tasks);
+            errors += err;
+          }
+        }
+      }
+    }
+    printf("%s: %zu drawcalls checked\n", trace_file, trace.drawcalls.size());
+  }
+
+  if (errors != 0) {
+    printf("FAILED! - %d errors\n", errors);
+    return errors;
+  }
+
+  printf("PASSED!\n");
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include <graphics.h>
+
+// rasterizes random primitives with the block rasterizer and with the quad
+// path (block size 2x2) and compares the emitted stamps
+
+#define NUM_PRIMS 2000
+
+static uint32_t dst_width  = 128;
+static uint32_t dst_height = 128;
+
+struct stamp_t {
+  uint32_t pos_mask;
+  uint32_t pid;
+  int32_t  bcoords[12];
+
+  bool operator<(const stamp_t& rhs) const {
+    if (pid != rhs.pid)
+      return pid < rhs.pid;
+    return pos_mask < rhs.pos_mask;
+  }
+
+  bool operator==(const stamp_t& rhs) const {
+    if (pid != rhs.pid || pos_mask != rhs.pos_mask)
+      return false;
+    // only the covered pixels carry meaningful barycentrics
+    for (uint32_t p = 0; p < 4; ++p) {
+      if (0 == (pos_mask & (1 << p)))
+        continue;
+      for (uint32_t i = 0; i < 3; ++i) {
+        if (bcoords[p * 3 + i] != rhs.bcoords[p * 3 + i])
+          return false;
+      }
+    }
+    return true;
+  }
+};
+
+static void shader_cb(uint32_t pos_mask, graphics::vec3e_t bcoords[4], uint32_t pid, void* cb_arg) {
+  auto stamps = reinterpret_cast<std::vector<stamp_t>*>(cb_arg);
+  stamp_t stamp;
+  stamp.pos_mask = pos_mask;
+  stamp.pid = pid;
+  for (uint32_t p = 0; p < 4; ++p) {
+    stamp.bcoords[p * 3 + 0] = bcoords[p].x.data();
+    stamp.bcoords[p * 3 + 1] = bcoords[p].y.data();
+    stamp.bcoords[p * 3 + 2] = bcoords[p].z.data();
+  }
+  stamps->push_back(stamp);
+}
+
+static float frand(float lo, float hi) {
+  return lo + (hi - lo) * (float(rand()) / float(RAND_MAX));
+}
+
+struct primitive_t {
+  graphics::rast_prim_t prim;
+  graphics::rast_bbox_t bbox;
+};
+
+static void rasterize(std::vector<stamp_t>& stamps,
+                      const std::vector<primitive_t>& primitives,
+                      const graphics::RasterDCRS& dcrs,
+                      uint32_t tile_logsize,
+                      uint32_t block_logsize) {
+  graphics::Rasterizer rasterizer(shader_cb, &stamps, tile_logsize, block_logsize);
+  rasterizer.configure(dcrs);
+  uint32_t tile_size = 1 << tile_logsize;
+  for (uint32_t pid = 0; pid < primitives.size(); ++pid) {
+    auto& primitive = primitives.at(pid);
+    graphics::vec3e_t edges[3] = {primitive.prim.edges[0], primitive.prim.edges[1], primitive.prim.edges[2]};
+    auto& bbox = primitive.bbox;
+    for (uint32_t ty = bbox.top >> tile_logsize; ty < ((bbox.bottom + tile_size - 1) >> tile_logsize); ++ty) {
+      for (uint32_t tx = bbox.left >> tile_logsize; tx < ((bbox.right + tile_size - 1) >> tile_logsize); ++tx) {
+        rasterizer.renderPrimitive(tx << tile_logsize, ty << tile_logsize, pid, edges);
+      }
+    }
+  }
+}
+
+int main() {
+  int errors = 0;
+
+  srand(0);
+
+  // random primitives, including partially clipped and large ones
+  std::vector<primitive_t> primitives;
+  while (primitives.size() < NUM_PRIMS) {
+    graphics::rast_vertex_t v[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+      float w = frand(0.5f, 2.0f);
+      v[i] = {frand(-1.2f, 1.2f) * w, frand(-1.2f, 1.2f) * w, frand(-1.0f, 1.0f) * w, w,
+              1, 1, 1, 1, 0, 0};
+    }
+    primitive_t primitive;
+    auto status = graphics::SetupPrimitive(&primitive.prim, &primitive.bbox, v[0], v[1], v[2], dst_width, dst_height, 0.0f, 1.0f);
+    if (status != graphics::PrimSetup::Accepted)
+      continue;
+    primitives.push_back(primitive);
+  }
+
+  // full screen and partial scissors
+  const uint32_t scissors[][4] = {
+    {0, dst_width, 0, dst_height},
+    {5, 99, 13, 70},
+  };
+
+  for (auto& scissor : scissors) {
+    graphics::RasterDCRS dcrs;
+    dcrs.write(VX_DCR_RASTER_SCISSOR_X, (scissor[1] << 16) | scissor[0]);
+    dcrs.write(VX_DCR_RASTER_SCISSOR_Y, (scissor[3] << 16) | scissor[2]);
+    for (uint32_t tile_logsize = 2; tile_logsize <= 6; ++tile_logsize) {
+      std::vector<stamp_t> ref_stamps;
+      rasterize(ref_stamps, primitives, dcrs, tile_logsize, 1);
+      auto ref_sorted = ref_stamps;
+      std::stable_sort(ref_sorted.begin(), ref_sorted.end());
+      for (uint32_t block_logsize = 2; block_logsize <= std::min<uint32_t>(tile_logsize, RASTER_BLOCK_LOGSIZE_MAX); ++block_logsize) {
+        std::vector<stamp_t> stamps;
+        rasterize(stamps, primitives, dcrs, tile_logsize, block_logsize);
+        bool match;
+        if (block_logsize == 2) {
+          // 4x4 blocks keep the emission order of the quad path
+          match = (stamps == ref_stamps);
+        } else {
+          std::stable_sort(stamps.begin(), stamps.end());
+          match = (stamps == ref_sorted);
+        }
+        if (!match) {
+          printf("Error: stamps mismatch: scissor=(%d, %d, %d, %d), tile_logsize=%d, block_logsize=%d, stamps=%zu, expected=%zu\n",
+                 scissor[0], scissor[1], scissor[2], scissor[3], tile_logsize, block_logsize, stamps.size(), ref_stamps.size());
+          ++errors;
+        }
+      }
+      printf("scissor=(%d, %d, %d, %d), tile_logsize=%d: %zu stamps checked\n",
+             scissor[0], scissor[1], scissor[2], scissor[3], tile_logsize, ref_stamps.size());
+    }
+  }
+
+  if (errors != 0) {
+    printf("FAILED! - %d errors\n", errors);
+    return errors;
+  }
+
+  printf("PASSED!\n");
+
+  return 0;
+}